@@ -1,17 +1,46 @@
 #include "context.h"
 
+#include <juce/core/startup_trace.h>
+#include <juce/context/vulkan/shader_module.h>
+
 namespace juce
 {
 
+void context::begin_initialize()
+{
+    if (m_instance_ready.valid())
+        return;
+
+    prefetch_spirv_files("shaders");
+    m_instance_ready = std::async(std::launch::async, [this]()
+                                  { return m_context.initialize_instance(); });
+}
+
 bool context::initialize(HWND hwnd, HINSTANCE hinstance, uint32_t width, uint32_t height)
 {
-    m_context.initialize(hwnd, hinstance);
-    m_swapchain.initialize(&m_context, width, height); // swapchain이 context 포인터 받는 경우
-    return true;
+    // Without begin_initialize the instance is simply created inline by vk_context::initialize
+    if (m_instance_ready.valid() && !m_instance_ready.get())
+    {
+        return false;
+    }
+
+    if (!m_context.initialize(hwnd, hinstance))
+    {
+        return false;
+    }
+
+    startup_phase phase("swapchain::initialize");
+    return m_swapchain.initialize(&m_context, width, height); // swapchain이 context 포인터 받는 경우
 }
 
 void context::cleanup()
 {
+    // An instance still being created on the worker must finish before it is torn down
+    if (m_instance_ready.valid())
+    {
+        m_instance_ready.wait();
+        m_instance_ready = {};
+    }
     m_swapchain.cleanup();
     m_context.cleanup();
 }
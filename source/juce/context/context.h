@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <string>
+#include <future>
 
 namespace juce
 {
@@ -27,12 +28,16 @@ public:
     context() = default;
     ~context() { cleanup(); }
 
+    // 창이 필요 없는 초기화를 백그라운드로 시작 (Vulkan instance, SPIR-V / pipeline cache 읽기)
+    // - 창 생성 전에 호출하면 그 시간과 겹침, 생략해도 initialize가 순서대로 처리
+    void begin_initialize();
     bool initialize(HWND hwnd, HINSTANCE hinstance, uint32_t width, uint32_t height);
     void cleanup();
 
 private:
     vk_context m_context;
     swapchain m_swapchain;
+    std::future<bool> m_instance_ready;
 };
 
 } // namespace juce
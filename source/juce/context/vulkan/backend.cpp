@@ -2,20 +2,42 @@
 #include "backend.h"
 #include "vk_context.h"
 #include "swapchain.h"
+#include "shader_module.h"
+
+#include <juce/core/logger.h>
+#include <juce/core/startup_trace.h>
+#include <juce/core/profiler.h>
 
 #include <stdexcept>
-#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
 #include <iostream>
 #include <array>
 
 namespace juce
 {
+// set 0 / binding 0에 매 프레임 기록되는 값
+struct frame_uniforms
+{
+    float viewport[4]; // width, height, 1/width, 1/height
+    uint32_t frame_index;
+    uint32_t padding[3];
+};
+
+static bool has_stencil_component(VkFormat format)
+{
+    return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
+}
+
 backend::backend(vk_context* context, swapchain* swapchain)
     : m_context(context),
       m_swapchain(swapchain),
       m_render_pass(VK_NULL_HANDLE),
       m_pipeline_layout(VK_NULL_HANDLE),
-      m_graphics_pipeline(VK_NULL_HANDLE)
+      m_graphics_pipeline(VK_NULL_HANDLE),
+      m_frames_in_flight(get_frame_config(frame_profile::balanced).frames_in_flight)
 {
 }
 
@@ -26,11 +48,126 @@ backend::~backend()
 
 bool backend::initialize()
 {
+    startup_phase phase("backend::initialize");
+
+    // The startup profile can be picked without a rebuild, e.g. JUCE_FRAME_PROFILE=lowest_latency
+    if (const char* name = std::getenv("JUCE_FRAME_PROFILE"))
+    {
+        frame_profile profile;
+        if (parse_frame_profile(name, profile))
+        {
+            set_frame_profile(profile);
+        }
+        else
+        {
+            log_warn("Unknown JUCE_FRAME_PROFILE '%s', using %s", name, get_frame_profile_name(m_frame_profile));
+        }
+    }
+
+    m_frame_pacer.initialize(m_context, frame_pacer::config{});
+
+    // Until the first resize the swapchain is as large as the window it was created for
+    VkExtent2D window_extent = m_swapchain->get_extent();
+    m_window_width = window_extent.width;
+    m_window_height = window_extent.height;
+
+    // JUCE_MSAA=4 starts with 4x MSAA (clamped to what the device supports)
+    if (const char* msaa = std::getenv("JUCE_MSAA"))
+    {
+        set_msaa_samples(static_cast<uint32_t>(std::atoi(msaa)));
+        m_msaa_dirty = false;
+    }
+
+    // JUCE_DEPTH_PREPASS=1 starts with the depth pre-pass enabled
+    if (const char* prepass = std::getenv("JUCE_DEPTH_PREPASS"))
+    {
+        m_depth_prepass = prepass[0] == '1';
+    }
+
+    // JUCE_DYNAMIC_RENDERING=0 forces the render pass path, e.g. to compare both
+    const char* dynamic_rendering = std::getenv("JUCE_DYNAMIC_RENDERING");
+    if (m_context->is_device_extension_enabled(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) && !(dynamic_rendering && dynamic_rendering[0] == '0'))
+    {
+        m_cmd_begin_rendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(m_context->get_device(), "vkCmdBeginRenderingKHR");
+        m_cmd_end_rendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(m_context->get_device(), "vkCmdEndRenderingKHR");
+        m_dynamic_rendering = m_cmd_begin_rendering && m_cmd_end_rendering;
+    }
+    log_info("Rendering path: %s", m_dynamic_rendering ? "dynamic rendering" : "render pass");
+
+    m_layout_cache.initialize(m_context->get_device());
+
+    {
+        startup_phase registry_phase("backend::pipeline_registry");
+        if (!m_pipelines.initialize(m_context, pipeline_registry::config{}))
+        {
+            return false;
+        }
+        register_scene_pipelines();
+    }
+
+    // JUCE_SHADER_HOT_RELOAD=1 watches shader sources and SPIR-V from the start
+    if (const char* hot_reload = std::getenv("JUCE_SHADER_HOT_RELOAD"))
+    {
+        set_shader_hot_reload(hot_reload[0] == '1');
+    }
+
+    // JUCE_OCCLUSION_CULLING=1 starts with two-phase occlusion culling enabled;
+    // otherwise the culler is only built once culling or cull objects are first requested
+    if (const char* culling = std::getenv("JUCE_OCCLUSION_CULLING"))
+    {
+        m_occlusion_culling = culling[0] == '1' && ensure_culler();
+    }
+
+    // JUCE_PASS_STATS=1 records per-pass statistics from the first frame and logs the last ones on shutdown
+    if (const char* pass_stats = std::getenv("JUCE_PASS_STATS"))
+    {
+        set_pass_statistics(pass_stats[0] == '1');
+    }
+
+    // JUCE_FRAME_CAPTURE=N writes the first N frames to capture_00000.png, capture_00001.png, ...
+    if (const char* capture = std::getenv("JUCE_FRAME_CAPTURE"))
+    {
+        capture_request request;
+        request.frame_count = static_cast<uint32_t>(std::atoi(capture));
+        request.path = "capture.png";
+        m_frame_capture.request(request);
+    }
+
     try
     {
+        if (m_swapchain->get_sample_count() != m_msaa_samples || m_occlusion_culling)
+        {
+            m_swapchain->set_sample_count(m_msaa_samples);
+            m_swapchain->set_depth_sampled(m_occlusion_culling);
+            VkExtent2D extent = m_swapchain->get_extent();
+            if (!m_swapchain->recreate(extent.width, extent.height))
+            {
+                throw std::runtime_error("failed to create MSAA render targets!");
+            }
+        }
+
+        create_uniform_ring();
+        m_gpu_profiler.initialize(m_context, m_frames_in_flight, gpu_profiler::config{});
+        m_pass_statistics.initialize(m_context, m_frames_in_flight, pass_statistics::config{});
+        m_frame_capture.initialize(m_context, m_frames_in_flight, frame_capture::config{});
+        m_texture_streaming_available = m_texture_streamer.initialize(m_context, texture_streamer::config{});
+        if (!m_texture_streaming_available)
+        {
+            log_warn("Texture streaming unavailable");
+        }
+        {
+            // Eager: whether binning is available decides the pipeline layout
+            startup_phase lighting_phase("backend::create_lighting");
+            create_lighting();
+        }
+        create_particles();
         create_render_pass();
-        create_graphics_pipeline();
-        m_swapchain->create_framebuffers(m_render_pass);
+        {
+            // Waits only for the fallback pipeline; the rest keep compiling past the first frame
+            startup_phase pipeline_phase("backend::create_graphics_pipeline");
+            create_graphics_pipeline();
+        }
+        create_framebuffers();
         create_command_buffers();
         create_sync_objects();
     }
@@ -44,10 +181,61 @@ bool backend::initialize()
 
 void backend::draw_frame()
 {
-    vkWaitForFences(m_context->get_device(), 1, &m_in_flight_fences[m_current_frame], VK_TRUE, UINT64_MAX);
+    JUCE_PROFILE_SCOPE("backend::draw_frame");
+
+    if (m_profile_dirty)
+    {
+        apply_frame_profile();
+    }
+    if (m_msaa_dirty)
+    {
+        apply_msaa();
+    }
+    if (m_culling_dirty)
+    {
+        apply_occlusion_culling();
+    }
+    // Frame boundary: pipelines compiled or rebuilt in the background replace the live ones before recording
+    m_pipelines.update();
+    m_shader_reloader.apply_pending();
+    // Budget polling is throttled inside; pressure callbacks fire from here on the main thread
+    m_context->get_memory_stats()->update();
+    // Uploads finished loads and applies the (possibly pressure-reduced) budget before this frame samples anything
+    if (m_texture_streaming_available)
+    {
+        m_texture_streamer.update();
+    }
+
+    // Callers that sample input should pace before polling; otherwise pace here
+    if (!m_frame_paced)
+    {
+        wait_for_next_frame();
+    }
+    m_frame_paced = false;
+
+    timeline* graphics_timeline = m_context->get_graphics_timeline();
+
+    // The frame slot is free once the GPU has passed the value it last signaled
+    {
+        JUCE_PROFILE_SCOPE("backend::wait_frame_slot");
+        graphics_timeline->wait(m_frame_timeline_values[m_current_frame]);
+    }
+    m_frame_arena.begin_frame(m_current_frame);
+    m_uniform_ring.begin_frame(m_current_frame);
+    m_descriptor_allocator.begin_frame(m_current_frame);
+    m_lighting.begin_frame(m_current_frame);
+    m_particles.begin_frame(m_current_frame);
+    m_gpu_profiler.begin_frame(m_current_frame);
+    m_pass_statistics.begin_frame(m_current_frame);
+    m_frame_capture.begin_frame(m_current_frame);
+    m_context->get_deletion_queue()->flush();
 
     uint32_t image_index;
-    VkResult result = vkAcquireNextImageKHR(m_context->get_device(), m_swapchain->get_handle(), UINT64_MAX, m_image_available_semaphores[m_current_frame], VK_NULL_HANDLE, &image_index);
+    VkResult result;
+    {
+        JUCE_PROFILE_SCOPE("backend::acquire");
+        result = vkAcquireNextImageKHR(m_context->get_device(), m_swapchain->get_handle(), UINT64_MAX, m_image_available_semaphores[m_current_frame], VK_NULL_HANDLE, &image_index);
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR)
     {
@@ -59,30 +247,15 @@ void backend::draw_frame()
         throw std::runtime_error("failed to acquire swap chain image!");
     }
 
-    vkResetFences(m_context->get_device(), 1, &m_in_flight_fences[m_current_frame]);
+    m_frame_pacer.begin_work();
 
     vkResetCommandBuffer(m_command_buffers[m_current_frame], 0);
     record_command_buffer(m_command_buffers[m_current_frame], image_index);
 
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-    VkSemaphore wait_semaphores[] = {m_image_available_semaphores[m_current_frame]};
-    VkPipelineStageFlags wait_stages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = wait_semaphores;
-    submit_info.pWaitDstStageMask = wait_stages;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &m_command_buffers[m_current_frame];
-
+    timeline_wait wait{m_image_available_semaphores[m_current_frame], 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     VkSemaphore signal_semaphores[] = {m_render_finished_semaphores[m_current_frame]};
-    submit_info.signalSemaphoreCount = 1;
-    submit_info.pSignalSemaphores = signal_semaphores;
 
-    if (vkQueueSubmit(m_context->get_graphics_queue(), 1, &submit_info, m_in_flight_fences[m_current_frame]) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to submit draw command buffer!");
-    }
+    m_frame_timeline_values[m_current_frame] = graphics_timeline->submit(m_context->get_graphics_queue(), m_command_buffers[m_current_frame], &wait, 1, signal_semaphores, 1);
 
     VkPresentInfoKHR present_info{};
     present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -94,7 +267,22 @@ void backend::draw_frame()
     present_info.pSwapchains = swap_chains;
     present_info.pImageIndices = &image_index;
 
-    result = vkQueuePresentKHR(m_context->get_present_queue(), &present_info);
+    VkPresentIdKHR present_id_info{};
+    uint64_t present_id = m_frame_pacer.next_present_id();
+    if (present_id != 0)
+    {
+        present_id_info.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        present_id_info.swapchainCount = 1;
+        present_id_info.pPresentIds = &present_id;
+        present_info.pNext = &present_id_info;
+    }
+
+    {
+        JUCE_PROFILE_SCOPE("backend::present");
+        result = vkQueuePresentKHR(m_context->get_present_queue(), &present_info);
+    }
+    m_frame_pacer.end_frame();
+    startup_trace::get_instance()->mark_first_frame();
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebuffer_resized)
     {
@@ -106,170 +294,575 @@ void backend::draw_frame()
         throw std::runtime_error("failed to present swap chain image!");
     }
 
-    m_current_frame = (m_current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+    m_current_frame = (m_current_frame + 1) % m_frames_in_flight;
+}
+
+void backend::wait_for_next_frame()
+{
+    JUCE_PROFILE_SCOPE("backend::wait_for_next_frame");
+    m_frame_pacer.begin_frame(m_swapchain->get_handle());
+    m_frame_paced = true;
+}
+
+texture_streamer& backend::get_texture_streamer()
+{
+    return m_texture_streamer;
+}
+
+frame_capture& backend::get_frame_capture()
+{
+    return m_frame_capture;
+}
+
+linear_arena& backend::get_frame_arena()
+{
+    return m_frame_arena.current();
+}
+
+uniform_ring& backend::get_uniform_ring()
+{
+    return m_uniform_ring;
+}
+
+descriptor_allocator& backend::get_descriptor_allocator()
+{
+    return m_descriptor_allocator;
+}
+
+descriptor_layout_cache& backend::get_layout_cache()
+{
+    return m_layout_cache;
+}
+
+frame_pacer::stats backend::get_latency_stats() const
+{
+    return m_frame_pacer.get_stats();
 }
 
 void backend::on_window_resized(uint32_t width, uint32_t height)
 {
+    m_window_width = width;
+    m_window_height = height;
     m_framebuffer_resized = true;
     // The actual recreation happens at the beginning of draw_frame
     // to ensure synchronization.
 }
 
+void backend::set_frame_profile(frame_profile profile)
+{
+    m_pending_profile = profile;
+    m_profile_dirty = profile != m_frame_profile;
+}
+
+frame_profile backend::get_frame_profile() const
+{
+    return m_frame_profile;
+}
+
+void backend::set_msaa_samples(uint32_t samples)
+{
+    // Round down to a power of two the device supports for both color and depth
+    uint32_t max_samples = static_cast<uint32_t>(m_context->get_max_sample_count());
+    uint32_t count = 1;
+    while (count * 2 <= samples && count * 2 <= max_samples)
+    {
+        count *= 2;
+    }
+    if (count != samples)
+    {
+        log_warn("MSAA %ux is not supported, using %ux", samples, count);
+    }
+
+    VkSampleCountFlagBits sample_count = static_cast<VkSampleCountFlagBits>(count);
+    if (sample_count != m_msaa_samples)
+    {
+        m_msaa_samples = sample_count;
+        m_msaa_dirty = true;
+    }
+}
+
+uint32_t backend::get_msaa_samples() const
+{
+    return static_cast<uint32_t>(m_msaa_samples);
+}
+
+void backend::apply_msaa()
+{
+    m_msaa_dirty = false;
+
+    // Old targets, pass and pipelines are retired through the deletion queue; no device wait
+    cleanup_swapchain_dependents();
+
+    m_swapchain->set_sample_count(m_msaa_samples);
+    VkExtent2D extent = m_swapchain->get_extent();
+    if (!m_swapchain->recreate(extent.width, extent.height))
+    {
+        throw std::runtime_error("failed to recreate swapchain for MSAA!");
+    }
+
+    create_render_pass();
+    create_graphics_pipeline();
+    create_framebuffers();
+    log_info("MSAA: %ux", get_msaa_samples());
+}
+
+void backend::set_depth_prepass(bool enabled)
+{
+    if (enabled != m_depth_prepass)
+    {
+        m_depth_prepass = enabled;
+        log_info("Depth pre-pass: %s", m_depth_prepass ? "on" : "off");
+    }
+}
+
+bool backend::is_depth_prepass_enabled() const
+{
+    return m_depth_prepass;
+}
+
+void backend::set_occlusion_culling(bool enabled)
+{
+    if (enabled && !ensure_culler())
+    {
+        log_warn("GPU occlusion culling is unavailable");
+        return;
+    }
+    if (enabled != m_occlusion_culling)
+    {
+        m_occlusion_culling = enabled;
+        m_culling_dirty = true;
+    }
+}
+
+bool backend::is_occlusion_culling_enabled() const
+{
+    return m_occlusion_culling;
+}
+
+bool backend::ensure_culler()
+{
+    if (m_culler_initialized)
+        return m_culling_available;
+    m_culler_initialized = true;
+
+    // Culling needs its compute shaders; without them the triangle path keeps working
+    m_culling_available = m_culler.initialize(m_context);
+    if (!m_culling_available)
+    {
+        log_warn("GPU occlusion culling unavailable");
+    }
+    return m_culling_available;
+}
+
+void backend::set_cull_objects(const cull_object* objects, uint32_t count)
+{
+    if (!ensure_culler())
+        return;
+
+    m_culler.set_objects(objects, count);
+    m_cull_objects.assign(objects, objects + count);
+}
+
+void backend::set_object_textures(const uint32_t* texture_ids, uint32_t count)
+{
+    m_object_textures.assign(texture_ids, texture_ids + count);
+}
+
+void backend::set_view_projection(const float view_proj[16])
+{
+    std::memcpy(m_view_proj, view_proj, sizeof(m_view_proj));
+}
+
+void backend::set_shader_hot_reload(bool enabled)
+{
+    if (enabled == m_shader_hot_reload)
+        return;
+
+    if (enabled)
+    {
+        shader_reloader::config cfg;
+#ifdef JUCE_SHADER_SOURCE_DIR
+        cfg.source_dir = JUCE_SHADER_SOURCE_DIR;
+        cfg.glslc = JUCE_GLSLC;
+#endif
+        m_shader_hot_reload = m_shader_reloader.start(m_context, cfg);
+    }
+    else
+    {
+        m_shader_reloader.stop();
+        m_shader_hot_reload = false;
+        log_info("Shader hot-reload: off");
+    }
+}
+
+bool backend::is_shader_hot_reload_enabled() const
+{
+    return m_shader_hot_reload;
+}
+
+void backend::set_pass_statistics(bool enabled)
+{
+    m_pass_statistics.set_enabled(enabled);
+}
+
+bool backend::is_pass_statistics_enabled() const
+{
+    return m_pass_statistics.is_enabled();
+}
+
+const std::vector<pass_stats>& backend::get_pass_statistics() const
+{
+    return m_pass_statistics.get_latest();
+}
+
+pipeline_registry& backend::get_pipeline_registry()
+{
+    return m_pipelines;
+}
+
+void backend::set_lights(const point_light* lights, uint32_t count)
+{
+    m_lighting.set_lights(lights, count);
+}
+
+void backend::set_camera(const float view[16], const float projection[16], float near_plane, float far_plane)
+{
+    m_lighting.set_camera(view, projection, near_plane, far_plane);
+
+    // view_proj = projection * view (column-major)
+    for (int column = 0; column < 4; column++)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++)
+            {
+                sum += projection[k * 4 + row] * view[column * 4 + k];
+            }
+            m_view_proj[column * 4 + row] = sum;
+        }
+    }
+    m_particles.set_camera(view, m_view_proj);
+}
+
+void backend::set_particle_emitters(const particle_emitter* emitters, uint32_t count)
+{
+    m_particles.set_emitters(emitters, count);
+}
+
+void backend::apply_occlusion_culling()
+{
+    m_culling_dirty = false;
+
+    // Same as an MSAA change: depth usage and memory change, so targets, passes and pipelines are rebuilt
+    cleanup_swapchain_dependents();
+
+    m_swapchain->set_depth_sampled(m_occlusion_culling);
+    VkExtent2D extent = m_swapchain->get_extent();
+    if (!m_swapchain->recreate(extent.width, extent.height))
+    {
+        throw std::runtime_error("failed to recreate swapchain for occlusion culling!");
+    }
+
+    create_render_pass();
+    create_graphics_pipeline();
+    create_framebuffers();
+    log_info("Occlusion culling: %s", m_occlusion_culling ? "on" : "off");
+}
+
+void backend::apply_frame_profile()
+{
+    m_profile_dirty = false;
+    frame_config config = get_frame_config(m_pending_profile);
+
+    // Frame slots and swapchain images are both being replaced, so drain the queue once
+    vkDeviceWaitIdle(m_context->get_device());
+
+    cleanup_swapchain_dependents();
+    cleanup_frame_resources();
+
+    m_swapchain->set_frame_config(config);
+    VkExtent2D extent = m_swapchain->get_extent();
+    if (!m_swapchain->recreate(extent.width, extent.height))
+    {
+        throw std::runtime_error("failed to recreate swapchain for frame profile!");
+    }
+
+    m_frames_in_flight = config.frames_in_flight;
+    m_current_frame = 0;
+
+    create_uniform_ring();
+    m_gpu_profiler.initialize(m_context, m_frames_in_flight, gpu_profiler::config{});
+    m_pass_statistics.initialize(m_context, m_frames_in_flight, pass_statistics::config{});
+    m_frame_capture.initialize(m_context, m_frames_in_flight, frame_capture::config{});
+    // Lights, emitters and live particles are kept: only their per-frame regions follow the new frame count
+    if (m_lighting_available && !m_lighting.resize_frames(m_frames_in_flight))
+    {
+        m_lighting.cleanup();
+        m_lighting_available = false;
+        log_warn("Clustered lighting unavailable");
+    }
+    if (m_particles_available && !m_particles.resize_frames(m_frames_in_flight))
+    {
+        m_particles.cleanup();
+        m_particles_available = false;
+        log_warn("GPU particles unavailable");
+    }
+    create_render_pass();
+    create_graphics_pipeline();
+    create_framebuffers();
+    create_command_buffers();
+    create_sync_objects();
+
+    m_frame_profile = m_pending_profile;
+    log_info("Frame profile: %s (%u frames in flight, %u swapchain images)", get_frame_profile_name(m_frame_profile), m_frames_in_flight, m_swapchain->get_image_count());
+}
+
+void backend::create_uniform_ring()
+{
+    if (!m_uniform_ring.initialize(m_context, m_frames_in_flight, uniform_ring::config{}))
+    {
+        throw std::runtime_error("failed to create uniform ring!");
+    }
+    if (!m_descriptor_allocator.initialize(m_context, m_frames_in_flight, descriptor_allocator::config{}))
+    {
+        throw std::runtime_error("failed to create descriptor allocator!");
+    }
+}
+
+void backend::create_lighting()
+{
+    // Binning needs its compute shader; without it the pipeline layout simply has no set 1
+    m_lighting_available = m_lighting.initialize(m_context, &m_descriptor_allocator, &m_layout_cache, m_frames_in_flight, clustered_lighting::config{});
+    if (!m_lighting_available)
+    {
+        log_warn("Clustered lighting unavailable");
+    }
+}
+
+void backend::create_particles()
+{
+    // Particle state is only allocated once emitters show up; this builds the compute side
+    m_particles_available = m_particles.initialize(m_context, &m_pipelines, m_frames_in_flight, particle_system::config{});
+    if (!m_particles_available)
+    {
+        log_warn("GPU particles unavailable");
+    }
+}
+
 void backend::create_render_pass()
 {
+    m_color_format = m_swapchain->get_image_format();
+    m_depth_format = m_swapchain->get_depth_format();
+
+    // Dynamic rendering begins directly on the image views; no pass object is needed
+    if (m_dynamic_rendering)
+        return;
+
+    m_render_pass = build_render_pass(main_pass_phase::single);
+
+    // Two-phase culling splits the frame around the depth pyramid build; MSAA depth cannot feed the pyramid
+    if (m_occlusion_culling && m_msaa_samples == VK_SAMPLE_COUNT_1_BIT)
+    {
+        m_early_render_pass = build_render_pass(main_pass_phase::early);
+        m_late_render_pass = build_render_pass(main_pass_phase::late);
+    }
+}
+
+VkRenderPass backend::build_render_pass(main_pass_phase phase)
+{
+    bool msaa = m_msaa_samples != VK_SAMPLE_COUNT_1_BIT;
+    bool early = phase == main_pass_phase::early;
+    bool late = phase == main_pass_phase::late;
+
+    // With MSAA the multisampled color stays on chip and only the resolved image is stored
     VkAttachmentDescription color_attachment{};
     color_attachment.format = m_swapchain->get_image_format();
-    color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color_attachment.samples = m_msaa_samples;
+    color_attachment.loadOp = late ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    color_attachment.storeOp = msaa ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
     color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    color_attachment.initialLayout = late ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    color_attachment.finalLayout = (msaa || early) ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VkAttachmentDescription resolve_attachment{};
+    resolve_attachment.format = m_swapchain->get_image_format();
+    resolve_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    resolve_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    resolve_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    resolve_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    resolve_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    resolve_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    resolve_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    // Depth is cleared and discarded every frame; only the early culling pass stores it for the pyramid,
+    // and the late pass picks it up again from the read-only layout the pyramid build left it in
+    VkAttachmentDescription depth_attachment{};
+    depth_attachment.format = m_depth_format;
+    depth_attachment.samples = m_msaa_samples;
+    depth_attachment.loadOp = late ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depth_attachment.storeOp = early ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depth_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depth_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depth_attachment.initialLayout = late ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    depth_attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference color_attachment_ref{};
     color_attachment_ref.attachment = 0;
     color_attachment_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+    VkAttachmentReference depth_attachment_ref{};
+    depth_attachment_ref.attachment = 1;
+    depth_attachment_ref.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference resolve_attachment_ref{};
+    resolve_attachment_ref.attachment = 2;
+    resolve_attachment_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    // The pre-pass shares the subpass: depth tests run in primitive order, so no barrier is needed in between
     VkSubpassDescription subpass{};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &color_attachment_ref;
+    subpass.pDepthStencilAttachment = &depth_attachment_ref;
+    // Resolved at the end of the subpass, so tilers write only the resolved pixels to memory
+    subpass.pResolveAttachments = msaa ? &resolve_attachment_ref : nullptr;
 
+    // The single depth image is shared by all frames in flight, so also wait for the previous frame's depth writes
     VkSubpassDependency dependency{};
     dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
     dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    if (late)
+    {
+        // Loads what the early pass wrote, after the pyramid build has finished reading the depth
+        dependency.srcStageMask |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        dependency.srcAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependency.dstAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    }
+
+    VkAttachmentDescription attachments[] = {color_attachment, depth_attachment, resolve_attachment};
 
     VkRenderPassCreateInfo render_pass_info{};
     render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    render_pass_info.attachmentCount = 1;
-    render_pass_info.pAttachments = &color_attachment;
+    render_pass_info.attachmentCount = msaa ? 3 : 2;
+    render_pass_info.pAttachments = attachments;
     render_pass_info.subpassCount = 1;
     render_pass_info.pSubpasses = &subpass;
     render_pass_info.dependencyCount = 1;
     render_pass_info.pDependencies = &dependency;
 
-    if (vkCreateRenderPass(m_context->get_device(), &render_pass_info, nullptr, &m_render_pass) != VK_SUCCESS)
+    VkRenderPass render_pass;
+    if (vkCreateRenderPass(m_context->get_device(), &render_pass_info, nullptr, &render_pass) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create render pass!");
     }
+    return render_pass;
 }
 
 void backend::create_graphics_pipeline()
 {
-    auto vert_shader_code = read_file("shaders/vert.spv");
-    auto frag_shader_code = read_file("shaders/frag.spv");
-
-    VkShaderModule vert_shader_module = create_shader_module(vert_shader_code);
-    VkShaderModule frag_shader_module = create_shader_module(frag_shader_code);
-
-    VkPipelineShaderStageCreateInfo vert_shader_stage_info{};
-    vert_shader_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vert_shader_stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vert_shader_stage_info.module = vert_shader_module;
-    vert_shader_stage_info.pName = "main";
-
-    VkPipelineShaderStageCreateInfo frag_shader_stage_info{};
-    frag_shader_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    frag_shader_stage_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    frag_shader_stage_info.module = frag_shader_module;
-    frag_shader_stage_info.pName = "main";
-
-    VkPipelineShaderStageCreateInfo shader_stages[] = {vert_shader_stage_info, frag_shader_stage_info};
-
-    VkPipelineVertexInputStateCreateInfo vertex_input_info{};
-    vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertex_input_info.vertexBindingDescriptionCount = 0;
-    vertex_input_info.vertexAttributeDescriptionCount = 0;
-
-    VkPipelineInputAssemblyStateCreateInfo input_assembly{};
-    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    input_assembly.primitiveRestartEnable = VK_FALSE;
-
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)m_swapchain->get_extent().width;
-    viewport.height = (float)m_swapchain->get_extent().height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = m_swapchain->get_extent();
-
-    VkPipelineViewportStateCreateInfo viewport_state{};
-    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewport_state.viewportCount = 1;
-    viewport_state.pViewports = &viewport;
-    viewport_state.scissorCount = 1;
-    viewport_state.pScissors = &scissor;
-
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    VkPipelineColorBlendAttachmentState color_blend_attachment{};
-    color_blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    color_blend_attachment.blendEnable = VK_FALSE;
-
-    VkPipelineColorBlendStateCreateInfo color_blending{};
-    color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    color_blending.logicOpEnable = VK_FALSE;
-    color_blending.attachmentCount = 1;
-    color_blending.pAttachments = &color_blend_attachment;
+    // set 0: frame / object constants, set 1: cluster light lists
+    VkDescriptorSetLayout set_layouts[] = {m_uniform_ring.get_descriptor_set_layout(), m_lighting.get_descriptor_set_layout()};
+    VkPushConstantRange push_constant_range = m_uniform_ring.get_push_constant_range();
 
     VkPipelineLayoutCreateInfo pipeline_layout_info{};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = m_lighting_available ? 2 : 1;
+    pipeline_layout_info.pSetLayouts = set_layouts;
+    pipeline_layout_info.pushConstantRangeCount = push_constant_range.size > 0 ? 1 : 0;
+    pipeline_layout_info.pPushConstantRanges = &push_constant_range;
 
     if (vkCreatePipelineLayout(m_context->get_device(), &pipeline_layout_info, nullptr, &m_pipeline_layout) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create pipeline layout!");
     }
 
-    VkGraphicsPipelineCreateInfo pipeline_info{};
-    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipeline_info.stageCount = 2;
-    pipeline_info.pStages = shader_stages;
-    pipeline_info.pVertexInputState = &vertex_input_info;
-    pipeline_info.pInputAssemblyState = &input_assembly;
-    pipeline_info.pViewportState = &viewport_state;
-    pipeline_info.pRasterizationState = &rasterizer;
-    pipeline_info.pMultisampleState = &multisampling;
-    pipeline_info.pColorBlendState = &color_blending;
-    pipeline_info.layout = m_pipeline_layout;
-    pipeline_info.renderPass = m_render_pass;
-    pipeline_info.subpass = 0;
-
-    if (vkCreateGraphicsPipelines(m_context->get_device(), VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &m_graphics_pipeline) != VK_SUCCESS)
+    // Every registered variant compiles in parallel; only the fallback has to exist before the first frame
+    pipeline_target target;
+    target.layout = m_pipeline_layout;
+    target.render_pass = m_render_pass;
+    target.samples = m_msaa_samples;
+    target.color_format = m_color_format;
+    target.depth_format = m_depth_format;
+    target.dynamic_rendering = m_dynamic_rendering;
+    m_pipelines.set_target(target);
+    if (!m_pipelines.wait(m_scene_pipeline))
     {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
 
-    vkDestroyShaderModule(m_context->get_device(), frag_shader_module, nullptr);
-    vkDestroyShaderModule(m_context->get_device(), vert_shader_module, nullptr);
+    register_reload_targets();
+}
+
+void backend::register_scene_pipelines()
+{
+    pipeline_desc scene;
+    scene.name = "scene";
+    scene.vertex_shader = "shaders/vert.spv";
+    scene.fragment_shader = "shaders/frag.spv";
+    m_scene_pipeline = m_pipelines.register_pipeline(scene);
+    m_pipelines.set_fallback(m_scene_pipeline);
+
+    // Reverse-Z: near = 1, far = 0, so nearer fragments pass with GREATER
+    // After the depth-only pre-pass the shading pass tests EQUAL without writing
+    pipeline_desc shading = scene;
+    shading.name = "scene_after_prepass";
+    shading.depth_write = false;
+    shading.depth_compare = VK_COMPARE_OP_EQUAL;
+    m_shading_pipeline = m_pipelines.register_pipeline(shading);
+
+    pipeline_desc prepass = scene;
+    prepass.name = "scene_depth_prepass";
+    prepass.fragment_shader.clear();
+    m_prepass_pipeline = m_pipelines.register_pipeline(prepass);
+}
+
+void backend::register_reload_targets()
+{
+    pipeline_target target = m_pipelines.get_target();
+    for (pipeline_id id = 0; id < m_pipelines.get_pipeline_count(); id++)
+    {
+        const pipeline_desc& desc = m_pipelines.get_desc(id);
+
+        // Registered even while hot-reload is off, so turning it on later needs no rebuild
+        reload_target reload;
+        reload.spirv_files.push_back(desc.vertex_shader);
+        if (!desc.fragment_shader.empty())
+        {
+            reload.spirv_files.push_back(desc.fragment_shader);
+        }
+        reload.build = [this, desc, target]()
+        { return std::vector<VkPipeline>{m_pipelines.build_pipeline(desc, target)}; };
+        reload.swap = [this, id](std::vector<VkPipeline>& rebuilt)
+        { m_pipelines.replace(id, rebuilt[0]); };
+        m_shader_reloader.add_target(std::move(reload));
+    }
+}
+
+void backend::resolve_scene_pipelines()
+{
+    // The pre-pass only pays off once both of its variants exist; until then the fallback draws in one go
+    if (m_depth_prepass && m_pipelines.is_ready(m_shading_pipeline) && m_pipelines.is_ready(m_prepass_pipeline))
+    {
+        m_graphics_pipeline = m_pipelines.get(m_shading_pipeline);
+        m_depth_prepass_pipeline = m_pipelines.get(m_prepass_pipeline);
+    }
+    else
+    {
+        m_graphics_pipeline = m_pipelines.get(m_scene_pipeline);
+        m_depth_prepass_pipeline = VK_NULL_HANDLE;
+    }
 }
 
 void backend::create_command_buffers()
 {
-    m_command_buffers.resize(MAX_FRAMES_IN_FLIGHT);
+    m_command_buffers.resize(m_frames_in_flight);
 
     VkCommandBufferAllocateInfo alloc_info{};
     alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -285,22 +878,19 @@ void backend::create_command_buffers()
 
 void backend::create_sync_objects()
 {
-    m_image_available_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    m_render_finished_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    m_in_flight_fences.resize(MAX_FRAMES_IN_FLIGHT);
+    m_image_available_semaphores.resize(m_frames_in_flight);
+    m_render_finished_semaphores.resize(m_frames_in_flight);
+    m_frame_timeline_values.assign(m_frames_in_flight, 0);
+    m_frame_arena.initialize(m_frames_in_flight, 256 * 1024);
 
+    // Acquire and present still need binary semaphores; CPU waits go through the graphics timeline
     VkSemaphoreCreateInfo semaphore_info{};
     semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fence_info{};
-    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (uint32_t i = 0; i < m_frames_in_flight; i++)
     {
         if (vkCreateSemaphore(m_context->get_device(), &semaphore_info, nullptr, &m_image_available_semaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(m_context->get_device(), &semaphore_info, nullptr, &m_render_finished_semaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(m_context->get_device(), &fence_info, nullptr, &m_in_flight_fences[i]) != VK_SUCCESS)
+            vkCreateSemaphore(m_context->get_device(), &semaphore_info, nullptr, &m_render_finished_semaphores[i]) != VK_SUCCESS)
         {
             throw std::runtime_error("failed to create synchronization objects for a frame!");
         }
@@ -309,6 +899,8 @@ void backend::create_sync_objects()
 
 void backend::record_command_buffer(VkCommandBuffer command_buffer, uint32_t image_index)
 {
+    JUCE_PROFILE_SCOPE("backend::record_command_buffer");
+
     VkCommandBufferBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
@@ -316,22 +908,28 @@ void backend::record_command_buffer(VkCommandBuffer command_buffer, uint32_t ima
     {
         throw std::runtime_error("failed to begin recording command buffer!");
     }
+    m_gpu_profiler.begin_commands(command_buffer);
 
-    VkRenderPassBeginInfo render_pass_info{};
-    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    render_pass_info.renderPass = m_render_pass;
-    render_pass_info.framebuffer = m_swapchain->get_framebuffer(image_index);
-    render_pass_info.renderArea.offset = {0, 0};
-    render_pass_info.renderArea.extent = m_swapchain->get_extent();
+    VkExtent2D extent = m_swapchain->get_extent();
+    m_pass_statistics.begin_commands(command_buffer, extent);
 
-    VkClearValue clear_color = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-    render_pass_info.clearValueCount = 1;
-    render_pass_info.pClearValues = &clear_color;
+    frame_uniforms frame_data{};
+    frame_data.viewport[0] = (float)extent.width;
+    frame_data.viewport[1] = (float)extent.height;
+    frame_data.viewport[2] = 1.0f / (float)extent.width;
+    frame_data.viewport[3] = 1.0f / (float)extent.height;
+    frame_data.frame_index = m_current_frame;
+    m_uniform_ring.set_frame_data(&frame_data, sizeof(frame_data));
 
-    vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphics_pipeline);
-    vkCmdDraw(command_buffer, 3, 1, 0, 0); // Draws a single triangle
-    vkCmdEndRenderPass(command_buffer);
+    resolve_scene_pipelines();
+    record_frame_passes(command_buffer, image_index, extent);
+
+    // Readback of the finished image; the copy lands in this frame slot's buffer
+    if (m_frame_capture.has_pending_requests() && m_swapchain->supports_readback())
+    {
+        JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "frame capture");
+        m_frame_capture.record(command_buffer, m_swapchain->get_image(image_index), VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, m_swapchain->get_image_format(), extent);
+    }
 
     if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
     {
@@ -339,85 +937,432 @@ void backend::record_command_buffer(VkCommandBuffer command_buffer, uint32_t ima
     }
 }
 
-std::vector<char> backend::read_file(const std::string& filename)
+void backend::record_frame_passes(VkCommandBuffer command_buffer, uint32_t image_index, VkExtent2D extent)
 {
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "frame");
+
+    // Usage recorded now drives the requests issued by next frame's streamer update
+    report_texture_usage(extent);
+
+    // Light lists are binned once per frame, before any pass reads them
+    if (m_lighting_available)
+    {
+        JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "light binning");
+        pass_statistics_scope statistics_scope(m_pass_statistics, command_buffer, "light binning");
+        m_lighting.bin(command_buffer, extent);
+    }
+
+    // Emission, simulation and sorting are sized on the GPU; the main pass only issues the indirect draw
+    if (m_particles_available && m_particles.is_active())
+    {
+        JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "particles");
+        pass_statistics_scope statistics_scope(m_pass_statistics, command_buffer, "particles");
+        m_particles.update(command_buffer);
+    }
+
+    if (!m_occlusion_culling || m_culler.get_object_count() == 0)
+    {
+        JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "main pass");
+        pass_statistics_scope statistics_scope(m_pass_statistics, command_buffer, "main pass");
+        begin_main_pass(command_buffer, image_index);
+        bind_scene_state(command_buffer);
+
+        // Pre-pass lays down depth first so the shading pass only runs the fragment shader on visible pixels
+        if (m_depth_prepass_pipeline != VK_NULL_HANDLE)
+        {
+            vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_depth_prepass_pipeline);
+            vkCmdDraw(command_buffer, 3, 1, 0, 0);
+            vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphics_pipeline);
+        }
 
-    if (!file.is_open())
+        vkCmdDraw(command_buffer, 3, 1, 0, 0); // Draws a single triangle
+        draw_particles(command_buffer);
+        end_main_pass(command_buffer, image_index);
+    }
+    else
     {
-        throw std::runtime_error("failed to open file: " + filename);
+        // Multisampled depth cannot be reduced by the pyramid shader; culling then falls back to the frustum
+        m_culler.set_depth_source(m_swapchain->get_depth_image(), m_swapchain->get_depth_image_view(), m_depth_format, extent, m_msaa_samples == VK_SAMPLE_COUNT_1_BIT);
+        {
+            JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "cull early");
+            pass_statistics_scope statistics_scope(m_pass_statistics, command_buffer, "cull early");
+            m_culler.cull(command_buffer, occlusion_culler::phase::early, m_view_proj);
+        }
+
+        if (m_culler.has_pyramid())
+        {
+            // Last frame's visible set becomes the occluders for everything else
+            {
+                JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "main pass early");
+                pass_statistics_scope statistics_scope(m_pass_statistics, command_buffer, "main pass early");
+                begin_main_pass(command_buffer, image_index, main_pass_phase::early);
+                bind_scene_state(command_buffer);
+                draw_culled(command_buffer, occlusion_culler::phase::early);
+                end_main_pass(command_buffer, image_index, main_pass_phase::early);
+            }
+            {
+                JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "depth pyramid + cull late");
+                pass_statistics_scope statistics_scope(m_pass_statistics, command_buffer, "depth pyramid + cull late");
+                m_culler.build_pyramid(command_buffer, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+                m_culler.cull(command_buffer, occlusion_culler::phase::late, m_view_proj);
+            }
+            {
+                JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "main pass late");
+                pass_statistics_scope statistics_scope(m_pass_statistics, command_buffer, "main pass late");
+                begin_main_pass(command_buffer, image_index, main_pass_phase::late);
+                bind_scene_state(command_buffer);
+                draw_culled(command_buffer, occlusion_culler::phase::late);
+                draw_particles(command_buffer);
+                end_main_pass(command_buffer, image_index, main_pass_phase::late);
+            }
+        }
+        else
+        {
+            // Both phases only test the frustum, so they can be culled up front and drawn in one pass
+            {
+                JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "cull late");
+                pass_statistics_scope statistics_scope(m_pass_statistics, command_buffer, "cull late");
+                m_culler.cull(command_buffer, occlusion_culler::phase::late, m_view_proj);
+            }
+
+            JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "main pass");
+            pass_statistics_scope statistics_scope(m_pass_statistics, command_buffer, "main pass");
+            begin_main_pass(command_buffer, image_index);
+            bind_scene_state(command_buffer);
+            draw_culled(command_buffer, occlusion_culler::phase::early);
+            draw_culled(command_buffer, occlusion_culler::phase::late);
+            draw_particles(command_buffer);
+            end_main_pass(command_buffer, image_index);
+        }
     }
+}
 
-    size_t file_size = (size_t)file.tellg();
-    std::vector<char> buffer(file_size);
+void backend::bind_scene_state(VkCommandBuffer command_buffer)
+{
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphics_pipeline);
+
+    VkExtent2D extent = m_swapchain->get_extent();
+
+    VkViewport viewport{};
+    viewport.width = (float)extent.width;
+    viewport.height = (float)extent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    VkRect2D scissor{{0, 0}, extent};
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+    m_uniform_ring.bind(command_buffer, m_pipeline_layout);
+    if (m_lighting_available)
+    {
+        m_lighting.bind(command_buffer, m_pipeline_layout, 1);
+    }
+}
+
+void backend::draw_culled(VkCommandBuffer command_buffer, occlusion_culler::phase phase)
+{
+    if (m_depth_prepass_pipeline != VK_NULL_HANDLE)
+    {
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_depth_prepass_pipeline);
+        m_culler.draw(command_buffer, phase);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphics_pipeline);
+    }
+    m_culler.draw(command_buffer, phase);
+}
+
+void backend::draw_particles(VkCommandBuffer command_buffer)
+{
+    if (!m_particles_available || !m_particles.is_active())
+        return;
+
+    JUCE_GPU_PROFILE_SCOPE(m_gpu_profiler, command_buffer, "particle draw");
+    m_particles.draw(command_buffer);
+}
+
+void backend::report_texture_usage(VkExtent2D extent)
+{
+    if (!m_texture_streaming_available || m_object_textures.empty())
+        return;
+
+    JUCE_PROFILE_SCOPE("backend::report_texture_usage");
+
+    // Rows 0 / 1 of view * projection are the x / y scales times unit view axes, so their lengths are the focal scales
+    const float* m = m_view_proj;
+    float scale_x = std::sqrt(m[0] * m[0] + m[4] * m[4] + m[8] * m[8]);
+    float scale_y = std::sqrt(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]);
+    float half_height = 0.5f * static_cast<float>(extent.height);
+
+    uint32_t count = static_cast<uint32_t>(std::min(m_cull_objects.size(), m_object_textures.size()));
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t texture = m_object_textures[i];
+        if (texture == UINT32_MAX)
+            continue;
+
+        const cull_object& object = m_cull_objects[i];
+        const float* c = object.center;
+        float x = m[0] * c[0] + m[4] * c[1] + m[8] * c[2] + m[12];
+        float y = m[1] * c[0] + m[5] * c[1] + m[9] * c[2] + m[13];
+        float w = m[3] * c[0] + m[7] * c[1] + m[11] * c[2] + m[15];
+
+        // Conservative frustum test on the sphere; objects behind the camera report nothing
+        if (w + object.radius <= 0.0f || std::fabs(x) > w + object.radius * scale_x || std::fabs(y) > w + object.radius * scale_y)
+            continue;
+
+        // Diameter in pixels; inside the sphere the object covers the screen
+        float pixels = w > object.radius ? 2.0f * object.radius * scale_y / w * half_height : 2.0f * half_height;
+        m_texture_streamer.report_usage(texture, pixels);
+    }
+}
 
-    file.seekg(0);
-    file.read(buffer.data(), file_size);
-    file.close();
+void backend::create_framebuffers()
+{
+    if (m_dynamic_rendering)
+        return;
 
-    return buffer;
+    if (!m_swapchain->create_framebuffers(m_render_pass))
+    {
+        throw std::runtime_error("failed to create framebuffers!");
+    }
 }
 
-VkShaderModule backend::create_shader_module(const std::vector<char>& code)
+void backend::begin_main_pass(VkCommandBuffer command_buffer, uint32_t image_index, main_pass_phase phase)
 {
-    VkShaderModuleCreateInfo create_info{};
-    create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    create_info.codeSize = code.size();
-    create_info.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    bool late = phase == main_pass_phase::late;
+
+    VkClearValue clear_color = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
+    VkClearValue clear_depth{};
+    clear_depth.depthStencil = {0.0f, 0}; // reverse-Z: 0 is the far plane
+
+    if (!m_dynamic_rendering)
+    {
+        VkClearValue clear_values[] = {clear_color, clear_depth};
+
+        VkRenderPassBeginInfo render_pass_info{};
+        render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        render_pass_info.renderPass = phase == main_pass_phase::early ? m_early_render_pass : late ? m_late_render_pass : m_render_pass;
+        render_pass_info.framebuffer = m_swapchain->get_framebuffer(image_index);
+        render_pass_info.renderArea.offset = {0, 0};
+        render_pass_info.renderArea.extent = m_swapchain->get_extent();
+        render_pass_info.clearValueCount = 2;
+        render_pass_info.pClearValues = clear_values;
+
+        vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
+
+    // Layout transitions the render pass used to do: undefined -> color / depth attachment,
+    // or for the late culling pass: early pass output -> attachment again
+    VkImageMemoryBarrier barriers[3]{};
+    uint32_t barrier_count = 2;
+    barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[0].srcAccessMask = late ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : 0;
+    barriers[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (late ? VK_ACCESS_COLOR_ATTACHMENT_READ_BIT : 0);
+    barriers[0].oldLayout = late ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[0].image = m_swapchain->get_image(image_index);
+    barriers[0].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    VkImageAspectFlags depth_aspect = VK_IMAGE_ASPECT_DEPTH_BIT | (has_stencil_component(m_depth_format) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
+    barriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barriers[1].oldLayout = late ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[1].image = m_swapchain->get_depth_image();
+    barriers[1].subresourceRange = {depth_aspect, 0, 1, 0, 1};
+
+    VkImage color_target = m_swapchain->get_color_target();
+    if (color_target != VK_NULL_HANDLE)
+    {
+        barriers[2] = barriers[0];
+        barriers[2].image = color_target;
+        barrier_count = 3;
+    }
+
+    // The late pass also waits for the pyramid build to finish reading the depth
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | (late ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : 0),
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                         0, 0, nullptr, 0, nullptr, barrier_count, barriers);
+
+    VkRenderingAttachmentInfoKHR color_attachment{};
+    color_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    color_attachment.imageView = m_swapchain->get_image_view(image_index);
+    color_attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color_attachment.loadOp = late ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color_attachment.clearValue = clear_color;
+
+    // MSAA: render into the transient target and resolve into the swapchain image when rendering ends
+    if (color_target != VK_NULL_HANDLE)
+    {
+        color_attachment.imageView = m_swapchain->get_color_target_view();
+        color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        color_attachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+        color_attachment.resolveImageView = m_swapchain->get_image_view(image_index);
+        color_attachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
 
-    VkShaderModule shader_module;
-    if (vkCreateShaderModule(m_context->get_device(), &create_info, nullptr, &shader_module) != VK_SUCCESS)
+    VkRenderingAttachmentInfoKHR depth_attachment{};
+    depth_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    depth_attachment.imageView = m_swapchain->get_depth_image_view();
+    depth_attachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depth_attachment.loadOp = late ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depth_attachment.storeOp = phase == main_pass_phase::early ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depth_attachment.clearValue = clear_depth;
+
+    VkRenderingInfoKHR rendering_info{};
+    rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    rendering_info.renderArea.offset = {0, 0};
+    rendering_info.renderArea.extent = m_swapchain->get_extent();
+    rendering_info.layerCount = 1;
+    rendering_info.colorAttachmentCount = 1;
+    rendering_info.pColorAttachments = &color_attachment;
+    rendering_info.pDepthAttachment = &depth_attachment;
+    if (has_stencil_component(m_depth_format))
     {
-        throw std::runtime_error("failed to create shader module!");
+        rendering_info.pStencilAttachment = &depth_attachment;
     }
 
-    return shader_module;
+    m_cmd_begin_rendering(command_buffer, &rendering_info);
+}
+
+void backend::end_main_pass(VkCommandBuffer command_buffer, uint32_t image_index, main_pass_phase phase)
+{
+    if (!m_dynamic_rendering)
+    {
+        vkCmdEndRenderPass(command_buffer);
+        return;
+    }
+
+    m_cmd_end_rendering(command_buffer);
+
+    // The late pass continues on the same images; the pyramid build transitions the depth itself
+    if (phase == main_pass_phase::early)
+        return;
+
+    // color attachment -> present; the present semaphore provides the rest of the ordering
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_swapchain->get_image(image_index);
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 }
 
 void backend::cleanup_swapchain_dependents()
 {
     m_swapchain->cleanup_framebuffers();
 
-    vkDestroyPipeline(m_context->get_device(), m_graphics_pipeline, nullptr);
-    vkDestroyPipelineLayout(m_context->get_device(), m_pipeline_layout, nullptr);
-    vkDestroyRenderPass(m_context->get_device(), m_render_pass, nullptr);
+    // Frames still in flight may reference these; the deletion queue destroys them once retired
+    cleanup_pipelines();
+    deletion_queue* queue = m_context->get_deletion_queue();
+    queue->destroy_render_pass(m_render_pass);
+    queue->destroy_render_pass(m_early_render_pass);
+    queue->destroy_render_pass(m_late_render_pass);
+    m_render_pass = VK_NULL_HANDLE;
+    m_early_render_pass = VK_NULL_HANDLE;
+    m_late_render_pass = VK_NULL_HANDLE;
+}
+
+void backend::cleanup_pipelines()
+{
+    // Background compiles and rebuilds captured the layout / render pass about to be retired
+    m_shader_reloader.clear_targets();
+    m_pipelines.release_target();
+
+    m_context->get_deletion_queue()->destroy_pipeline_layout(m_pipeline_layout);
+    m_graphics_pipeline = VK_NULL_HANDLE;
+    m_depth_prepass_pipeline = VK_NULL_HANDLE;
+    m_pipeline_layout = VK_NULL_HANDLE;
 }
 
 void backend::cleanup()
 {
-    // Wait for the device to be idle before destroying objects
+    // Shutdown still drains the device: command buffers, semaphores and pools are destroyed directly
+    m_shader_reloader.stop();
     vkDeviceWaitIdle(m_context->get_device());
+    if (m_pass_statistics.is_enabled())
+    {
+        m_pass_statistics.log_latest();
+    }
 
+    // Registry compiles stop first: the particle variant still uses the layout m_particles destroys
     cleanup_swapchain_dependents();
+    cleanup_frame_resources();
+    m_lighting.cleanup();
+    m_lighting_available = false;
+    m_particles.cleanup();
+    m_particles_available = false;
+    m_texture_streamer.cleanup();
+    m_texture_streaming_available = false;
+    m_pipelines.cleanup();
+    m_culler.cleanup();
+    m_layout_cache.cleanup();
+    m_context->get_deletion_queue()->flush();
+}
 
-    vkFreeCommandBuffers(
-        m_context->get_device(),
-        m_context->get_command_pool(),
-        static_cast<uint32_t>(m_command_buffers.size()),
-        m_command_buffers.data());
+void backend::cleanup_frame_resources()
+{
+    if (!m_command_buffers.empty())
+    {
+        vkFreeCommandBuffers(
+            m_context->get_device(),
+            m_context->get_command_pool(),
+            static_cast<uint32_t>(m_command_buffers.size()),
+            m_command_buffers.data());
+        m_command_buffers.clear();
+    }
 
-    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (size_t i = 0; i < m_render_finished_semaphores.size(); i++)
     {
         vkDestroySemaphore(m_context->get_device(), m_render_finished_semaphores[i], nullptr);
         vkDestroySemaphore(m_context->get_device(), m_image_available_semaphores[i], nullptr);
-        vkDestroyFence(m_context->get_device(), m_in_flight_fences[i], nullptr);
     }
+    m_render_finished_semaphores.clear();
+    m_image_available_semaphores.clear();
+    m_frame_timeline_values.clear();
+    m_uniform_ring.cleanup();
+    m_descriptor_allocator.cleanup();
+    m_gpu_profiler.cleanup();
+    m_pass_statistics.cleanup();
+    m_frame_capture.cleanup();
 }
 
 void backend::recreate_swapchain_dependents()
 {
-    vkDeviceWaitIdle(m_context->get_device());
-
-    cleanup_swapchain_dependents();
+    // Minimized: acquire keeps reporting OUT_OF_DATE until the next resize brings a real size
+    if (m_window_width == 0 || m_window_height == 0)
+        return;
 
-    // swapchain 자체의 recreate() 호출 필요할 수 있음
-    // m_swapchain->recreate();
+    // No device wait: the old swapchain, views, targets and framebuffers are retired through the deletion queue
+    if (!m_swapchain->recreate(m_window_width, m_window_height))
+    {
+        throw std::runtime_error("failed to recreate swapchain!");
+    }
+    // Present ids restart with the new swapchain
+    m_frame_pacer.reset();
 
-    create_render_pass();
-    create_graphics_pipeline();
+    // Viewport and scissor are dynamic, so only a format change invalidates the pass and pipeline
+    if (m_swapchain->get_image_format() != m_color_format || m_swapchain->get_depth_format() != m_depth_format)
+    {
+        cleanup_swapchain_dependents();
+        create_render_pass();
+        create_graphics_pipeline();
+    }
 
-    // RenderPass 새로 만들었으니, swapchain에게 다시 Framebuffer 생성 요청
-    m_swapchain->create_framebuffers(m_render_pass);
+    // RenderPass에 맞게 swapchain에게 다시 Framebuffer 생성 요청 (dynamic rendering이면 생략)
+    create_framebuffers();
 }
 
 } // namespace juce
\ No newline at end of file
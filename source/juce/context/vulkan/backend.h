@@ -1,6 +1,20 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <juce/context/vulkan/frame_profile.h>
+#include <juce/context/vulkan/frame_pacer.h>
+#include <juce/context/vulkan/uniform_ring.h>
+#include <juce/context/vulkan/descriptor_allocator.h>
+#include <juce/context/vulkan/occlusion_culler.h>
+#include <juce/context/vulkan/clustered_lighting.h>
+#include <juce/context/vulkan/particle_system.h>
+#include <juce/context/vulkan/texture_streamer.h>
+#include <juce/context/vulkan/shader_reloader.h>
+#include <juce/context/vulkan/pipeline_registry.h>
+#include <juce/context/vulkan/gpu_profiler.h>
+#include <juce/context/vulkan/pass_statistics.h>
+#include <juce/context/vulkan/frame_capture.h>
+#include <juce/core/linear_arena.h>
 
 #include <vector>
 
@@ -22,28 +36,145 @@ public:
     ~backend();
     // backend 초기화 (RenderPass, Pipeline, CommandBuffer 등 생성)
     bool initialize();
+    // 입력 처리 전에 호출: 다음 vblank 마감 직전까지 대기 (생략 시 draw_frame에서 호출)
+    void wait_for_next_frame();
     // 렌더링 루프에서 매 프레임 호출될 함수
     void draw_frame();
     // 창 크기 변경 시 호출될 함수
     void on_window_resized(uint32_t width, uint32_t height);
 
+    // 프레임 프로파일 전환 (다음 프레임 시작 시 적용, 재시작 불필요)
+    void set_frame_profile(frame_profile profile);
+    frame_profile get_frame_profile() const;
+
+    // MSAA 샘플 수 (1, 2, 4, 8...; 장치 한도로 내림, 다음 프레임에 적용)
+    // - multisampled color/depth는 transient + lazily allocated, 서브패스 끝에서 resolve
+    void set_msaa_samples(uint32_t samples);
+    uint32_t get_msaa_samples() const;
+
+    // depth pre-pass 전환 (두 변형 모두 registry에 있으므로 재생성 없이 다음 프레임부터)
+    // - 켜면 depth만 먼저 그리고, 셰이딩 패스는 EQUAL 테스트로 보이는 픽셀만 처리 (early-Z)
+    // - 두 패스는 같은 vert.spv를 쓰지만 깊이가 비트 단위로 같다는 보장은 없음: 외부 셰이더가 invariant gl_Position을 선언한 경우에만 켤 것
+    void set_depth_prepass(bool enabled);
+    bool is_depth_prepass_enabled() const;
+
+    // GPU occlusion culling 전환 (다음 프레임에 depth / 패스 재생성)
+    // - 켜면 set_cull_objects의 오브젝트를 2단계 Hi-Z 컬링 후 indirect draw로 그림
+    // - depth가 샘플링 가능해야 하므로 transient가 아님, MSAA에서는 pyramid 없이 frustum 컬링만
+    void set_occlusion_culling(bool enabled);
+    bool is_occlusion_culling_enabled() const;
+
+    // 컬링 대상 교체 (GPU 버퍼 재생성) / 카메라 (column-major view * projection, reverse-Z)
+    void set_cull_objects(const cull_object* objects, uint32_t count);
+    // 컬링 대상별 스트리밍 텍스처 id (UINT32_MAX = 없음), 매 프레임 화면 크기를 streamer에 보고
+    void set_object_textures(const uint32_t* texture_ids, uint32_t count);
+    void set_view_projection(const float view_proj[16]);
+
+    // clustered forward lighting: 광원 목록 (world space) / 카메라 (column-major, reverse-Z)
+    // - set_camera는 컬링의 view * projection도 함께 갱신
+    // - 광원은 매 프레임 메인 패스 전에 compute로 cluster별 목록에 binning, 셰이딩은 set 1로 읽음
+    void set_lights(const point_light* lights, uint32_t count);
+    void set_camera(const float view[16], const float projection[16], float near_plane, float far_plane);
+
+    // GPU 파티클 방출기 교체 (world space, 카메라는 set_camera)
+    // - 방출 / 시뮬레이션 / 정렬은 메인 패스 전 compute, 그리기는 메인 패스 끝에 indirect draw
+    // - 방출기를 모두 빼도 이미 살아 있는 파티클은 수명이 다할 때까지 그려짐
+    void set_particle_emitters(const particle_emitter* emitters, uint32_t count);
+
+    // shader hot-reload 전환: 셰이더 소스 / .spv 변경 시 워커에서 파이프라인 재생성, 프레임 경계에서 교체
+    void set_shader_hot_reload(bool enabled);
+    bool is_shader_hot_reload_enabled() const;
+
+    // 패스별 pipeline statistics / occlusion query 전환 (다음 프레임부터 기록)
+    // - 결과는 frames in flight만큼 늦은 마지막 완료 프레임 기준, 패스 기록 순서
+    // - 장치가 pipelineStatisticsQuery를 지원하지 않으면 samples_passed만 유효
+    void set_pass_statistics(bool enabled);
+    bool is_pass_statistics_enabled() const;
+    const std::vector<pass_stats>& get_pass_statistics() const;
+
+    // 파이프라인 상태 설명 registry (등록하면 워커에서 병렬 컴파일, 준비 전에는 fallback으로 그림)
+    pipeline_registry& get_pipeline_registry();
+
+    // mip 스트리밍 텍스처 (매 프레임 update, 예산은 memory_stats 압박에 따라 줄어듦)
+    texture_streamer& get_texture_streamer();
+
+    // 화면 캡처 요청 (frames in flight만큼 뒤에 워커 스레드에서 callback / 파일 쓰기)
+    // - surface가 TRANSFER_SRC usage를 지원하지 않으면 요청은 처리되지 않고 남음
+    frame_capture& get_frame_capture();
+
+    // 현재 프레임 전용 임시 메모리 (draw list, 컬링 결과 등), 프레임 슬롯 재사용 시 일괄 해제
+    linear_arena& get_frame_arena();
+
+    // 셰이더 상수 ring (set 0 + push constant), 현재 프레임 구역에 기록
+    uniform_ring& get_uniform_ring();
+
+    // 현재 프레임 동안 유효한 descriptor set 할당 / layout 캐시
+    descriptor_allocator& get_descriptor_allocator();
+    descriptor_layout_cache& get_layout_cache();
+
+    // 입력-표시 지연 통계
+    frame_pacer::stats get_latency_stats() const;
+
 private:
     // 초기화 헬퍼 함수들
+    void create_uniform_ring();
+    void create_lighting();
+    void create_particles();
     void create_render_pass();
     void create_graphics_pipeline();
+    void create_framebuffers();
     void create_command_buffers();
     void create_sync_objects();
 
-    // 셰이더 파일을 읽고 모듈을 생성하는 헬퍼 함수
-    static std::vector<char> read_file(const std::string& filename);
-    VkShaderModule create_shader_module(const std::vector<char>& code);
+    // scene 파이프라인 설명 등록 (fallback = pre-pass 없는 기본 셰이딩)
+    void register_scene_pipelines();
+    // registry 파이프라인마다 hot-reload 대상 등록 (워커는 현재 target을 값으로 들고 재생성)
+    void register_reload_targets();
+    // 이번 프레임에 쓸 파이프라인 결정 (pre-pass 변형이 아직 컴파일 중이면 fallback 한 번에 그림)
+    void resolve_scene_pipelines();
 
     // Command Buffer에 렌더링 명령을 기록하는 함수
     void record_command_buffer(VkCommandBuffer command_buffer, uint32_t image_index);
+    // 이번 프레임의 패스들 (binning, 컬링, 메인 패스), 패스마다 GPU 프로파일 / 통계 범위
+    void record_frame_passes(VkCommandBuffer command_buffer, uint32_t image_index, VkExtent2D extent);
+    // 패스 시작 직후: 파이프라인, viewport / scissor, set 0 바인딩
+    void bind_scene_state(VkCommandBuffer command_buffer);
+    // 컬링 결과 draw (pre-pass가 켜져 있으면 depth만 먼저)
+    void draw_culled(VkCommandBuffer command_buffer, occlusion_culler::phase phase);
+    // 메인 패스 마지막 (불투명 오브젝트 다음): 파티클 billboard
+    void draw_particles(VkCommandBuffer command_buffer);
+    // 텍스처가 있는 오브젝트의 투영 크기를 streamer에 보고 (frustum 밖은 생략)
+    void report_texture_usage(VkExtent2D extent);
+
+    // 메인 패스는 한 번에 그리거나, occlusion culling 시 pyramid 생성을 사이에 두고 둘로 나눔
+    // - early: depth를 저장하고 color는 present 전환 없이 끝냄
+    // - late: color / depth를 LOAD로 이어 그림 (depth는 READ_ONLY에서 시작)
+    enum class main_pass_phase
+    {
+        single,
+        early,
+        late,
+    };
+
+    // 메인 패스 시작/종료: dynamic rendering이면 vkCmdBeginRendering + 레이아웃 전환, 아니면 RenderPass
+    void begin_main_pass(VkCommandBuffer command_buffer, uint32_t image_index, main_pass_phase phase = main_pass_phase::single);
+    void end_main_pass(VkCommandBuffer command_buffer, uint32_t image_index, main_pass_phase phase = main_pass_phase::single);
+    VkRenderPass build_render_pass(main_pass_phase phase);
 
     // 리소스 정리 함수
     void cleanup();
     void cleanup_swapchain_dependents();
+    void cleanup_frame_resources();
+    void cleanup_pipelines();
+    // MSAA 전환 적용 (render target, pass, pipeline 재생성)
+    void apply_msaa();
+    // occlusion culling 전환 적용 (depth 샘플링 여부가 바뀌므로 render target부터 재생성)
+    void apply_occlusion_culling();
+    // culler는 처음 필요할 때 생성, 사용 가능 여부 반환
+    bool ensure_culler();
+
+    // 대기 중인 프로파일을 적용 (frames in flight, 이미지 수, present mode)
+    void apply_frame_profile();
 
     // 창 크기 변경에 따른 리소스 재생성
     void recreate_swapchain_dependents();
@@ -51,18 +182,92 @@ private:
     vk_context* m_context;  // 소유하지 않음
     swapchain* m_swapchain; // 소유하지 않음
     VkRenderPass m_render_pass;
+    VkRenderPass m_early_render_pass = VK_NULL_HANDLE; // 2단계 컬링용 (framebuffer는 m_render_pass와 호환)
+    VkRenderPass m_late_render_pass = VK_NULL_HANDLE;
     VkPipelineLayout m_pipeline_layout;
-    VkPipeline m_graphics_pipeline;
+    VkPipeline m_graphics_pipeline;                    // 이번 프레임 셰이딩 (registry 소유)
+    VkPipeline m_depth_prepass_pipeline = VK_NULL_HANDLE; // 이번 프레임 pre-pass, 없으면 VK_NULL_HANDLE
+
+    // scene 파이프라인 변형
+    pipeline_registry m_pipelines;
+    pipeline_id m_scene_pipeline = 0;   // depth 쓰기 + GREATER (fallback)
+    pipeline_id m_shading_pipeline = 0; // pre-pass 뒤 EQUAL, depth 쓰기 없음
+    pipeline_id m_prepass_pipeline = 0; // depth only
+    VkFormat m_color_format = VK_FORMAT_UNDEFINED;
+    VkFormat m_depth_format = VK_FORMAT_UNDEFINED;
+
+    // depth (reverse-Z: 1 = near, 0 = far, GREATER 비교)
+    bool m_depth_prepass = false;
+
+    // MSAA
+    VkSampleCountFlagBits m_msaa_samples = VK_SAMPLE_COUNT_1_BIT;
+    bool m_msaa_dirty = false;
+
+    // GPU occlusion culling
+    occlusion_culler m_culler;
+    bool m_culler_initialized = false; // 처음 필요할 때 생성 (시작 시간 단축)
+    bool m_culling_available = false;  // 컬링 셰이더 / 파이프라인 준비 여부
+    bool m_occlusion_culling = false;
+    bool m_culling_dirty = false;
+    float m_view_proj[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+    // 패스별 GPU 시간 (profiler 캡처 중에만 기록)
+    gpu_profiler m_gpu_profiler;
+
+    // 패스별 작업량 (켜져 있을 때만 query 기록)
+    pass_statistics m_pass_statistics;
+
+    // 화면 readback (요청이 있을 때만 복사 기록)
+    frame_capture m_frame_capture;
+
+    // clustered forward lighting (binning 셰이더가 없으면 set 1 없이 동작)
+    clustered_lighting m_lighting;
+    bool m_lighting_available = false;
+
+    // GPU 파티클 (compute 셰이더가 없으면 방출기를 받아도 그리지 않음)
+    particle_system m_particles;
+    bool m_particles_available = false;
+
+    // 텍스처 스트리밍 (사용량 피드백용으로 컬링 대상 bounds를 CPU에도 보관)
+    texture_streamer m_texture_streamer;
+    bool m_texture_streaming_available = false;
+    std::vector<cull_object> m_cull_objects;
+    std::vector<uint32_t> m_object_textures;
+
+    // shader hot-reload
+    shader_reloader m_shader_reloader;
+    bool m_shader_hot_reload = false;
+
+    // VK_KHR_dynamic_rendering (미지원 시 RenderPass + Framebuffer)
+    bool m_dynamic_rendering = false;
+    PFN_vkCmdBeginRenderingKHR m_cmd_begin_rendering = nullptr;
+    PFN_vkCmdEndRenderingKHR m_cmd_end_rendering = nullptr;
     std::vector<VkCommandBuffer> m_command_buffers;
 
     // 동기화 객체
     std::vector<VkSemaphore> m_image_available_semaphores;
     std::vector<VkSemaphore> m_render_finished_semaphores;
-    std::vector<VkFence> m_in_flight_fences;
+    std::vector<uint64_t> m_frame_timeline_values; // 프레임 슬롯을 마지막으로 사용한 graphics timeline 값
+    frame_arena m_frame_arena;
+    uniform_ring m_uniform_ring;
+    descriptor_allocator m_descriptor_allocator;
+    descriptor_layout_cache m_layout_cache;
     uint32_t m_current_frame = 0;
-    const int MAX_FRAMES_IN_FLIGHT = 2;
+    uint32_t m_frames_in_flight;
+
+    // 프레임 프로파일
+    frame_profile m_frame_profile = frame_profile::balanced;
+    frame_profile m_pending_profile = frame_profile::balanced;
+    bool m_profile_dirty = false;
+
+    // 프레임 페이싱
+    frame_pacer m_frame_pacer;
+    bool m_frame_paced = false;
 
     // 창 크기 변경 여부를 추적하는 플래그
     bool m_framebuffer_resized = false;
+    // 마지막으로 받은 창 크기 (0이면 아직 모름: 현재 swapchain 크기로 재생성)
+    uint32_t m_window_width = 0;
+    uint32_t m_window_height = 0;
 };
 } // namespace juce
\ No newline at end of file
@@ -0,0 +1,392 @@
+// clustered_lighting은 "이 픽셀에 어떤 광원이 닿는지"를 미리 추려 두는 것을 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "clustered_lighting.h"
+#include "vk_context.h"
+#include "deletion_queue.h"
+#include "descriptor_allocator.h"
+#include "shader_module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace juce
+{
+
+// clustered_lighting.glsl cluster_params_block (std140)
+struct cluster_params
+{
+    float inv_proj[16];
+    uint32_t grid[4];
+    uint32_t counts[4];
+    float screen[4];
+    float slicing[4];
+};
+
+// clustered_lighting.glsl point_light (std430)
+struct gpu_point_light
+{
+    float position_radius[4];
+    float color_intensity[4];
+};
+
+static VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Column-major 4x4 inverse (cofactor expansion); returns false for a singular matrix
+static bool invert_matrix(const float m[16], float out[16])
+{
+    float inv[16];
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (std::fabs(det) < 1e-12f)
+        return false;
+
+    float inv_det = 1.0f / det;
+    for (int i = 0; i < 16; i++)
+    {
+        out[i] = inv[i] * inv_det;
+    }
+    return true;
+}
+
+clustered_lighting::clustered_lighting()
+    : m_context(nullptr), m_allocator(nullptr), m_frames_in_flight(0), m_frame_index(0), m_params_size(0), m_lights_offset(0), m_frame_stride(0), m_binned_empty(false), m_set_layout(VK_NULL_HANDLE), m_descriptor_set(VK_NULL_HANDLE), m_bin_layout(VK_NULL_HANDLE), m_bin_pipeline(VK_NULL_HANDLE), m_near_plane(0.1f), m_far_plane(1000.0f)
+{
+    // Identity view; a symmetric 90-degree reverse-Z projection until the first set_camera
+    const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    std::memcpy(m_view, identity, sizeof(m_view));
+    const float projection[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, -1, 0, 0, m_near_plane, 0};
+    invert_matrix(projection, m_inv_projection);
+}
+
+clustered_lighting::~clustered_lighting()
+{
+    cleanup();
+}
+
+bool clustered_lighting::initialize(vk_context* context, descriptor_allocator* allocator, descriptor_layout_cache* layout_cache, uint32_t frames_in_flight, const config& cfg)
+{
+    if (!context || !allocator || !layout_cache || frames_in_flight == 0 || cfg.grid_x == 0 || cfg.grid_y == 0 || cfg.grid_z == 0)
+    {
+        log_error("Invalid arguments provided to clustered_lighting::initialize");
+        return false;
+    }
+
+    m_context = context;
+    m_allocator = allocator;
+    m_config = cfg;
+    m_frames_in_flight = frames_in_flight;
+    m_frame_index = 0;
+    m_binned_empty = false;
+    m_descriptor_set = VK_NULL_HANDLE;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_context->get_physical_device(), &properties);
+    const VkPhysicalDeviceLimits& limits = properties.limits;
+
+    // Both dynamic offsets must satisfy their own alignment inside each frame region
+    VkDeviceSize alignment = std::max<VkDeviceSize>(std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment), 16);
+    m_params_size = sizeof(cluster_params);
+    m_lights_offset = align_up(m_params_size, alignment);
+    m_frame_stride = align_up(m_lights_offset + sizeof(gpu_point_light) * std::max(1u, m_config.max_lights), alignment);
+
+    try
+    {
+        resource_pool* resources = m_context->get_resources();
+        uint32_t cluster_count = m_config.grid_x * m_config.grid_y * m_config.grid_z;
+
+        m_frame_buffer = resources->create_buffer(m_frame_stride * m_frames_in_flight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        m_count_buffer = resources->create_buffer(sizeof(uint32_t) * cluster_count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        m_index_buffer = resources->create_buffer(sizeof(uint32_t) * cluster_count * std::max(1u, m_config.max_lights_per_cluster), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (!resources->get(m_frame_buffer) || !resources->get(m_count_buffer) || !resources->get(m_index_buffer))
+        {
+            throw std::runtime_error("failed to create cluster buffers!");
+        }
+
+        create_pipeline(layout_cache);
+    }
+    catch (const std::exception& e)
+    {
+        log_error("Failed to initialize clustered lighting: %s", e.what());
+        cleanup();
+        return false;
+    }
+
+    log_info("Clustered lighting: %ux%ux%u clusters, up to %u lights (%u per cluster)", m_config.grid_x, m_config.grid_y, m_config.grid_z, m_config.max_lights, m_config.max_lights_per_cluster);
+    return true;
+}
+
+void clustered_lighting::cleanup()
+{
+    if (!m_context)
+        return;
+
+    VkDevice device = m_context->get_device();
+    resource_pool* resources = m_context->get_resources();
+
+    resources->release(m_frame_buffer);
+    resources->release(m_count_buffer);
+    resources->release(m_index_buffer);
+    m_frame_buffer = buffer_handle{};
+    m_count_buffer = buffer_handle{};
+    m_index_buffer = buffer_handle{};
+
+    vkDestroyPipeline(device, m_bin_pipeline, nullptr);
+    vkDestroyPipelineLayout(device, m_bin_layout, nullptr);
+    m_descriptor_set = VK_NULL_HANDLE;
+    m_bin_pipeline = VK_NULL_HANDLE;
+    m_bin_layout = VK_NULL_HANDLE;
+    m_set_layout = VK_NULL_HANDLE;
+
+    m_allocator = nullptr;
+    m_context = nullptr;
+}
+
+bool clustered_lighting::resize_frames(uint32_t frames_in_flight)
+{
+    if (!m_context || frames_in_flight == 0)
+        return false;
+
+    // Only the parameter / light regions are per frame; the cluster lists and the pipeline are shared
+    resource_pool* resources = m_context->get_resources();
+    resources->release(m_frame_buffer);
+    m_frame_buffer = resources->create_buffer(m_frame_stride * frames_in_flight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (!resources->get(m_frame_buffer))
+    {
+        log_error("Failed to resize clustered lighting to %u frames in flight", frames_in_flight);
+        return false;
+    }
+
+    // The next begin_frame allocates a set that points at the new buffer
+    m_frames_in_flight = frames_in_flight;
+    m_frame_index = 0;
+    m_descriptor_set = VK_NULL_HANDLE;
+    return true;
+}
+
+void clustered_lighting::create_pipeline(descriptor_layout_cache* layout_cache)
+{
+    VkDevice device = m_context->get_device();
+
+    // Binned by compute, read by the shading pass
+    VkDescriptorSetLayoutBinding bindings[4]{};
+    VkDescriptorType types[4] = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = types[i];
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+
+    m_set_layout = layout_cache->get_layout(bindings, 4);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &m_set_layout;
+    if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &m_bin_layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create cluster pipeline layout!");
+    }
+
+    VkShaderModule module = load_shader_module(device, "shaders/cluster_bin.comp.spv");
+
+    VkComputePipelineCreateInfo pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipeline_info.stage.module = module;
+    pipeline_info.stage.pName = "main";
+    pipeline_info.layout = m_bin_layout;
+
+    VkResult result = vkCreateComputePipelines(device, m_context->get_pipeline_cache(), 1, &pipeline_info, nullptr, &m_bin_pipeline);
+    vkDestroyShaderModule(device, module, nullptr);
+
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create light binning pipeline!");
+    }
+}
+
+void clustered_lighting::write_descriptor_set()
+{
+    VkDevice device = m_context->get_device();
+
+    // The frame region is still selected by dynamic offsets, so every frame writes the same ranges
+    resource_pool* resources = m_context->get_resources();
+    VkBuffer frame_buffer = resources->get(m_frame_buffer)->buffer;
+    VkDescriptorBufferInfo buffer_infos[4] = {
+        {frame_buffer, 0, m_params_size},
+        {frame_buffer, m_lights_offset, sizeof(gpu_point_light) * std::max(1u, m_config.max_lights)},
+        {resources->get(m_count_buffer)->buffer, 0, VK_WHOLE_SIZE},
+        {resources->get(m_index_buffer)->buffer, 0, VK_WHOLE_SIZE},
+    };
+    VkDescriptorType types[4] = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+
+    VkWriteDescriptorSet writes[4]{};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = m_descriptor_set;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = types[i];
+        writes[i].pBufferInfo = &buffer_infos[i];
+    }
+    vkUpdateDescriptorSets(device, 4, writes, 0, nullptr);
+}
+
+void clustered_lighting::set_lights(const point_light* lights, uint32_t count)
+{
+    if (count > m_config.max_lights)
+    {
+        log_warn("%u lights exceed the cluster limit of %u, the rest are ignored", count, m_config.max_lights);
+        count = m_config.max_lights;
+    }
+    m_lights.assign(lights, lights + count);
+}
+
+uint32_t clustered_lighting::get_light_count() const
+{
+    return static_cast<uint32_t>(m_lights.size());
+}
+
+void clustered_lighting::set_camera(const float view[16], const float projection[16], float near_plane, float far_plane)
+{
+    float inv_projection[16];
+    if (!invert_matrix(projection, inv_projection) || near_plane <= 0.0f || far_plane <= near_plane)
+    {
+        log_warn("Ignoring camera with an invalid projection (near %.3f, far %.3f)", near_plane, far_plane);
+        return;
+    }
+
+    std::memcpy(m_view, view, sizeof(m_view));
+    std::memcpy(m_inv_projection, inv_projection, sizeof(m_inv_projection));
+    m_near_plane = near_plane;
+    m_far_plane = far_plane;
+    m_binned_empty = false;
+}
+
+void clustered_lighting::begin_frame(uint32_t frame_index)
+{
+    if (!m_context)
+        return;
+
+    m_frame_index = frame_index % m_frames_in_flight;
+
+    // This slot's pools were just reset by the allocator; the set lives for this frame only
+    m_descriptor_set = m_allocator->allocate(m_set_layout);
+    write_descriptor_set();
+}
+
+void clustered_lighting::bin(VkCommandBuffer command_buffer, VkExtent2D extent)
+{
+    if (!m_context || extent.width == 0 || extent.height == 0)
+        return;
+
+    uint8_t* region = static_cast<uint8_t*>(m_context->get_resources()->get(m_frame_buffer)->mapped) + m_frame_stride * m_frame_index;
+
+    cluster_params* params = reinterpret_cast<cluster_params*>(region);
+    std::memcpy(params->inv_proj, m_inv_projection, sizeof(params->inv_proj));
+    params->grid[0] = m_config.grid_x;
+    params->grid[1] = m_config.grid_y;
+    params->grid[2] = m_config.grid_z;
+    params->grid[3] = m_config.max_lights_per_cluster;
+    params->counts[0] = static_cast<uint32_t>(m_lights.size());
+    params->counts[1] = 0;
+    params->counts[2] = 0;
+    params->counts[3] = 0;
+    params->screen[0] = static_cast<float>(extent.width);
+    params->screen[1] = static_cast<float>(extent.height);
+    params->screen[2] = m_near_plane;
+    params->screen[3] = m_far_plane;
+
+    // slice = log(depth) * scale + bias
+    float log_ratio = std::log(m_far_plane / m_near_plane);
+    params->slicing[0] = static_cast<float>(m_config.grid_z) / log_ratio;
+    params->slicing[1] = -static_cast<float>(m_config.grid_z) * std::log(m_near_plane) / log_ratio;
+    params->slicing[2] = static_cast<float>(extent.width) / static_cast<float>(m_config.grid_x);
+    params->slicing[3] = static_cast<float>(extent.height) / static_cast<float>(m_config.grid_y);
+
+    // Lights go up in view space so neither the binning nor the shading pass transforms them per cluster / pixel
+    gpu_point_light* gpu_lights = reinterpret_cast<gpu_point_light*>(region + m_lights_offset);
+    const float* v = m_view;
+    for (size_t i = 0; i < m_lights.size(); i++)
+    {
+        const point_light& light = m_lights[i];
+        const float* p = light.position;
+        gpu_lights[i].position_radius[0] = v[0] * p[0] + v[4] * p[1] + v[8] * p[2] + v[12];
+        gpu_lights[i].position_radius[1] = v[1] * p[0] + v[5] * p[1] + v[9] * p[2] + v[13];
+        gpu_lights[i].position_radius[2] = v[2] * p[0] + v[6] * p[1] + v[10] * p[2] + v[14];
+        gpu_lights[i].position_radius[3] = light.radius;
+        gpu_lights[i].color_intensity[0] = light.color[0];
+        gpu_lights[i].color_intensity[1] = light.color[1];
+        gpu_lights[i].color_intensity[2] = light.color[2];
+        gpu_lights[i].color_intensity[3] = light.intensity;
+    }
+
+    // Params above are always written: shading binds this slot even when binning is skipped
+    // An empty light list bins to all-zero counts; once written the shared lists need no dispatch
+    if (m_lights.empty() && m_binned_empty)
+        return;
+
+    // The cluster lists are shared by all frames in flight: the previous frame's shading must be done reading
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    uint32_t offsets[2] = {static_cast<uint32_t>(m_frame_stride * m_frame_index), static_cast<uint32_t>(m_frame_stride * m_frame_index)};
+    uint32_t cluster_count = m_config.grid_x * m_config.grid_y * m_config.grid_z;
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_bin_pipeline);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_bin_layout, 0, 1, &m_descriptor_set, 2, offsets);
+    vkCmdDispatch(command_buffer, (cluster_count + 127) / 128, 1, 1);
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    m_binned_empty = m_lights.empty();
+}
+
+void clustered_lighting::bind(VkCommandBuffer command_buffer, VkPipelineLayout layout, uint32_t set_index)
+{
+    if (!m_context)
+        return;
+
+    uint32_t offsets[2] = {static_cast<uint32_t>(m_frame_stride * m_frame_index), static_cast<uint32_t>(m_frame_stride * m_frame_index)};
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, set_index, 1, &m_descriptor_set, 2, offsets);
+}
+
+VkDescriptorSetLayout clustered_lighting::get_descriptor_set_layout() const
+{
+    return m_set_layout;
+}
+
+} // namespace juce
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+#include <juce/context/vulkan/resource_pool.h>
+
+#include <vector>
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+class descriptor_allocator;
+class descriptor_layout_cache;
+
+// world-space 점광원
+struct point_light
+{
+    float position[3];
+    float radius; // 이 거리에서 기여가 0
+    float color[3];
+    float intensity;
+};
+
+/**
+ * clustered forward lighting
+ * - 관리: 프레임별 광원 / 파라미터 구역, cluster별 광원 index 목록, binning compute 파이프라인
+ * - descriptor set은 프레임마다 descriptor_allocator에서 받음 (layout은 descriptor_layout_cache 소유)
+ * - 화면 타일 x 지수 분할 깊이 구간(froxel)마다 영향을 주는 광원만 compute로 추려 둠
+ * - 셰이딩은 fragment가 속한 cluster의 목록만 순회 (shaders/clustered_lighting.glsl)
+ *
+ * descriptor set 레이아웃 (셰이딩 파이프라인에서는 set 1)
+ * - binding 0: 파라미터 (UNIFORM_BUFFER_DYNAMIC)
+ * - binding 1: view-space 광원 (STORAGE_BUFFER_DYNAMIC)
+ * - binding 2: cluster별 광원 수 (STORAGE_BUFFER)
+ * - binding 3: cluster별 광원 index (STORAGE_BUFFER)
+ */
+class clustered_lighting
+{
+public:
+    struct config
+    {
+        uint32_t grid_x = 16;                   // 화면 가로 타일 수
+        uint32_t grid_y = 9;                    // 화면 세로 타일 수
+        uint32_t grid_z = 24;                   // 깊이 구간 수
+        uint32_t max_lights = 4096;             // 프레임당 최대 광원 수
+        uint32_t max_lights_per_cluster = 128;  // 넘치면 cluster 목록에서 빠짐
+    };
+
+    clustered_lighting();
+    ~clustered_lighting();
+
+    // allocator / layout_cache는 소유하지 않음, 이 객체보다 오래 살아야 함
+    bool initialize(vk_context* context, descriptor_allocator* allocator, descriptor_layout_cache* layout_cache, uint32_t frames_in_flight, const config& cfg);
+    // GPU 객체만 정리 (device idle 이후), 광원 목록과 카메라는 유지
+    void cleanup();
+    // frames in flight 변경 (device idle 이후): 프레임별 구역만 다시 만들고 광원 / 카메라 / cluster 목록은 유지
+    bool resize_frames(uint32_t frames_in_flight);
+
+    // 광원 목록 교체 (max_lights 초과분은 무시)
+    void set_lights(const point_light* lights, uint32_t count);
+    uint32_t get_light_count() const;
+
+    // column-major, 오른손 view (-Z 방향) + reverse-Z 투영
+    void set_camera(const float view[16], const float projection[16], float near_plane, float far_plane);
+
+    // 프레임 슬롯 전환 (이 슬롯을 쓰던 GPU 작업이 끝난 뒤, allocator의 begin_frame 다음에 호출)
+    // - 이번 프레임의 set을 할당하고 기록 (실패 시 예외)
+    void begin_frame(uint32_t frame_index);
+
+    // 메인 패스 전에 기록 (패스 밖): 광원 업로드 + binning
+    void bin(VkCommandBuffer command_buffer, VkExtent2D extent);
+
+    // 셰이딩 파이프라인에 바인딩
+    void bind(VkCommandBuffer command_buffer, VkPipelineLayout layout, uint32_t set_index);
+
+    VkDescriptorSetLayout get_descriptor_set_layout() const;
+
+private:
+    void create_pipeline(descriptor_layout_cache* layout_cache);
+    void write_descriptor_set();
+
+    vk_context* m_context; // 소유하지 않음
+    descriptor_allocator* m_allocator; // 소유하지 않음
+    config m_config;
+    uint32_t m_frames_in_flight;
+    uint32_t m_frame_index;
+
+    // 프레임 구역 = [파라미터 | 광원], dynamic offset으로 바인딩
+    buffer_handle m_frame_buffer;
+    VkDeviceSize m_params_size;
+    VkDeviceSize m_lights_offset;
+    VkDeviceSize m_frame_stride;
+
+    buffer_handle m_count_buffer;
+    buffer_handle m_index_buffer;
+    bool m_binned_empty; // 광원 0개로 이미 binning됨 (다시 할 필요 없음)
+
+    VkDescriptorSetLayout m_set_layout; // layout cache 소유
+    VkDescriptorSet m_descriptor_set;   // 이번 프레임 것
+    VkPipelineLayout m_bin_layout;
+    VkPipeline m_bin_pipeline;
+
+    // CPU 측 상태 (cleanup 후에도 유지)
+    std::vector<point_light> m_lights;
+    float m_view[16];
+    float m_inv_projection[16];
+    float m_near_plane;
+    float m_far_plane;
+};
+
+} // namespace juce
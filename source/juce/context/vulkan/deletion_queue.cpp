@@ -0,0 +1,120 @@
+// deletion_queue는 "GPU가 다 쓴 객체를 언제 파괴할지"를 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "deletion_queue.h"
+#include "timeline.h"
+#include "memory_stats.h"
+
+namespace juce
+{
+
+deletion_queue::deletion_queue()
+    : m_device(VK_NULL_HANDLE), m_timeline(nullptr), m_memory(nullptr)
+{
+}
+
+deletion_queue::~deletion_queue()
+{
+    if (!m_entries.empty())
+    {
+        log_warn("deletion queue destroyed with %zu pending objects", m_entries.size());
+    }
+}
+
+void deletion_queue::initialize(VkDevice device, timeline* timeline, memory_stats* memory)
+{
+    m_device = device;
+    m_timeline = timeline;
+    m_memory = memory;
+}
+
+void deletion_queue::destroy_buffer(VkBuffer buffer) { push(object_type::buffer, (uint64_t)buffer); }
+void deletion_queue::destroy_image(VkImage image) { push(object_type::image, (uint64_t)image); }
+void deletion_queue::destroy_image_view(VkImageView view) { push(object_type::image_view, (uint64_t)view); }
+void deletion_queue::free_memory(VkDeviceMemory memory) { push(object_type::memory, (uint64_t)memory); }
+void deletion_queue::destroy_framebuffer(VkFramebuffer framebuffer) { push(object_type::framebuffer, (uint64_t)framebuffer); }
+void deletion_queue::destroy_render_pass(VkRenderPass render_pass) { push(object_type::render_pass, (uint64_t)render_pass); }
+void deletion_queue::destroy_pipeline(VkPipeline pipeline) { push(object_type::pipeline, (uint64_t)pipeline); }
+void deletion_queue::destroy_pipeline_layout(VkPipelineLayout layout) { push(object_type::pipeline_layout, (uint64_t)layout); }
+void deletion_queue::destroy_sampler(VkSampler sampler) { push(object_type::sampler, (uint64_t)sampler); }
+void deletion_queue::destroy_descriptor_pool(VkDescriptorPool pool) { push(object_type::descriptor_pool, (uint64_t)pool); }
+void deletion_queue::destroy_swapchain(VkSwapchainKHR swapchain) { push(object_type::swapchain, (uint64_t)swapchain); }
+
+void deletion_queue::push(object_type type, uint64_t handle)
+{
+    if (handle == 0)
+        return;
+
+    // Anything submitted so far may still reference the object
+    m_entries.push_back({type, handle, m_timeline->get_last_submitted()});
+}
+
+void deletion_queue::flush()
+{
+    if (m_entries.empty())
+        return;
+
+    uint64_t completed = m_timeline->get_completed_value();
+    while (!m_entries.empty() && m_entries.front().timeline_value <= completed)
+    {
+        destroy(m_entries.front());
+        m_entries.pop_front();
+    }
+}
+
+void deletion_queue::flush_all()
+{
+    for (const entry& e : m_entries)
+    {
+        destroy(e);
+    }
+    m_entries.clear();
+}
+
+size_t deletion_queue::get_pending_count() const
+{
+    return m_entries.size();
+}
+
+void deletion_queue::destroy(const entry& e)
+{
+    switch (e.type)
+    {
+    case object_type::buffer:
+        vkDestroyBuffer(m_device, (VkBuffer)e.handle, nullptr);
+        break;
+    case object_type::image:
+        vkDestroyImage(m_device, (VkImage)e.handle, nullptr);
+        break;
+    case object_type::image_view:
+        vkDestroyImageView(m_device, (VkImageView)e.handle, nullptr);
+        break;
+    case object_type::memory:
+        m_memory->free((VkDeviceMemory)e.handle);
+        break;
+    case object_type::framebuffer:
+        vkDestroyFramebuffer(m_device, (VkFramebuffer)e.handle, nullptr);
+        break;
+    case object_type::render_pass:
+        vkDestroyRenderPass(m_device, (VkRenderPass)e.handle, nullptr);
+        break;
+    case object_type::pipeline:
+        vkDestroyPipeline(m_device, (VkPipeline)e.handle, nullptr);
+        break;
+    case object_type::pipeline_layout:
+        vkDestroyPipelineLayout(m_device, (VkPipelineLayout)e.handle, nullptr);
+        break;
+    case object_type::sampler:
+        vkDestroySampler(m_device, (VkSampler)e.handle, nullptr);
+        break;
+    case object_type::descriptor_pool:
+        vkDestroyDescriptorPool(m_device, (VkDescriptorPool)e.handle, nullptr);
+        break;
+    case object_type::swapchain:
+        vkDestroySwapchainKHR(m_device, (VkSwapchainKHR)e.handle, nullptr);
+        break;
+    }
+}
+
+} // namespace juce
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <deque>
+#include <cstdint>
+
+namespace juce
+{
+
+class timeline;
+class memory_stats;
+
+/**
+ * 지연 파괴 큐
+ * - 관리: 더 이상 쓰지 않는 Vulkan 객체를 "마지막으로 사용했을 수 있는 timeline 값"과 함께 보관
+ * - flush: 완료된 값까지의 객체만 파괴 -> vkDeviceWaitIdle 없이 언제든 해제 요청 가능
+ * - 값은 제출 순서대로 증가하므로 앞에서부터만 확인
+ */
+class deletion_queue
+{
+public:
+    deletion_queue();
+    ~deletion_queue();
+
+    // memory는 free_memory 항목을 해제할 때 통계와 함께 처리
+    void initialize(VkDevice device, timeline* timeline, memory_stats* memory);
+
+    // 지금까지 제출된 작업이 모두 끝난 뒤 파괴
+    void destroy_buffer(VkBuffer buffer);
+    void destroy_image(VkImage image);
+    void destroy_image_view(VkImageView view);
+    void free_memory(VkDeviceMemory memory);
+    void destroy_framebuffer(VkFramebuffer framebuffer);
+    void destroy_render_pass(VkRenderPass render_pass);
+    void destroy_pipeline(VkPipeline pipeline);
+    void destroy_pipeline_layout(VkPipelineLayout layout);
+    void destroy_sampler(VkSampler sampler);
+    void destroy_descriptor_pool(VkDescriptorPool pool);
+    void destroy_swapchain(VkSwapchainKHR swapchain);
+
+    // 완료된 항목 파괴 (매 프레임 호출)
+    void flush();
+    // 전부 파괴 (device idle 이후에만 호출)
+    void flush_all();
+
+    size_t get_pending_count() const;
+
+private:
+    enum class object_type : uint32_t
+    {
+        buffer,
+        image,
+        image_view,
+        memory,
+        framebuffer,
+        render_pass,
+        pipeline,
+        pipeline_layout,
+        sampler,
+        descriptor_pool,
+        swapchain,
+    };
+
+    struct entry
+    {
+        object_type type;
+        uint64_t handle; // non-dispatchable handle 값
+        uint64_t timeline_value;
+    };
+
+    void push(object_type type, uint64_t handle);
+    void destroy(const entry& e);
+
+    VkDevice m_device;
+    timeline* m_timeline;   // 소유하지 않음
+    memory_stats* m_memory; // 소유하지 않음
+    std::deque<entry> m_entries;
+};
+
+} // namespace juce
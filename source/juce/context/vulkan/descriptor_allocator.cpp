@@ -0,0 +1,237 @@
+// descriptor_allocator는 "프레임 동안 쓸 descriptor set을 어디서 꺼낼지"를 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "descriptor_allocator.h"
+#include "vk_context.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace juce
+{
+
+descriptor_allocator::descriptor_allocator()
+    : m_context(nullptr), m_current(0), m_pool_count(0)
+{
+}
+
+descriptor_allocator::~descriptor_allocator()
+{
+    cleanup();
+}
+
+bool descriptor_allocator::initialize(vk_context* context, uint32_t frames_in_flight, const config& cfg)
+{
+    if (!context || frames_in_flight == 0)
+    {
+        log_error("Invalid arguments provided to descriptor_allocator::initialize");
+        return false;
+    }
+
+    m_context = context;
+    m_config = cfg;
+    m_frames.assign(frames_in_flight, frame_pools{});
+    m_current = 0;
+    m_pool_count = 0;
+    return true;
+}
+
+void descriptor_allocator::cleanup()
+{
+    if (!m_context)
+        return;
+
+    VkDevice device = m_context->get_device();
+    for (frame_pools& pools : m_frames)
+    {
+        for (VkDescriptorPool pool : pools.used)
+        {
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        }
+        for (VkDescriptorPool pool : pools.ready)
+        {
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        }
+    }
+    m_frames.clear();
+    m_pool_count = 0;
+}
+
+void descriptor_allocator::begin_frame(uint32_t frame_index)
+{
+    m_current = frame_index % static_cast<uint32_t>(m_frames.size());
+    frame_pools& pools = m_frames[m_current];
+
+    // One reset per pool returns every set at once, no vkFreeDescriptorSets
+    VkDevice device = m_context->get_device();
+    for (VkDescriptorPool pool : pools.used)
+    {
+        vkResetDescriptorPool(device, pool, 0);
+        pools.ready.push_back(pool);
+    }
+    pools.used.clear();
+}
+
+VkDescriptorSet descriptor_allocator::allocate(VkDescriptorSetLayout layout)
+{
+    frame_pools& pools = m_frames[m_current];
+    if (pools.used.empty())
+    {
+        pools.used.push_back(acquire_pool(pools));
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = pools.used.back();
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &layout;
+
+    VkDescriptorSet set = VK_NULL_HANDLE;
+    VkResult result = vkAllocateDescriptorSets(m_context->get_device(), &alloc_info, &set);
+
+    // The current pool is full; move on to a fresh one and retry once
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+    {
+        pools.used.push_back(acquire_pool(pools));
+        alloc_info.descriptorPool = pools.used.back();
+        result = vkAllocateDescriptorSets(m_context->get_device(), &alloc_info, &set);
+    }
+
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate descriptor set!");
+    }
+    return set;
+}
+
+VkDescriptorPool descriptor_allocator::acquire_pool(frame_pools& pools)
+{
+    if (!pools.ready.empty())
+    {
+        VkDescriptorPool pool = pools.ready.back();
+        pools.ready.pop_back();
+        return pool;
+    }
+    return create_pool();
+}
+
+VkDescriptorPool descriptor_allocator::create_pool()
+{
+    std::vector<VkDescriptorPoolSize> sizes;
+    sizes.reserve(m_config.ratios.size());
+    for (const pool_ratio& ratio : m_config.ratios)
+    {
+        uint32_t count = std::max(1u, static_cast<uint32_t>(ratio.ratio * m_config.sets_per_pool));
+        sizes.push_back({ratio.type, count});
+    }
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = m_config.sets_per_pool;
+    pool_info.poolSizeCount = static_cast<uint32_t>(sizes.size());
+    pool_info.pPoolSizes = sizes.data();
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(m_context->get_device(), &pool_info, nullptr, &pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    m_pool_count++;
+    log_debug("descriptor allocator: pool %u created (frame slot %u)", m_pool_count, m_current);
+    return pool;
+}
+
+uint32_t descriptor_allocator::get_pool_count() const { return m_pool_count; }
+
+descriptor_layout_cache::descriptor_layout_cache()
+    : m_device(VK_NULL_HANDLE)
+{
+}
+
+descriptor_layout_cache::~descriptor_layout_cache()
+{
+    cleanup();
+}
+
+void descriptor_layout_cache::initialize(VkDevice device)
+{
+    m_device = device;
+}
+
+void descriptor_layout_cache::cleanup()
+{
+    for (auto& entry : m_layouts)
+    {
+        vkDestroyDescriptorSetLayout(m_device, entry.second, nullptr);
+    }
+    m_layouts.clear();
+}
+
+VkDescriptorSetLayout descriptor_layout_cache::get_layout(const VkDescriptorSetLayoutBinding* bindings, uint32_t binding_count, VkDescriptorSetLayoutCreateFlags flags)
+{
+    layout_key key;
+    key.bindings.assign(bindings, bindings + binding_count);
+    key.flags = flags;
+    std::sort(key.bindings.begin(), key.bindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+        return a.binding < b.binding;
+    });
+
+    auto it = m_layouts.find(key);
+    if (it != m_layouts.end())
+    {
+        return it->second;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.flags = flags;
+    layout_info.bindingCount = binding_count;
+    layout_info.pBindings = key.bindings.data();
+
+    VkDescriptorSetLayout layout;
+    if (vkCreateDescriptorSetLayout(m_device, &layout_info, nullptr, &layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    m_layouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+bool descriptor_layout_cache::layout_key::operator==(const layout_key& other) const
+{
+    if (flags != other.flags || bindings.size() != other.bindings.size())
+        return false;
+
+    // Immutable samplers are not part of the key; layouts that use them should not go through the cache
+    for (size_t i = 0; i < bindings.size(); i++)
+    {
+        const VkDescriptorSetLayoutBinding& a = bindings[i];
+        const VkDescriptorSetLayoutBinding& b = other.bindings[i];
+        if (a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags)
+            return false;
+    }
+    return true;
+}
+
+size_t descriptor_layout_cache::layout_key_hash::operator()(const layout_key& key) const
+{
+    // FNV-1a over the packed binding fields
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+
+    mix(key.flags);
+    for (const VkDescriptorSetLayoutBinding& binding : key.bindings)
+    {
+        mix(static_cast<uint64_t>(binding.binding) | static_cast<uint64_t>(binding.descriptorType) << 32);
+        mix(static_cast<uint64_t>(binding.descriptorCount) | static_cast<uint64_t>(binding.stageFlags) << 32);
+    }
+    return static_cast<size_t>(hash);
+}
+
+} // namespace juce
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+/**
+ * 프레임 단위 descriptor set 할당기
+ * - 관리: 프레임 슬롯마다 VkDescriptorPool 목록, 부족하면 풀을 하나 더 붙임
+ * - 개별 해제 없음: 슬롯의 GPU 작업이 끝나면(begin_frame) 풀 전체를 reset
+ * - 할당은 현재 풀에서 O(1), 풀은 재사용되므로 정상 상태에서 생성/파괴 없음
+ */
+class descriptor_allocator
+{
+public:
+    // 풀 하나가 set 하나당 담을 descriptor 비율
+    struct pool_ratio
+    {
+        VkDescriptorType type;
+        float ratio;
+    };
+
+    struct config
+    {
+        uint32_t sets_per_pool = 256;
+        std::vector<pool_ratio> ratios = {
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+            {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+            {VK_DESCRIPTOR_TYPE_SAMPLER, 1.0f},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f},
+        };
+    };
+
+    descriptor_allocator();
+    ~descriptor_allocator();
+
+    bool initialize(vk_context* context, uint32_t frames_in_flight, const config& cfg);
+    void cleanup();
+
+    // 프레임 슬롯의 GPU 작업이 끝난 뒤 호출, 해당 슬롯의 풀을 모두 reset
+    void begin_frame(uint32_t frame_index);
+
+    // 현재 프레임 동안만 유효한 set 할당 (실패 시 예외)
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+
+    // Getters
+    uint32_t get_pool_count() const;
+
+private:
+    struct frame_pools
+    {
+        std::vector<VkDescriptorPool> used; // 이번 프레임에 할당한 풀 (마지막이 현재 풀)
+        std::vector<VkDescriptorPool> ready; // reset된 재사용 대기 풀
+    };
+
+    VkDescriptorPool acquire_pool(frame_pools& pools);
+    VkDescriptorPool create_pool();
+
+    vk_context* m_context; // 소유하지 않음
+    config m_config;
+    std::vector<frame_pools> m_frames;
+    uint32_t m_current;
+    uint32_t m_pool_count;
+};
+
+/**
+ * descriptor set layout 캐시
+ * - binding 구성(binding, type, count, stage)의 해시로 동일 layout을 한 번만 생성
+ * - layout은 캐시가 소유, cleanup에서 일괄 파괴
+ */
+class descriptor_layout_cache
+{
+public:
+    descriptor_layout_cache();
+    ~descriptor_layout_cache();
+
+    void initialize(VkDevice device);
+    void cleanup();
+
+    // binding 순서는 상관없음 (내부에서 정렬)
+    VkDescriptorSetLayout get_layout(const VkDescriptorSetLayoutBinding* bindings, uint32_t binding_count, VkDescriptorSetLayoutCreateFlags flags = 0);
+
+private:
+    struct layout_key
+    {
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        VkDescriptorSetLayoutCreateFlags flags;
+
+        bool operator==(const layout_key& other) const;
+    };
+
+    struct layout_key_hash
+    {
+        size_t operator()(const layout_key& key) const;
+    };
+
+    VkDevice m_device;
+    std::unordered_map<layout_key, VkDescriptorSetLayout, layout_key_hash> m_layouts;
+};
+
+} // namespace juce
@@ -0,0 +1,482 @@
+// frame_capture는 "렌더링한 픽셀을 렌더 루프를 멈추지 않고 CPU로 가져오는 것"을 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+#include <juce/core/profiler.h>
+
+#include "frame_capture.h"
+#include "vk_context.h"
+#include "memory_stats.h"
+#include "image_format.h"
+#include "image_writer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+
+namespace juce
+{
+
+static double elapsed_ms(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+// "shot.png" -> "shot_00003.png" for multi-frame requests
+static std::string make_capture_path(const std::string& path, uint32_t frame_count, uint32_t sequence)
+{
+    if (frame_count <= 1)
+        return path;
+
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%05u", sequence);
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return path + suffix;
+    return path.substr(0, dot) + suffix + path.substr(dot);
+}
+
+// PNG is written from 8-bit four-channel formats; the swapchain is usually BGRA
+static bool get_png_swizzle(VkFormat format, bool& bgra)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+    case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+        bgra = false;
+        return true;
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        bgra = true;
+        return true;
+    default:
+        return false;
+    }
+}
+
+frame_capture::frame_capture()
+    : m_context(nullptr), m_frame_index(0), m_frame(0), m_request_sequence(0), m_active_jobs(0), m_stop(false), m_total_latency_ms(0.0), m_total_encode_ms(0.0)
+{
+}
+
+frame_capture::~frame_capture()
+{
+    cleanup();
+}
+
+bool frame_capture::initialize(vk_context* context, uint32_t frames_in_flight, const config& cfg)
+{
+    if (!context || frames_in_flight == 0 || cfg.max_queued_jobs == 0)
+    {
+        log_error("Invalid arguments provided to frame_capture::initialize");
+        return false;
+    }
+
+    cleanup();
+
+    m_context = context;
+    m_config = cfg;
+    m_frame_index = 0;
+    m_slots.resize(frames_in_flight);
+
+    m_stop = false;
+    m_worker = std::thread(&frame_capture::worker_loop, this);
+    return true;
+}
+
+void frame_capture::cleanup()
+{
+    if (!m_context)
+        return;
+
+    // The device is idle, so every recorded copy has landed
+    for (uint32_t i = 0; i < m_slots.size(); i++)
+    {
+        if (m_slots[i].pending)
+        {
+            submit_slot(i);
+        }
+    }
+
+    if (m_worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_worker.join();
+    }
+
+    for (frame_slot& slot : m_slots)
+    {
+        destroy_buffer(slot);
+    }
+    m_slots.clear();
+    m_context = nullptr;
+}
+
+void frame_capture::request(const capture_request& request)
+{
+    if (request.frame_count == 0)
+        return;
+    if (request.file != capture_file::none && request.path.empty())
+    {
+        log_warn("frame_capture: request without a path, skipped");
+        return;
+    }
+    m_requests.push_back(request);
+}
+
+bool frame_capture::has_pending_requests() const
+{
+    return !m_requests.empty();
+}
+
+void frame_capture::begin_frame(uint32_t frame_index)
+{
+    if (!m_context)
+        return;
+
+    m_frame_index = frame_index;
+    m_frame++;
+    if (m_slots[m_frame_index].pending)
+    {
+        submit_slot(m_frame_index);
+    }
+}
+
+void frame_capture::record(VkCommandBuffer command_buffer, VkImage image, VkImageLayout layout, VkFormat format, VkExtent2D extent)
+{
+    if (!m_context || m_requests.empty())
+        return;
+
+    frame_slot& slot = m_slots[m_frame_index];
+    if (slot.pending)
+        return;
+
+    // Never wait for the worker: the request simply moves on to the next frame
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (slot.busy || m_jobs.size() >= m_config.max_queued_jobs)
+        {
+            m_stats.deferred++;
+            return;
+        }
+    }
+
+    format_block_info info;
+    if (!get_format_block_info(format, info) || info.compressed)
+    {
+        log_warn("frame_capture: unsupported image format %d, request dropped", static_cast<int>(format));
+        m_requests.pop_front();
+        m_request_sequence = 0;
+        return;
+    }
+
+    VkDeviceSize row_pitch = static_cast<VkDeviceSize>(extent.width) * info.block_bytes;
+    if (!ensure_buffer(slot, row_pitch * extent.height))
+    {
+        m_requests.pop_front();
+        m_request_sequence = 0;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.failed++;
+        return;
+    }
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = layout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {extent.width, extent.height, 1};
+    vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &region);
+
+    // Back to the caller's layout; presentation is ordered by the submit's semaphore
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = layout;
+
+    // The host reads the buffer once the frame's timeline value has passed
+    VkBufferMemoryBarrier host_barrier{};
+    host_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    host_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    host_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    host_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    host_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    host_barrier.buffer = slot.buffer;
+    host_barrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &host_barrier, 0, nullptr);
+
+    const capture_request& request = m_requests.front();
+    slot.pending = true;
+    slot.frame = captured_frame{};
+    slot.frame.frame = m_frame;
+    slot.frame.sequence = m_request_sequence;
+    slot.frame.width = extent.width;
+    slot.frame.height = extent.height;
+    slot.frame.format = format;
+    slot.frame.row_pitch = static_cast<size_t>(row_pitch);
+    slot.file = request.file;
+    slot.path = make_capture_path(request.path, request.frame_count, m_request_sequence);
+    slot.on_captured = request.on_captured;
+    slot.recorded_at = std::chrono::steady_clock::now();
+
+    if (++m_request_sequence >= request.frame_count)
+    {
+        m_requests.pop_front();
+        m_request_sequence = 0;
+    }
+}
+
+void frame_capture::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle_cv.wait(lock, [this]()
+                   { return m_active_jobs == 0; });
+}
+
+frame_capture::stats frame_capture::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats result = m_stats;
+    if (result.captured > 0)
+    {
+        result.average_latency_ms = m_total_latency_ms / static_cast<double>(result.captured);
+    }
+    uint64_t completed = result.captured - m_active_jobs;
+    if (completed > 0)
+    {
+        result.average_encode_ms = m_total_encode_ms / static_cast<double>(completed);
+    }
+    return result;
+}
+
+bool frame_capture::ensure_buffer(frame_slot& slot, VkDeviceSize size)
+{
+    if (slot.capacity >= size)
+        return true;
+
+    // The slot's previous copy has completed and been read, so the old buffer can go right away
+    destroy_buffer(slot);
+
+    VkDevice device = m_context->get_device();
+    try
+    {
+        VkBufferCreateInfo buffer_info{};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size;
+        buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(device, &buffer_info, nullptr, &slot.buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create readback buffer!");
+        }
+
+        VkMemoryRequirements mem_requirements;
+        vkGetBufferMemoryRequirements(device, slot.buffer, &mem_requirements);
+
+        // Cached memory makes CPU reads fast; write-combined memory is the fallback
+        uint32_t memory_type;
+        try
+        {
+            memory_type = m_context->find_memory_type(mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+            VkPhysicalDeviceMemoryProperties properties;
+            vkGetPhysicalDeviceMemoryProperties(m_context->get_physical_device(), &properties);
+            slot.coherent = (properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+        }
+        catch (const std::runtime_error&)
+        {
+            memory_type = m_context->find_memory_type(mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            slot.coherent = true;
+        }
+
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = mem_requirements.size;
+        alloc_info.memoryTypeIndex = memory_type;
+
+        if (m_context->get_memory_stats()->allocate(alloc_info, memory_category::staging, &slot.memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate readback memory!");
+        }
+        vkBindBufferMemory(device, slot.buffer, slot.memory, 0);
+
+        void* mapped = nullptr;
+        if (vkMapMemory(device, slot.memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to map readback memory!");
+        }
+        slot.mapped = static_cast<const uint8_t*>(mapped);
+        slot.capacity = size;
+    }
+    catch (const std::runtime_error& e)
+    {
+        log_error("frame_capture: %s", e.what());
+        destroy_buffer(slot);
+        return false;
+    }
+    return true;
+}
+
+void frame_capture::destroy_buffer(frame_slot& slot)
+{
+    VkDevice device = m_context->get_device();
+    if (slot.buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(device, slot.buffer, nullptr);
+    }
+    if (slot.memory != VK_NULL_HANDLE)
+    {
+        m_context->get_memory_stats()->free(slot.memory);
+    }
+    slot.buffer = VK_NULL_HANDLE;
+    slot.memory = VK_NULL_HANDLE;
+    slot.mapped = nullptr;
+    slot.capacity = 0;
+}
+
+void frame_capture::submit_slot(uint32_t slot_index)
+{
+    frame_slot& slot = m_slots[slot_index];
+    slot.pending = false;
+
+    if (!slot.coherent)
+    {
+        VkMappedMemoryRange range{};
+        range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        range.memory = slot.memory;
+        range.size = VK_WHOLE_SIZE;
+        vkInvalidateMappedMemoryRanges(m_context->get_device(), 1, &range);
+    }
+
+    capture_job job;
+    job.slot = slot_index;
+    job.frame = slot.frame;
+    job.frame.pixels = slot.mapped;
+    job.frame.latency_ms = elapsed_ms(slot.recorded_at);
+    job.file = slot.file;
+    job.path = std::move(slot.path);
+    job.on_captured = std::move(slot.on_captured);
+    slot.on_captured = nullptr;
+
+    // The worker reads straight from the mapped buffer; the slot stays busy until it is done
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        slot.busy = true;
+        m_stats.captured++;
+        m_stats.bytes += static_cast<uint64_t>(job.frame.row_pitch) * job.frame.height;
+        m_total_latency_ms += job.frame.latency_ms;
+        m_active_jobs++;
+        m_jobs.push_back(std::move(job));
+    }
+    m_cv.notify_one();
+}
+
+void frame_capture::worker_loop()
+{
+    JUCE_PROFILE_THREAD("frame capture");
+
+    std::vector<uint8_t> scratch;
+    for (;;)
+    {
+        capture_job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]()
+                      { return m_stop || !m_jobs.empty(); });
+            // Queued captures are finished before stopping so none are lost on a frame profile switch
+            if (m_jobs.empty())
+                return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        process(job, scratch);
+        double encode_ms = elapsed_ms(start);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_slots[job.slot].busy = false;
+            m_total_encode_ms += encode_ms;
+            m_active_jobs--;
+        }
+        m_idle_cv.notify_all();
+    }
+}
+
+void frame_capture::process(const capture_job& job, std::vector<uint8_t>& scratch)
+{
+    JUCE_PROFILE_SCOPE("frame_capture::process");
+
+    const captured_frame& frame = job.frame;
+    if (job.on_captured)
+    {
+        job.on_captured(frame);
+    }
+
+    bool ok = true;
+    switch (job.file)
+    {
+    case capture_file::none:
+        return;
+    case capture_file::raw:
+        ok = write_raw(job.path, frame.height, frame.pixels, frame.row_pitch, frame.row_pitch);
+        break;
+    case capture_file::png:
+    {
+        bool bgra = false;
+        if (!get_png_swizzle(frame.format, bgra))
+        {
+            log_warn("frame_capture: format %d has no PNG mapping, writing %s.raw", static_cast<int>(frame.format), job.path.c_str());
+            ok = write_raw(job.path + ".raw", frame.height, frame.pixels, frame.row_pitch, frame.row_pitch);
+            break;
+        }
+
+        // Alpha is dropped: the swapchain is composited opaque
+        scratch.resize(static_cast<size_t>(frame.width) * frame.height * 3);
+        for (uint32_t y = 0; y < frame.height; y++)
+        {
+            const uint8_t* src = frame.pixels + y * frame.row_pitch;
+            uint8_t* dst = scratch.data() + static_cast<size_t>(y) * frame.width * 3;
+            for (uint32_t x = 0; x < frame.width; x++, src += 4, dst += 3)
+            {
+                dst[0] = bgra ? src[2] : src[0];
+                dst[1] = src[1];
+                dst[2] = bgra ? src[0] : src[2];
+            }
+        }
+        ok = write_png(job.path, frame.width, frame.height, 3, scratch.data(), static_cast<size_t>(frame.width) * 3);
+        break;
+    }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ok)
+    {
+        m_stats.written++;
+    }
+    else
+    {
+        m_stats.failed++;
+        log_error("frame_capture: failed to write %s", job.path.c_str());
+    }
+}
+
+} // namespace juce
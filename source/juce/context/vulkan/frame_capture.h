@@ -0,0 +1,161 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+// 캡처 결과를 파일로 남기는 방식
+enum class capture_file
+{
+    none, // callback만 (이미지 비교 등)
+    raw,  // 원본 포맷 그대로, 행 패딩만 제거
+    png,  // 8-bit RGB (4바이트 8-bit 포맷만, 아니면 raw로)
+};
+
+// CPU로 읽어온 프레임 (callback 동안만 유효)
+struct captured_frame
+{
+    uint64_t frame = 0;    // frame_capture가 센 프레임 번호
+    uint32_t sequence = 0; // 요청 안에서 몇 번째 프레임인지
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    const uint8_t* pixels = nullptr;
+    size_t row_pitch = 0;
+    double latency_ms = 0.0; // 복사 기록 -> CPU에서 읽을 수 있게 될 때까지
+};
+
+// 워커 스레드에서 호출, 파일 쓰기 전
+using capture_callback = std::function<void(const captured_frame& frame)>;
+
+struct capture_request
+{
+    uint32_t frame_count = 1; // 연속으로 캡처할 프레임 수
+    capture_file file = capture_file::png;
+    std::string path;         // frame_count > 1이면 확장자 앞에 _<sequence>
+    capture_callback on_captured;
+};
+
+/**
+ * frame capture
+ * - 관리: 프레임 슬롯별 host-visible readback 버퍼, 캡처 요청 큐, 인코딩 워커 스레드
+ * - record에서 이미지를 슬롯 버퍼로 복사, 같은 슬롯을 다시 쓸 때 (GPU 완료 후) 대기 없이 워커로 넘김
+ *   -> 결과는 frames in flight만큼 늦음, 렌더 루프는 인코딩 / 파일 쓰기를 기다리지 않음
+ * - 워커가 아직 슬롯을 읽는 중이면 그 프레임은 건너뛰고 요청은 다음 프레임으로 미룸
+ * - 버퍼는 처음 필요할 때 / 이미지가 커질 때만 생성, 캡처하지 않으면 비용 없음
+ */
+class frame_capture
+{
+public:
+    struct config
+    {
+        uint32_t max_queued_jobs = 8; // 워커 대기열이 차면 새 캡처를 미룸
+    };
+
+    struct stats
+    {
+        uint64_t captured = 0; // CPU로 읽어온 프레임
+        uint64_t written = 0;  // 파일로 쓴 프레임
+        uint64_t failed = 0;   // 버퍼 생성 / 파일 쓰기 실패
+        uint64_t deferred = 0; // 슬롯 / 워커가 바빠서 미룬 프레임
+        uint64_t bytes = 0;    // 읽어온 픽셀 바이트
+        double average_latency_ms = 0.0;
+        double average_encode_ms = 0.0; // callback + 파일 쓰기 (처리가 끝난 프레임 기준)
+    };
+
+    frame_capture();
+    ~frame_capture();
+
+    bool initialize(vk_context* context, uint32_t frames_in_flight, const config& cfg);
+    // device idle 이후: 복사가 끝난 슬롯을 마저 처리하고 워커를 비운 뒤 정리 (대기 중인 요청은 유지)
+    void cleanup();
+
+    // 다음 record부터 frame_count 프레임 캡처
+    void request(const capture_request& request);
+    bool has_pending_requests() const;
+
+    // 프레임 슬롯 전환 (이 슬롯을 쓰던 GPU 작업이 끝난 뒤): 복사된 프레임을 워커로
+    void begin_frame(uint32_t frame_index);
+    // 명령 버퍼 끝 (패스 밖, 프레임당 한 번): layout의 image를 복사하고 같은 layout으로 되돌림
+    // - swapchain 이미지는 TRANSFER_SRC usage가 있어야 함 (swapchain::supports_readback)
+    void record(VkCommandBuffer command_buffer, VkImage image, VkImageLayout layout, VkFormat format, VkExtent2D extent);
+
+    // 워커가 넘겨받은 작업을 모두 끝낼 때까지 대기 (테스트용)
+    void wait_idle();
+
+    stats get_stats() const;
+
+private:
+    struct frame_slot
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        const uint8_t* mapped = nullptr;
+        VkDeviceSize capacity = 0;
+        bool coherent = true;
+
+        // record ~ begin_frame
+        bool pending = false;
+        captured_frame frame;
+        capture_file file = capture_file::none;
+        std::string path;
+        capture_callback on_captured;
+        std::chrono::steady_clock::time_point recorded_at;
+
+        // 워커가 읽는 중 (m_mutex)
+        bool busy = false;
+    };
+
+    struct capture_job
+    {
+        uint32_t slot;
+        captured_frame frame;
+        capture_file file;
+        std::string path;
+        capture_callback on_captured;
+    };
+
+    bool ensure_buffer(frame_slot& slot, VkDeviceSize size);
+    void destroy_buffer(frame_slot& slot);
+    // 복사가 끝난 슬롯을 워커로 넘김
+    void submit_slot(uint32_t slot_index);
+    void worker_loop();
+    void process(const capture_job& job, std::vector<uint8_t>& scratch);
+
+    vk_context* m_context; // 소유하지 않음
+    config m_config;
+    std::vector<frame_slot> m_slots;
+    uint32_t m_frame_index;
+    uint64_t m_frame;
+
+    // 메인 스레드 전용
+    std::deque<capture_request> m_requests;
+    uint32_t m_request_sequence; // 맨 앞 요청에서 이미 기록한 프레임 수
+
+    // 워커 스레드
+    std::thread m_worker;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_idle_cv;
+    std::deque<capture_job> m_jobs;
+    uint32_t m_active_jobs; // 대기 + 처리 중
+    bool m_stop;
+    stats m_stats;
+    double m_total_latency_ms;
+    double m_total_encode_ms;
+};
+
+} // namespace juce
@@ -0,0 +1,239 @@
+// frame_pacer는 "언제 다음 프레임의 CPU 작업을 시작할지"를 책임
+#include <juce/core/logger.h>
+
+#include "frame_pacer.h"
+#include "vk_context.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace juce
+{
+
+static const uint32_t FRAME_START_HISTORY = 16;
+static const uint32_t LATENCY_HISTORY = 240;
+
+frame_pacer::frame_pacer()
+    : m_context(nullptr), m_wait_for_present(nullptr), m_swapchain(VK_NULL_HANDLE), m_present_id(0), m_waited_id(0), m_refresh_interval_ms(1000.0 / 60.0), m_work_estimate_ms(0.0), m_latency_cursor(0), m_latency_count(0), m_frame_count(0)
+{
+}
+
+bool frame_pacer::initialize(vk_context* context, const config& cfg)
+{
+    if (!context)
+    {
+        log_error("Invalid context provided to frame_pacer::initialize");
+        return false;
+    }
+
+    m_context = context;
+    m_config = cfg;
+    m_frame_starts.assign(FRAME_START_HISTORY, clock::now());
+    m_latency_samples.assign(LATENCY_HISTORY, 0.0);
+    m_last_vblank = clock::now();
+
+    if (m_context->is_device_extension_enabled(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+    {
+        m_wait_for_present = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(m_context->get_device(), "vkWaitForPresentKHR");
+    }
+
+    log_info("Frame pacing: %s", m_wait_for_present ? "present wait" : "CPU timing fallback");
+    return true;
+}
+
+void frame_pacer::begin_frame(VkSwapchainKHR swapchain)
+{
+    if (swapchain != m_swapchain)
+    {
+        reset();
+        m_swapchain = swapchain;
+    }
+
+    if (!m_config.enabled || !m_context)
+    {
+        m_frame_start = clock::now();
+        return;
+    }
+
+    // Block until at most max_queued_frames presents are still waiting for scanout
+    if (m_wait_for_present && m_present_id > m_config.max_queued_frames)
+    {
+        uint64_t target_id = m_present_id - m_config.max_queued_frames;
+        if (target_id > m_waited_id)
+        {
+            const uint64_t timeout_ns = 100ull * 1000 * 1000;
+            VkResult result = m_wait_for_present(m_context->get_device(), m_swapchain, target_id, timeout_ns);
+            clock::time_point now = clock::now();
+
+            if (result == VK_SUCCESS)
+            {
+                // Consecutive ids displayed back to back give the refresh interval
+                if (m_waited_id != 0 && target_id == m_waited_id + 1)
+                {
+                    double interval = to_ms(now - m_last_vblank);
+                    if (interval > 2.0 && interval < 50.0)
+                    {
+                        m_refresh_interval_ms += (interval - m_refresh_interval_ms) * 0.1;
+                    }
+                }
+                m_last_vblank = now;
+                m_waited_id = target_id;
+                add_latency_sample(to_ms(now - m_frame_starts[target_id % FRAME_START_HISTORY]));
+            }
+            else if (result != VK_TIMEOUT)
+            {
+                // Out of date or surface lost; the swapchain is about to be recreated
+                reset();
+            }
+        }
+    }
+
+    // Start late enough that the frame finishes just before the vblank it will be shown at
+    clock::time_point now = clock::now();
+    auto interval = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::milli>(m_refresh_interval_ms));
+    auto lead = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::milli>(m_work_estimate_ms + m_config.safety_margin_ms));
+
+    clock::time_point target;
+    if (m_wait_for_present)
+    {
+        // Every present still queued ahead of us occupies one vblank
+        uint64_t frames_ahead = (m_present_id - m_waited_id) + 1;
+        target = m_last_vblank + interval * static_cast<int64_t>(frames_ahead) - lead;
+    }
+    else
+    {
+        // Extrapolate the vblank proxy to the first slot we can still make
+        target = m_last_vblank + interval - lead;
+        while (target + interval < now)
+        {
+            target += interval;
+        }
+    }
+
+    if (target > now && target - now < interval * 2)
+    {
+        wait_until(target);
+    }
+
+    m_frame_start = clock::now();
+}
+
+void frame_pacer::begin_work()
+{
+    clock::time_point now = clock::now();
+
+    // Without present timing, a blocking acquire releases on vblank and serves as the proxy
+    if (!m_wait_for_present && now - m_frame_start > std::chrono::microseconds(500))
+    {
+        double interval = to_ms(now - m_last_vblank);
+        if (interval > 2.0 && interval < 50.0)
+        {
+            m_refresh_interval_ms += (interval - m_refresh_interval_ms) * 0.1;
+        }
+        m_last_vblank = now;
+    }
+
+    m_work_start = now;
+}
+
+uint64_t frame_pacer::next_present_id()
+{
+    if (!m_wait_for_present)
+        return 0;
+
+    m_present_id++;
+    m_frame_starts[m_present_id % FRAME_START_HISTORY] = m_frame_start;
+    return m_present_id;
+}
+
+void frame_pacer::end_frame()
+{
+    clock::time_point now = clock::now();
+    double work = to_ms(now - m_work_start);
+    m_work_estimate_ms += (work - m_work_estimate_ms) * 0.1;
+
+    if (!m_wait_for_present)
+    {
+        // Estimated as time since the input sample plus one scanout interval
+        add_latency_sample(to_ms(now - m_frame_start) + m_refresh_interval_ms);
+    }
+
+    // Periodic report
+    if (++m_frame_count % 600 == 0)
+    {
+        stats s = get_stats();
+        log_debug("Frame latency avg %.2f ms (min %.2f / max %.2f), refresh %.2f ms, work %.2f ms%s",
+                  s.avg_latency_ms, s.min_latency_ms, s.max_latency_ms, s.refresh_interval_ms, s.work_estimate_ms,
+                  s.present_wait ? "" : " (estimated)");
+    }
+}
+
+void frame_pacer::reset()
+{
+    m_present_id = 0;
+    m_waited_id = 0;
+    m_last_vblank = clock::now();
+}
+
+void frame_pacer::set_enabled(bool enabled)
+{
+    m_config.enabled = enabled;
+}
+
+bool frame_pacer::uses_present_wait() const
+{
+    return m_wait_for_present != nullptr;
+}
+
+frame_pacer::stats frame_pacer::get_stats() const
+{
+    stats s{};
+    s.refresh_interval_ms = m_refresh_interval_ms;
+    s.work_estimate_ms = m_work_estimate_ms;
+    s.samples = m_latency_count;
+    s.present_wait = m_wait_for_present != nullptr;
+
+    if (m_latency_count == 0)
+        return s;
+
+    double sum = 0.0;
+    s.min_latency_ms = m_latency_samples[0];
+    s.max_latency_ms = m_latency_samples[0];
+    for (uint32_t i = 0; i < m_latency_count; i++)
+    {
+        double sample = m_latency_samples[i];
+        sum += sample;
+        s.min_latency_ms = std::min(s.min_latency_ms, sample);
+        s.max_latency_ms = std::max(s.max_latency_ms, sample);
+    }
+    s.avg_latency_ms = sum / m_latency_count;
+    return s;
+}
+
+void frame_pacer::wait_until(clock::time_point target)
+{
+    // Sleep coarsely, then yield for the last millisecond since OS sleeps overshoot
+    const auto spin = std::chrono::milliseconds(1);
+    if (target - clock::now() > spin)
+    {
+        std::this_thread::sleep_until(target - spin);
+    }
+    while (clock::now() < target)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void frame_pacer::add_latency_sample(double latency_ms)
+{
+    m_latency_samples[m_latency_cursor] = latency_ms;
+    m_latency_cursor = (m_latency_cursor + 1) % LATENCY_HISTORY;
+    m_latency_count = std::min(m_latency_count + 1, LATENCY_HISTORY);
+}
+
+double frame_pacer::to_ms(clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace juce
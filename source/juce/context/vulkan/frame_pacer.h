@@ -0,0 +1,96 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+/**
+ * frame pacer
+ * - CPU 작업 시작을 다음 vblank 마감 직전으로 미뤄서 큐에 쌓이는 프레임과 입력 지연을 줄임
+ * - VK_KHR_present_id / VK_KHR_present_wait 지원 시 실제 표시 시점 기준, 아니면 CPU 타이밍 기준
+ * - 입력 샘플(프레임 시작)부터 표시까지의 지연 통계 제공
+ */
+class frame_pacer
+{
+public:
+    struct config
+    {
+        bool enabled = true;
+        double safety_margin_ms = 1.5; // 예측한 작업 시간에 더할 여유
+        uint32_t max_queued_frames = 1; // present wait 모드에서 표시 대기 중으로 허용할 프레임 수
+    };
+
+    struct stats
+    {
+        double avg_latency_ms;
+        double min_latency_ms;
+        double max_latency_ms;
+        double refresh_interval_ms;
+        double work_estimate_ms;
+        uint32_t samples;
+        bool present_wait; // false면 지연 값은 CPU 타이밍 기반 추정치
+    };
+
+    frame_pacer();
+
+    bool initialize(vk_context* context, const config& cfg);
+
+    // CPU 작업(입력 처리 포함) 시작 직전에 호출, 필요한 만큼 대기
+    void begin_frame(VkSwapchainKHR swapchain);
+
+    // 이미지 획득 직후, 커맨드 기록 시작 전에 호출
+    void begin_work();
+
+    // present 직전에 호출, VkPresentIdKHR에 넣을 id 반환 (present wait 미사용 시 0)
+    uint64_t next_present_id();
+
+    // present 직후 호출
+    void end_frame();
+
+    // swapchain 재생성 시 호출 (present id는 swapchain마다 독립)
+    void reset();
+
+    void set_enabled(bool enabled);
+
+    // Getters
+    bool uses_present_wait() const;
+    stats get_stats() const;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    void wait_until(clock::time_point target);
+    void add_latency_sample(double latency_ms);
+    static double to_ms(clock::duration duration);
+
+    vk_context* m_context; // 소유하지 않음
+    config m_config;
+    PFN_vkWaitForPresentKHR m_wait_for_present;
+    VkSwapchainKHR m_swapchain;
+
+    // present id -> 해당 프레임의 시작 시각 (링)
+    std::vector<clock::time_point> m_frame_starts;
+    uint64_t m_present_id;
+    uint64_t m_waited_id;
+
+    clock::time_point m_frame_start;
+    clock::time_point m_work_start;
+    clock::time_point m_last_vblank;
+    double m_refresh_interval_ms;
+    double m_work_estimate_ms;
+
+    // 최근 지연 샘플 (링)
+    std::vector<double> m_latency_samples;
+    uint32_t m_latency_cursor;
+    uint32_t m_latency_count;
+    uint64_t m_frame_count;
+};
+
+} // namespace juce
@@ -0,0 +1,60 @@
+#include "frame_profile.h"
+
+#include <cstring>
+
+namespace juce
+{
+
+frame_config get_frame_config(frame_profile profile)
+{
+    switch (profile)
+    {
+    case frame_profile::lowest_latency:
+        // One frame queued at most; mailbox still needs a spare image to replace
+        return {1, 1, {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR}};
+    case frame_profile::max_throughput:
+        // Deep pipelining and no vblank blocking keep the GPU saturated
+        return {3, 2, {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR}};
+    case frame_profile::power_saving:
+        // Vsync-locked, so the GPU idles between vblanks
+        return {2, 0, {VK_PRESENT_MODE_FIFO_KHR}};
+    case frame_profile::balanced:
+    default:
+        return {2, 1, {VK_PRESENT_MODE_MAILBOX_KHR}};
+    }
+}
+
+const char* get_frame_profile_name(frame_profile profile)
+{
+    switch (profile)
+    {
+    case frame_profile::lowest_latency:
+        return "lowest_latency";
+    case frame_profile::max_throughput:
+        return "max_throughput";
+    case frame_profile::power_saving:
+        return "power_saving";
+    case frame_profile::balanced:
+    default:
+        return "balanced";
+    }
+}
+
+bool parse_frame_profile(const char* name, frame_profile& profile)
+{
+    if (!name)
+        return false;
+
+    const frame_profile profiles[] = {frame_profile::balanced, frame_profile::lowest_latency, frame_profile::max_throughput, frame_profile::power_saving};
+    for (frame_profile candidate : profiles)
+    {
+        if (std::strcmp(name, get_frame_profile_name(candidate)) == 0)
+        {
+            profile = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace juce
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+#include <vector>
+#include <cstdint>
+
+namespace juce
+{
+
+// 지연/처리량/전력 정책 프로파일
+enum class frame_profile
+{
+    balanced,
+    lowest_latency,
+    max_throughput,
+    power_saving
+};
+
+// 프로파일이 결정하는 프레임 구성
+struct frame_config
+{
+    uint32_t frames_in_flight;
+    uint32_t extra_images;                       // minImageCount 위에 추가로 요청할 swapchain 이미지 수
+    std::vector<VkPresentModeKHR> present_modes; // 선호 순서, 모두 없으면 FIFO
+};
+
+frame_config get_frame_config(frame_profile profile);
+
+const char* get_frame_profile_name(frame_profile profile);
+
+// "lowest_latency" 같은 이름을 프로파일로 변환, 모르는 이름이면 false
+bool parse_frame_profile(const char* name, frame_profile& profile);
+
+} // namespace juce
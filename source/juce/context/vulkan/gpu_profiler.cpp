@@ -0,0 +1,291 @@
+// gpu_profiler는 "GPU가 각 패스에 쓴 시간을 CPU 타임라인 위에 놓는 것"을 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "gpu_profiler.h"
+#include "vk_context.h"
+
+#include <algorithm>
+
+namespace juce
+{
+
+// Steady-clock time of a QueryPerformanceCounter value taken in the recent past
+static uint64_t qpc_to_cpu_ns(uint64_t qpc)
+{
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    uint64_t cpu_now = profiler::now_ns();
+
+    double age_ns = static_cast<double>(static_cast<int64_t>(now.QuadPart - qpc)) * 1e9 / static_cast<double>(frequency.QuadPart);
+    return cpu_now - static_cast<uint64_t>(std::max(0.0, age_ns));
+}
+
+gpu_profiler::gpu_profiler()
+    : m_context(nullptr),
+      m_frame_index(0),
+      m_ns_per_tick(1.0),
+      m_valid_mask(~0ull),
+      m_calibrated_timestamps(false),
+      m_gpu_origin(0),
+      m_cpu_origin(0),
+      m_was_capturing(false),
+      m_get_calibrated_timestamps(nullptr)
+{
+}
+
+gpu_profiler::~gpu_profiler()
+{
+    cleanup();
+}
+
+bool gpu_profiler::initialize(vk_context* context, uint32_t frames_in_flight, const config& cfg)
+{
+    if (!context || frames_in_flight == 0 || cfg.max_scopes == 0)
+    {
+        log_error("Invalid arguments provided to gpu_profiler::initialize");
+        return false;
+    }
+
+    cleanup();
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(context->get_physical_device(), &properties);
+
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(context->get_physical_device(), &family_count, nullptr);
+    std::vector<VkQueueFamilyProperties> families(family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(context->get_physical_device(), &family_count, families.data());
+
+    uint32_t valid_bits = families[context->get_graphics_queue_family()].timestampValidBits;
+    if (valid_bits == 0 || properties.limits.timestampPeriod <= 0.0f)
+    {
+        log_warn("GPU timestamps unsupported on the graphics queue, GPU profiling disabled");
+        return false;
+    }
+
+    m_context = context;
+    m_config = cfg;
+    m_ns_per_tick = properties.limits.timestampPeriod;
+    m_valid_mask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+    m_frame_index = 0;
+    m_was_capturing = false;
+    m_results.resize(m_config.max_scopes * 2);
+
+    VkQueryPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    pool_info.queryCount = m_config.max_scopes * 2;
+
+    m_slots.resize(frames_in_flight);
+    for (frame_slot& slot : m_slots)
+    {
+        if (vkCreateQueryPool(m_context->get_device(), &pool_info, nullptr, &slot.pool) != VK_SUCCESS)
+        {
+            log_error("Failed to create timestamp query pool");
+            cleanup();
+            return false;
+        }
+        slot.names.reserve(m_config.max_scopes);
+    }
+
+    // Calibrated timestamps are only usable when the device can pair its clock with QPC
+    m_calibrated_timestamps = false;
+    if (m_context->is_device_extension_enabled(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+    {
+        auto get_domains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)vkGetInstanceProcAddr(m_context->get_instance(), "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+        m_get_calibrated_timestamps = (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(m_context->get_device(), "vkGetCalibratedTimestampsEXT");
+
+        uint32_t domain_count = 0;
+        if (get_domains && m_get_calibrated_timestamps && get_domains(m_context->get_physical_device(), &domain_count, nullptr) == VK_SUCCESS)
+        {
+            std::vector<VkTimeDomainEXT> domains(domain_count);
+            get_domains(m_context->get_physical_device(), &domain_count, domains.data());
+            m_calibrated_timestamps =
+                std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != domains.end() &&
+                std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT) != domains.end();
+        }
+    }
+
+    // Without the extension the clocks are paired once here, while the queue is still idle
+    if (!calibrate())
+    {
+        log_warn("GPU timestamp calibration failed, GPU events may be offset from CPU events");
+    }
+    return true;
+}
+
+void gpu_profiler::cleanup()
+{
+    if (!m_context)
+        return;
+
+    for (frame_slot& slot : m_slots)
+    {
+        vkDestroyQueryPool(m_context->get_device(), slot.pool, nullptr);
+    }
+    m_slots.clear();
+    m_context = nullptr;
+}
+
+bool gpu_profiler::is_available() const
+{
+    return m_context != nullptr;
+}
+
+void gpu_profiler::begin_frame(uint32_t frame_index)
+{
+    if (!m_context)
+        return;
+
+    // Re-pair the clocks at the start of each capture so drift never spans more than one capture
+    bool capturing = profiler::get_instance()->is_capturing();
+    if (capturing && !m_was_capturing && m_calibrated_timestamps)
+    {
+        calibrate();
+    }
+    m_was_capturing = capturing;
+
+    m_frame_index = frame_index;
+    frame_slot& slot = m_slots[m_frame_index];
+    uint32_t count = static_cast<uint32_t>(slot.names.size());
+    if (!slot.recording || count == 0)
+    {
+        slot.recording = false;
+        slot.names.clear();
+        return;
+    }
+
+    // The slot's work has completed, so no wait flag is needed
+    VkResult result = vkGetQueryPoolResults(m_context->get_device(), slot.pool, 0, count * 2, count * 2 * sizeof(uint64_t), m_results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_SUCCESS)
+    {
+        profiler* cpu_profiler = profiler::get_instance();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint64_t begin = to_cpu_ns(m_results[i * 2]);
+            uint64_t end = to_cpu_ns(m_results[i * 2 + 1]);
+            cpu_profiler->record_gpu(slot.names[i], begin, std::max(begin, end));
+        }
+    }
+
+    slot.recording = false;
+    slot.names.clear();
+}
+
+void gpu_profiler::begin_commands(VkCommandBuffer command_buffer)
+{
+    if (!m_context)
+        return;
+
+    frame_slot& slot = m_slots[m_frame_index];
+    slot.recording = profiler::get_instance()->is_capturing();
+    slot.names.clear();
+    if (slot.recording)
+    {
+        vkCmdResetQueryPool(command_buffer, slot.pool, 0, m_config.max_scopes * 2);
+    }
+}
+
+uint32_t gpu_profiler::begin_scope(VkCommandBuffer command_buffer, const char* name)
+{
+    if (!m_context)
+        return UINT32_MAX;
+
+    frame_slot& slot = m_slots[m_frame_index];
+    if (!slot.recording || slot.names.size() >= m_config.max_scopes)
+        return UINT32_MAX;
+
+    uint32_t scope = static_cast<uint32_t>(slot.names.size());
+    slot.names.push_back(name);
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.pool, scope * 2);
+    return scope;
+}
+
+void gpu_profiler::end_scope(VkCommandBuffer command_buffer, uint32_t scope)
+{
+    if (scope == UINT32_MAX)
+        return;
+
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_slots[m_frame_index].pool, scope * 2 + 1);
+}
+
+bool gpu_profiler::calibrate()
+{
+    return m_calibrated_timestamps ? calibrate_with_extension() : calibrate_with_submit();
+}
+
+bool gpu_profiler::calibrate_with_extension()
+{
+    VkCalibratedTimestampInfoEXT infos[2]{};
+    infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+    infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    infos[1].timeDomain = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+
+    uint64_t timestamps[2];
+    uint64_t max_deviation;
+    if (m_get_calibrated_timestamps(m_context->get_device(), 2, infos, timestamps, &max_deviation) != VK_SUCCESS)
+        return false;
+
+    m_gpu_origin = timestamps[0];
+    m_cpu_origin = qpc_to_cpu_ns(timestamps[1]);
+    return true;
+}
+
+bool gpu_profiler::calibrate_with_submit()
+{
+    VkDevice device = m_context->get_device();
+
+    VkCommandBufferAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = m_context->get_command_pool();
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+
+    VkCommandBuffer command_buffer;
+    if (vkAllocateCommandBuffers(device, &alloc_info, &command_buffer) != VK_SUCCESS)
+        return false;
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VkQueryPool pool = m_slots[0].pool;
+    vkBeginCommandBuffer(command_buffer, &begin_info);
+    vkCmdResetQueryPool(command_buffer, pool, 0, 1);
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pool, 0);
+    vkEndCommandBuffer(command_buffer);
+
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer;
+
+    // The timestamp lands shortly after the submit returns on an idle queue; the error is the queue's wake-up latency
+    bool ok = vkQueueSubmit(m_context->get_graphics_queue(), 1, &submit_info, VK_NULL_HANDLE) == VK_SUCCESS;
+    uint64_t cpu_time = profiler::now_ns();
+    ok = ok && vkQueueWaitIdle(m_context->get_graphics_queue()) == VK_SUCCESS;
+
+    uint64_t gpu_time = 0;
+    ok = ok && vkGetQueryPoolResults(device, pool, 0, 1, sizeof(gpu_time), &gpu_time, sizeof(gpu_time), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) == VK_SUCCESS;
+    vkFreeCommandBuffers(device, m_context->get_command_pool(), 1, &command_buffer);
+
+    if (!ok)
+        return false;
+
+    m_gpu_origin = gpu_time;
+    m_cpu_origin = cpu_time;
+    return true;
+}
+
+uint64_t gpu_profiler::to_cpu_ns(uint64_t ticks) const
+{
+    // Timestamps are taken after the calibration point; the mask handles counters narrower than 64 bits
+    uint64_t delta = (ticks - m_gpu_origin) & m_valid_mask;
+    return m_cpu_origin + static_cast<uint64_t>(static_cast<double>(delta) * m_ns_per_tick);
+}
+
+} // namespace juce
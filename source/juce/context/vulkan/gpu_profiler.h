@@ -0,0 +1,108 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+#include <juce/core/profiler.h>
+
+#include <vector>
+#include <cstdint>
+
+#if JUCE_ENABLE_PROFILER
+// 명령 버퍼 안의 범위 측정, name은 문자열 리터럴
+#define JUCE_GPU_PROFILE_SCOPE(gpu_profiler, command_buffer, name) ::juce::gpu_profile_scope JUCE_PROFILE_CONCAT(juce_gpu_profile_scope_, __LINE__)(gpu_profiler, command_buffer, name)
+#else
+#define JUCE_GPU_PROFILE_SCOPE(gpu_profiler, command_buffer, name) ((void)0)
+#endif
+
+namespace juce
+{
+
+class vk_context;
+
+/**
+ * gpu profiler
+ * - 관리: 프레임 슬롯별 timestamp query pool, GPU tick -> CPU 시각 변환
+ * - profiler가 캡처 중인 프레임에서만 timestamp를 씀 (그 외에는 비용 없음)
+ * - 결과는 같은 슬롯을 다시 쓸 때 (GPU 완료 후) 읽어 profiler의 GPU 트랙으로 넘김
+ * - 시각 맞춤: VK_EXT_calibrated_timestamps가 있으면 캡처마다, 없으면 한 번 제출해 근사
+ */
+class gpu_profiler
+{
+public:
+    struct config
+    {
+        uint32_t max_scopes = 32; // 프레임당 범위 수 (넘치면 기록 안 함)
+    };
+
+    gpu_profiler();
+    ~gpu_profiler();
+
+    // graphics 큐가 timestamp를 지원하지 않으면 false (이후 호출은 아무것도 안 함)
+    bool initialize(vk_context* context, uint32_t frames_in_flight, const config& cfg);
+    // device idle 이후, 읽지 않은 결과는 버림
+    void cleanup();
+
+    // 프레임 슬롯 전환 (이 슬롯을 쓰던 GPU 작업이 끝난 뒤): 지난 결과를 profiler로 넘김
+    void begin_frame(uint32_t frame_index);
+    // 명령 버퍼 기록 시작 직후, 캡처 중이면 이 슬롯의 query reset
+    void begin_commands(VkCommandBuffer command_buffer);
+
+    // 범위 시작 / 끝 (캡처 중이 아니거나 슬롯이 차면 UINT32_MAX, end_scope는 무시)
+    uint32_t begin_scope(VkCommandBuffer command_buffer, const char* name);
+    void end_scope(VkCommandBuffer command_buffer, uint32_t scope);
+
+    bool is_available() const;
+
+private:
+    struct frame_slot
+    {
+        VkQueryPool pool = VK_NULL_HANDLE;
+        std::vector<const char*> names; // 범위 i = query 2i, 2i + 1
+        bool recording = false;         // 이번 기록에서 reset 됨
+    };
+
+    // GPU tick과 CPU 시각(ns)의 대응점 갱신
+    bool calibrate();
+    bool calibrate_with_extension();
+    bool calibrate_with_submit();
+    uint64_t to_cpu_ns(uint64_t ticks) const;
+
+    vk_context* m_context; // 소유하지 않음
+    config m_config;
+    std::vector<frame_slot> m_slots;
+    uint32_t m_frame_index;
+    std::vector<uint64_t> m_results;
+
+    double m_ns_per_tick;
+    uint64_t m_valid_mask;
+    bool m_calibrated_timestamps; // QPC 시간 영역까지 지원 (아니면 initialize에서 한 번 근사)
+    uint64_t m_gpu_origin;        // 대응점의 GPU tick
+    uint64_t m_cpu_origin;        // 대응점의 CPU 시각 (ns)
+    bool m_was_capturing;
+
+    PFN_vkGetCalibratedTimestampsEXT m_get_calibrated_timestamps;
+};
+
+// 범위 동안의 GPU 이벤트 (JUCE_GPU_PROFILE_SCOPE로 사용)
+class gpu_profile_scope
+{
+public:
+    gpu_profile_scope(gpu_profiler& profiler, VkCommandBuffer command_buffer, const char* name)
+        : m_profiler(profiler), m_command_buffer(command_buffer), m_scope(profiler.begin_scope(command_buffer, name))
+    {
+    }
+
+    ~gpu_profile_scope()
+    {
+        m_profiler.end_scope(m_command_buffer, m_scope);
+    }
+
+    gpu_profile_scope(const gpu_profile_scope&) = delete;
+    gpu_profile_scope& operator=(const gpu_profile_scope&) = delete;
+
+private:
+    gpu_profiler& m_profiler;
+    VkCommandBuffer m_command_buffer;
+    uint32_t m_scope;
+};
+
+} // namespace juce
@@ -0,0 +1,347 @@
+// image_file은 "컨테이너에서 mip 블록을 찾아 읽는 것"을 책임
+#include <juce/core/logger.h>
+
+#include "image_file.h"
+#include "image_format.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+namespace juce
+{
+
+static const uint8_t ktx2_identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+static uint32_t read_u32(const char* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint64_t read_u64(const char* data)
+{
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// Longest possible mip chain: floor(log2(max(width, height))) + 1 (header level counts are untrusted)
+static uint32_t max_mip_levels(uint32_t width, uint32_t height)
+{
+    uint32_t levels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+    {
+        levels++;
+    }
+    return levels;
+}
+
+static constexpr uint32_t make_fourcc(char a, char b, char c, char d)
+{
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+static VkFormat dxgi_to_vk_format(uint32_t dxgi_format)
+{
+    switch (dxgi_format)
+    {
+    case 28: // DXGI_FORMAT_R8G8B8A8_UNORM
+        return VK_FORMAT_R8G8B8A8_UNORM;
+    case 29: // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+        return VK_FORMAT_R8G8B8A8_SRGB;
+    case 71: // DXGI_FORMAT_BC1_UNORM
+        return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+        return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+    case 74: // DXGI_FORMAT_BC2_UNORM
+        return VK_FORMAT_BC2_UNORM_BLOCK;
+    case 75: // DXGI_FORMAT_BC2_UNORM_SRGB
+        return VK_FORMAT_BC2_SRGB_BLOCK;
+    case 77: // DXGI_FORMAT_BC3_UNORM
+        return VK_FORMAT_BC3_UNORM_BLOCK;
+    case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+        return VK_FORMAT_BC3_SRGB_BLOCK;
+    case 80: // DXGI_FORMAT_BC4_UNORM
+        return VK_FORMAT_BC4_UNORM_BLOCK;
+    case 81: // DXGI_FORMAT_BC4_SNORM
+        return VK_FORMAT_BC4_SNORM_BLOCK;
+    case 83: // DXGI_FORMAT_BC5_UNORM
+        return VK_FORMAT_BC5_UNORM_BLOCK;
+    case 84: // DXGI_FORMAT_BC5_SNORM
+        return VK_FORMAT_BC5_SNORM_BLOCK;
+    case 87: // DXGI_FORMAT_B8G8R8A8_UNORM
+        return VK_FORMAT_B8G8R8A8_UNORM;
+    case 91: // DXGI_FORMAT_B8G8R8A8_UNORM_SRGB
+        return VK_FORMAT_B8G8R8A8_SRGB;
+    case 95: // DXGI_FORMAT_BC6H_UF16
+        return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+    case 96: // DXGI_FORMAT_BC6H_SF16
+        return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+    case 98: // DXGI_FORMAT_BC7_UNORM
+        return VK_FORMAT_BC7_UNORM_BLOCK;
+    case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+        return VK_FORMAT_BC7_SRGB_BLOCK;
+    default:
+        return VK_FORMAT_UNDEFINED;
+    }
+}
+
+bool image_file::open(const std::string& path)
+{
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        log_error("Failed to open image file: %s", path.c_str());
+        return false;
+    }
+
+    uint64_t file_size = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    m_path = path;
+    m_mips.clear();
+
+    char magic[12] = {};
+    file.read(magic, sizeof(magic));
+    file.seekg(0);
+
+    bool ok = false;
+    if (std::memcmp(magic, ktx2_identifier, sizeof(ktx2_identifier)) == 0)
+    {
+        ok = parse_ktx2(file, file_size);
+    }
+    else if (std::memcmp(magic, "DDS ", 4) == 0)
+    {
+        ok = parse_dds(file, file_size);
+    }
+    else
+    {
+        log_error("Unknown image container: %s", path.c_str());
+        return false;
+    }
+
+    if (!ok)
+    {
+        log_error("Failed to parse image file: %s", path.c_str());
+        return false;
+    }
+
+    // Every level must lie within the file and match the block layout of its format
+    for (uint32_t mip = 0; mip < m_mips.size(); mip++)
+    {
+        uint32_t width = std::max(1u, m_width >> mip);
+        uint32_t height = std::max(1u, m_height >> mip);
+        if (m_mips[mip].offset > file_size || m_mips[mip].size > file_size - m_mips[mip].offset ||
+            m_mips[mip].size < get_image_size(m_format, width, height))
+        {
+            log_error("Image file %s has a truncated mip %u", path.c_str(), mip);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool image_file::read_mip(uint32_t mip, std::vector<char>& out) const
+{
+    if (mip >= m_mips.size())
+        return false;
+
+    std::ifstream file(m_path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    out.resize(static_cast<size_t>(m_mips[mip].size));
+    file.seekg(static_cast<std::streamoff>(m_mips[mip].offset));
+    file.read(out.data(), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+bool image_file::parse_ktx2(std::ifstream& file, uint64_t file_size)
+{
+    char header[80];
+    if (!file.read(header, sizeof(header)))
+        return false;
+
+    VkFormat format = static_cast<VkFormat>(read_u32(header + 12));
+    uint32_t width = read_u32(header + 20);
+    uint32_t height = read_u32(header + 24);
+    uint32_t depth = read_u32(header + 28);
+    uint32_t layers = read_u32(header + 32);
+    uint32_t faces = read_u32(header + 36);
+    uint32_t levels = std::max(1u, read_u32(header + 40));
+    uint32_t supercompression = read_u32(header + 44);
+
+    if (depth > 1 || layers > 1 || faces != 1)
+    {
+        log_error("Only 2D KTX2 textures are supported");
+        return false;
+    }
+    if (supercompression != 0)
+    {
+        log_error("Supercompressed KTX2 textures are not supported (scheme %u)", supercompression);
+        return false;
+    }
+    if (width == 0 || height == 0)
+    {
+        log_error("KTX2 texture has a zero extent (%ux%u)", width, height);
+        return false;
+    }
+    if (levels > max_mip_levels(width, height))
+    {
+        log_error("KTX2 texture claims %u mip levels for %ux%u", levels, width, height);
+        return false;
+    }
+
+    format_block_info info;
+    if (!get_format_block_info(format, info))
+    {
+        log_error("Unsupported KTX2 format %u", static_cast<uint32_t>(format));
+        return false;
+    }
+
+    // Level index follows the header, ordered from the base level down
+    std::vector<char> index(static_cast<size_t>(levels) * 24);
+    if (!file.read(index.data(), static_cast<std::streamsize>(index.size())))
+        return false;
+
+    m_mips.resize(levels);
+    for (uint32_t mip = 0; mip < levels; mip++)
+    {
+        uint64_t offset = read_u64(index.data() + mip * 24);
+        uint64_t size = read_u64(index.data() + mip * 24 + 8);
+        // Written as a subtraction so a huge offset + size cannot wrap past the check
+        if (offset > file_size || size > file_size - offset)
+        {
+            log_error("KTX2 mip %u lies outside the file", mip);
+            m_mips.clear();
+            return false;
+        }
+        m_mips[mip] = {offset, size};
+    }
+
+    m_format = format;
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+bool image_file::parse_dds(std::ifstream& file, uint64_t file_size)
+{
+    char header[128];
+    if (!file.read(header, sizeof(header)))
+        return false;
+
+    // The DDS_HEADER starts after the 4-byte magic
+    const char* dds = header + 4;
+    uint32_t height = read_u32(dds + 8);
+    uint32_t width = read_u32(dds + 12);
+    uint32_t depth = read_u32(dds + 20);
+    uint32_t levels = std::max(1u, read_u32(dds + 24));
+    uint32_t pf_flags = read_u32(dds + 76);
+    uint32_t fourcc = read_u32(dds + 80);
+    uint32_t rgb_bits = read_u32(dds + 84);
+    uint32_t r_mask = read_u32(dds + 88);
+    uint32_t caps2 = read_u32(dds + 108);
+
+    const uint32_t DDPF_FOURCC = 0x4;
+    const uint32_t DDPF_RGB = 0x40;
+    const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+
+    if (depth > 1 || (caps2 & DDSCAPS2_CUBEMAP))
+    {
+        log_error("Only 2D DDS textures are supported");
+        return false;
+    }
+    if (width == 0 || height == 0)
+    {
+        log_error("DDS texture has a zero extent (%ux%u)", width, height);
+        return false;
+    }
+    if (levels > max_mip_levels(width, height))
+    {
+        log_error("DDS texture claims %u mip levels for %ux%u", levels, width, height);
+        return false;
+    }
+
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint64_t data_offset = sizeof(header);
+
+    if (pf_flags & DDPF_FOURCC)
+    {
+        switch (fourcc)
+        {
+        case make_fourcc('D', 'X', 'T', '1'):
+            format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            break;
+        case make_fourcc('D', 'X', 'T', '3'):
+            format = VK_FORMAT_BC2_UNORM_BLOCK;
+            break;
+        case make_fourcc('D', 'X', 'T', '5'):
+            format = VK_FORMAT_BC3_UNORM_BLOCK;
+            break;
+        case make_fourcc('A', 'T', 'I', '1'):
+        case make_fourcc('B', 'C', '4', 'U'):
+            format = VK_FORMAT_BC4_UNORM_BLOCK;
+            break;
+        case make_fourcc('A', 'T', 'I', '2'):
+        case make_fourcc('B', 'C', '5', 'U'):
+            format = VK_FORMAT_BC5_UNORM_BLOCK;
+            break;
+        case make_fourcc('D', 'X', '1', '0'):
+        {
+            char dx10[20];
+            if (!file.read(dx10, sizeof(dx10)))
+                return false;
+
+            uint32_t array_size = read_u32(dx10 + 12);
+            if (array_size > 1)
+            {
+                log_error("DDS texture arrays are not supported");
+                return false;
+            }
+            format = dxgi_to_vk_format(read_u32(dx10));
+            data_offset += sizeof(dx10);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    else if ((pf_flags & DDPF_RGB) && rgb_bits == 32)
+    {
+        format = r_mask == 0x000000ff ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_B8G8R8A8_UNORM;
+    }
+
+    if (format == VK_FORMAT_UNDEFINED)
+    {
+        log_error("Unsupported DDS pixel format");
+        return false;
+    }
+
+    // DDS stores the mip chain tightly packed, largest level first
+    // levels <= 32 here, so the shifts stay defined
+    m_mips.resize(levels);
+    uint64_t offset = data_offset;
+    for (uint32_t mip = 0; mip < levels; mip++)
+    {
+        uint64_t size = get_image_size(format, std::max(1u, width >> mip), std::max(1u, height >> mip));
+        if (offset > file_size || size > file_size - offset)
+        {
+            log_error("DDS mip %u lies outside the file", mip);
+            m_mips.clear();
+            return false;
+        }
+        m_mips[mip] = {offset, size};
+        offset += size;
+    }
+
+    m_format = format;
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+} // namespace juce
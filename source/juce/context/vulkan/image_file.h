@@ -0,0 +1,50 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <vector>
+#include <string>
+#include <iosfwd>
+#include <cstdint>
+
+namespace juce
+{
+
+/**
+ * KTX2 / DDS 컨테이너 리더
+ * - open(): 헤더와 mip 인덱스만 읽음
+ * - read_mip(): 필요한 mip 블록만 디스크에서 읽음 (워커 스레드에서 호출 가능)
+ * - 블록 데이터는 변환 없이 그대로 GPU에 업로드
+ */
+class image_file
+{
+public:
+    struct mip_region
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    bool open(const std::string& path);
+
+    bool read_mip(uint32_t mip, std::vector<char>& out) const;
+
+    // Getters
+    const std::string& get_path() const { return m_path; }
+    VkFormat get_format() const { return m_format; }
+    uint32_t get_width() const { return m_width; }
+    uint32_t get_height() const { return m_height; }
+    uint32_t get_mip_levels() const { return static_cast<uint32_t>(m_mips.size()); }
+
+private:
+    bool parse_ktx2(std::ifstream& file, uint64_t file_size);
+    bool parse_dds(std::ifstream& file, uint64_t file_size);
+
+    std::string m_path;
+    VkFormat m_format = VK_FORMAT_UNDEFINED;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    std::vector<mip_region> m_mips;
+};
+
+} // namespace juce
@@ -0,0 +1,71 @@
+#include "image_format.h"
+
+namespace juce
+{
+
+bool get_format_block_info(VkFormat format, format_block_info& info)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R8_UNORM:
+        info = {1, 1, 1, false};
+        return true;
+    case VK_FORMAT_R8G8_UNORM:
+        info = {1, 1, 2, false};
+        return true;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        info = {1, 1, 4, false};
+        return true;
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+        info = {1, 1, 8, false};
+        return true;
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+        info = {1, 1, 16, false};
+        return true;
+
+    // 8 bytes per 4x4 block
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+    case VK_FORMAT_BC4_SNORM_BLOCK:
+        info = {4, 4, 8, true};
+        return true;
+
+    // 16 bytes per 4x4 block
+    case VK_FORMAT_BC2_UNORM_BLOCK:
+    case VK_FORMAT_BC2_SRGB_BLOCK:
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC5_SNORM_BLOCK:
+    case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+    case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        info = {4, 4, 16, true};
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+VkDeviceSize get_image_size(VkFormat format, uint32_t width, uint32_t height)
+{
+    format_block_info info;
+    if (!get_format_block_info(format, info))
+    {
+        return 0;
+    }
+
+    VkDeviceSize blocks_x = (width + info.block_width - 1) / info.block_width;
+    VkDeviceSize blocks_y = (height + info.block_height - 1) / info.block_height;
+    return blocks_x * blocks_y * info.block_bytes;
+}
+
+} // namespace juce
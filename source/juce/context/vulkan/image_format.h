@@ -0,0 +1,24 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+#include <cstdint>
+
+namespace juce
+{
+
+// 포맷 블록 정보 (비압축 포맷은 1x1 블록)
+struct format_block_info
+{
+    uint32_t block_width;
+    uint32_t block_height;
+    uint32_t block_bytes;
+    bool compressed;
+};
+
+// 지원하지 않는 포맷이면 false
+bool get_format_block_info(VkFormat format, format_block_info& info);
+
+// 한 mip 레벨의 바이트 크기 (블록 단위로 올림)
+VkDeviceSize get_image_size(VkFormat format, uint32_t width, uint32_t height);
+
+} // namespace juce
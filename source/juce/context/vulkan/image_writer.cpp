@@ -0,0 +1,362 @@
+// image_writer는 "캡처한 픽셀을 다른 도구가 읽을 수 있는 파일로 남기는 것"을 책임
+#include "image_writer.h"
+
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+
+namespace juce
+{
+
+// Deflate (RFC 1951) parameters for the single fixed-Huffman block
+static const uint32_t WINDOW_SIZE = 32768;
+static const uint32_t HASH_BITS = 15;
+static const uint32_t MAX_CHAIN = 32;
+static const uint32_t MIN_MATCH = 3;
+static const uint32_t MAX_MATCH = 258;
+
+static const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+namespace
+{
+
+// Deflate packs bits LSB first; Huffman codes are stored MSB first, so they are reversed on write
+class bit_writer
+{
+public:
+    explicit bit_writer(std::vector<uint8_t>& out)
+        : m_out(out), m_bits(0), m_count(0)
+    {
+    }
+
+    void write(uint32_t value, uint32_t count)
+    {
+        m_bits |= static_cast<uint64_t>(value) << m_count;
+        m_count += count;
+        while (m_count >= 8)
+        {
+            m_out.push_back(static_cast<uint8_t>(m_bits));
+            m_bits >>= 8;
+            m_count -= 8;
+        }
+    }
+
+    void write_code(uint32_t code, uint32_t length)
+    {
+        uint32_t reversed = 0;
+        for (uint32_t i = 0; i < length; i++)
+        {
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        }
+        write(reversed, length);
+    }
+
+    void flush()
+    {
+        if (m_count > 0)
+        {
+            m_out.push_back(static_cast<uint8_t>(m_bits));
+        }
+        m_bits = 0;
+        m_count = 0;
+    }
+
+private:
+    std::vector<uint8_t>& m_out;
+    uint64_t m_bits;
+    uint32_t m_count;
+};
+
+} // namespace
+
+static void write_literal(bit_writer& writer, uint32_t symbol)
+{
+    if (symbol < 144)
+        writer.write_code(0x30 + symbol, 8);
+    else if (symbol < 256)
+        writer.write_code(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        writer.write_code(symbol - 256, 7);
+    else
+        writer.write_code(0xC0 + symbol - 280, 8);
+}
+
+static void write_match(bit_writer& writer, uint32_t length, uint32_t distance)
+{
+    uint32_t code = 28;
+    while (LENGTH_BASE[code] > length)
+        code--;
+    write_literal(writer, 257 + code);
+    writer.write(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+    code = 29;
+    while (DISTANCE_BASE[code] > distance)
+        code--;
+    writer.write_code(code, 5);
+    writer.write(distance - DISTANCE_BASE[code], DISTANCE_EXTRA[code]);
+}
+
+static uint32_t hash3(const uint8_t* p)
+{
+    return ((static_cast<uint32_t>(p[0]) << 16 | static_cast<uint32_t>(p[1]) << 8 | p[2]) * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static uint32_t adler32(const uint8_t* data, size_t size)
+{
+    uint32_t a = 1;
+    uint32_t b = 0;
+    while (size > 0)
+    {
+        // 5552 is the most bytes that can be summed before b may overflow
+        size_t block = size < 5552 ? size : 5552;
+        for (size_t i = 0; i < block; i++)
+        {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += block;
+        size -= block;
+    }
+    return b << 16 | a;
+}
+
+// zlib stream: greedy LZ77 over hash chains, one fixed-Huffman block
+static void zlib_compress(const std::vector<uint8_t>& in, std::vector<uint8_t>& out)
+{
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    bit_writer writer(out);
+    writer.write(1, 1); // final block
+    writer.write(1, 2); // fixed Huffman
+
+    std::vector<int32_t> head(1u << HASH_BITS, -1);
+    std::vector<int32_t> prev(WINDOW_SIZE, -1);
+    const uint8_t* data = in.data();
+    size_t size = in.size();
+
+    size_t pos = 0;
+    while (pos < size)
+    {
+        uint32_t best_length = 0;
+        uint32_t best_distance = 0;
+        if (pos + MIN_MATCH <= size)
+        {
+            uint32_t hash = hash3(data + pos);
+            uint32_t max_length = static_cast<uint32_t>(std::min<size_t>(MAX_MATCH, size - pos));
+            int32_t candidate = head[hash];
+            for (uint32_t chain = 0; chain < MAX_CHAIN && candidate >= 0 && pos - candidate <= WINDOW_SIZE; chain++)
+            {
+                const uint8_t* a = data + candidate;
+                const uint8_t* b = data + pos;
+                uint32_t length = 0;
+                while (length < max_length && a[length] == b[length])
+                    length++;
+                if (length > best_length)
+                {
+                    best_length = length;
+                    best_distance = static_cast<uint32_t>(pos - candidate);
+                    if (length == max_length)
+                        break;
+                }
+                candidate = prev[candidate % WINDOW_SIZE];
+            }
+        }
+
+        uint32_t advance = 1;
+        if (best_length >= MIN_MATCH)
+        {
+            write_match(writer, best_length, best_distance);
+            advance = best_length;
+        }
+        else
+        {
+            write_literal(writer, data[pos]);
+        }
+
+        for (uint32_t i = 0; i < advance; i++, pos++)
+        {
+            if (pos + MIN_MATCH <= size)
+            {
+                uint32_t hash = hash3(data + pos);
+                prev[pos % WINDOW_SIZE] = head[hash];
+                head[hash] = static_cast<int32_t>(pos);
+            }
+        }
+    }
+
+    write_literal(writer, 256); // end of block
+    writer.flush();
+
+    uint32_t checksum = adler32(in.data(), in.size());
+    out.push_back(static_cast<uint8_t>(checksum >> 24));
+    out.push_back(static_cast<uint8_t>(checksum >> 16));
+    out.push_back(static_cast<uint8_t>(checksum >> 8));
+    out.push_back(static_cast<uint8_t>(checksum));
+}
+
+static uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    static bool table_ready = []()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return true;
+    }();
+    (void)table_ready;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void write_u32(std::vector<uint8_t>& out, uint32_t value)
+{
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void write_chunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t size)
+{
+    write_u32(out, static_cast<uint32_t>(size));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    write_u32(out, crc32(out.data() + start, size + 4));
+}
+
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+// Each row gets the filter with the smallest sum of absolute residuals (the libpng heuristic)
+static void filter_rows(uint32_t width, uint32_t height, uint32_t channels, const uint8_t* pixels, size_t row_pitch, std::vector<uint8_t>& out)
+{
+    size_t row_bytes = static_cast<size_t>(width) * channels;
+    out.resize((row_bytes + 1) * height);
+    std::vector<uint8_t> zero_row(row_bytes, 0);
+    std::vector<uint8_t> candidates[5];
+    for (std::vector<uint8_t>& candidate : candidates)
+        candidate.resize(row_bytes);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const uint8_t* row = pixels + y * row_pitch;
+        const uint8_t* above = y > 0 ? pixels + (y - 1) * row_pitch : zero_row.data();
+
+        uint64_t best_cost = UINT64_MAX;
+        uint32_t best_filter = 0;
+        for (uint32_t filter = 0; filter < 5; filter++)
+        {
+            uint8_t* residual = candidates[filter].data();
+            uint64_t cost = 0;
+            for (size_t x = 0; x < row_bytes; x++)
+            {
+                uint8_t left = x >= channels ? row[x - channels] : 0;
+                uint8_t up_left = x >= channels ? above[x - channels] : 0;
+                uint8_t predicted = 0;
+                switch (filter)
+                {
+                case 1:
+                    predicted = left;
+                    break;
+                case 2:
+                    predicted = above[x];
+                    break;
+                case 3:
+                    predicted = static_cast<uint8_t>((left + above[x]) / 2);
+                    break;
+                case 4:
+                    predicted = paeth(left, above[x], up_left);
+                    break;
+                }
+                residual[x] = static_cast<uint8_t>(row[x] - predicted);
+                cost += residual[x] < 128 ? residual[x] : 256 - residual[x];
+            }
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_filter = filter;
+            }
+        }
+
+        uint8_t* dst = out.data() + y * (row_bytes + 1);
+        dst[0] = static_cast<uint8_t>(best_filter);
+        std::copy(candidates[best_filter].begin(), candidates[best_filter].end(), dst + 1);
+    }
+}
+
+bool write_png(const std::string& path, uint32_t width, uint32_t height, uint32_t channels, const uint8_t* pixels, size_t row_pitch)
+{
+    if (width == 0 || height == 0 || (channels != 3 && channels != 4) || !pixels)
+        return false;
+
+    std::vector<uint8_t> filtered;
+    filter_rows(width, height, channels, pixels, row_pitch, filtered);
+
+    std::vector<uint8_t> compressed;
+    compressed.reserve(filtered.size() / 2);
+    zlib_compress(filtered, compressed);
+
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> file(SIGNATURE, SIGNATURE + 8);
+    file.reserve(compressed.size() + 64);
+
+    std::vector<uint8_t> header;
+    write_u32(header, width);
+    write_u32(header, height);
+    header.push_back(8);                     // bit depth
+    header.push_back(channels == 4 ? 6 : 2); // truecolor with / without alpha
+    header.push_back(0);                     // deflate
+    header.push_back(0);                     // adaptive filtering
+    header.push_back(0);                     // no interlace
+
+    write_chunk(file, "IHDR", header.data(), header.size());
+    write_chunk(file, "IDAT", compressed.data(), compressed.size());
+    write_chunk(file, "IEND", nullptr, 0);
+
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream)
+        return false;
+    stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+    return stream.good();
+}
+
+bool write_raw(const std::string& path, uint32_t height, const uint8_t* pixels, size_t row_bytes, size_t row_pitch)
+{
+    if (!pixels)
+        return false;
+
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream)
+        return false;
+    for (uint32_t y = 0; y < height; y++)
+    {
+        stream.write(reinterpret_cast<const char*>(pixels + y * row_pitch), static_cast<std::streamsize>(row_bytes));
+    }
+    return stream.good();
+}
+
+} // namespace juce
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace juce
+{
+
+/**
+ * 캡처 이미지 파일 쓰기 (워커 스레드에서 호출 가능)
+ * - PNG: 8-bit RGB / RGBA, 행마다 filter 선택 + fixed Huffman deflate (외부 라이브러리 없음)
+ * - raw: 픽셀을 변환 없이 그대로 (행 사이 패딩 제거)
+ */
+
+// pixels: 행마다 row_pitch 바이트, channels는 3 (RGB) 또는 4 (RGBA)
+bool write_png(const std::string& path, uint32_t width, uint32_t height, uint32_t channels, const uint8_t* pixels, size_t row_pitch);
+
+// row_bytes: 한 행의 실제 픽셀 바이트 (row_pitch 이하)
+bool write_raw(const std::string& path, uint32_t height, const uint8_t* pixels, size_t row_bytes, size_t row_pitch);
+
+} // namespace juce
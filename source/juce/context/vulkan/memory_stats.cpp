@@ -0,0 +1,323 @@
+// memory_stats는 "device memory를 얼마나 쓰고 있고 얼마나 더 써도 되는가"를 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "memory_stats.h"
+
+#include <algorithm>
+
+namespace juce
+{
+
+// Without VK_EXT_memory_budget, WDDM typically starts evicting well before a heap is full
+static const double FALLBACK_BUDGET_RATIO = 0.8;
+
+static double to_mib(VkDeviceSize bytes)
+{
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+const char* get_memory_category_name(memory_category category)
+{
+    switch (category)
+    {
+    case memory_category::texture:
+        return "texture";
+    case memory_category::buffer:
+        return "buffer";
+    case memory_category::attachment:
+        return "attachment";
+    case memory_category::staging:
+        return "staging";
+    default:
+        return "unknown";
+    }
+}
+
+const char* get_memory_pressure_name(memory_pressure pressure)
+{
+    switch (pressure)
+    {
+    case memory_pressure::warning:
+        return "warning";
+    case memory_pressure::critical:
+        return "critical";
+    case memory_pressure::normal:
+    default:
+        return "normal";
+    }
+}
+
+memory_stats::memory_stats()
+    : m_physical_device(VK_NULL_HANDLE), m_device(VK_NULL_HANDLE), m_budget_extension(false), m_category_bytes{}, m_category_counts{}, m_dirty(false), m_next_callback_id(0)
+{
+}
+
+memory_stats::~memory_stats()
+{
+    cleanup();
+}
+
+void memory_stats::initialize(VkPhysicalDevice physical_device, VkDevice device, bool budget_extension, const config& cfg)
+{
+    m_physical_device = physical_device;
+    m_device = device;
+    m_budget_extension = budget_extension;
+    m_config = cfg;
+
+    VkPhysicalDeviceMemoryProperties properties;
+    vkGetPhysicalDeviceMemoryProperties(m_physical_device, &properties);
+
+    m_type_to_heap.resize(properties.memoryTypeCount);
+    for (uint32_t i = 0; i < properties.memoryTypeCount; i++)
+    {
+        m_type_to_heap[i] = properties.memoryTypes[i].heapIndex;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_heap_bytes.assign(properties.memoryHeapCount, 0);
+        m_heap_counts.assign(properties.memoryHeapCount, 0);
+    }
+
+    m_heaps.assign(properties.memoryHeapCount, memory_heap_stats{});
+    for (uint32_t i = 0; i < properties.memoryHeapCount; i++)
+    {
+        m_heaps[i].size = properties.memoryHeaps[i].size;
+        m_heaps[i].device_local = (properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+
+    refresh();
+    log_info("Memory budget: %s", m_budget_extension ? "VK_EXT_memory_budget" : "estimated (80% of heap size)");
+}
+
+void memory_stats::cleanup()
+{
+    if (m_device == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_allocations.empty())
+    {
+        log_warn("memory_stats: %zu device memory allocations were never freed", m_allocations.size());
+    }
+    m_allocations.clear();
+    m_device = VK_NULL_HANDLE;
+}
+
+VkResult memory_stats::allocate(const VkMemoryAllocateInfo& info, memory_category category, VkDeviceMemory* memory)
+{
+    VkResult result = vkAllocateMemory(m_device, &info, nullptr, memory);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dirty = true;
+    if (result != VK_SUCCESS)
+        return result;
+
+    uint32_t heap = info.memoryTypeIndex < m_type_to_heap.size() ? m_type_to_heap[info.memoryTypeIndex] : 0;
+    m_allocations[(uint64_t)*memory] = {info.allocationSize, heap, category};
+    m_heap_bytes[heap] += info.allocationSize;
+    m_heap_counts[heap]++;
+    m_category_bytes[static_cast<uint32_t>(category)] += info.allocationSize;
+    m_category_counts[static_cast<uint32_t>(category)]++;
+    return result;
+}
+
+void memory_stats::free(VkDeviceMemory memory)
+{
+    if (memory == VK_NULL_HANDLE)
+        return;
+
+    vkFreeMemory(m_device, memory, nullptr);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_allocations.find((uint64_t)memory);
+    if (it == m_allocations.end())
+        return;
+
+    const allocation& a = it->second;
+    m_heap_bytes[a.heap] -= a.size;
+    m_heap_counts[a.heap]--;
+    m_category_bytes[static_cast<uint32_t>(a.category)] -= a.size;
+    m_category_counts[static_cast<uint32_t>(a.category)]--;
+    m_allocations.erase(it);
+    m_dirty = true;
+}
+
+void memory_stats::update()
+{
+    if (m_device == VK_NULL_HANDLE)
+        return;
+
+    bool dirty;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        dirty = m_dirty;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (!dirty && now - m_last_poll < std::chrono::milliseconds(m_config.poll_interval_ms))
+        return;
+
+    refresh();
+}
+
+void memory_stats::refresh()
+{
+    m_last_poll = std::chrono::steady_clock::now();
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    if (m_budget_extension)
+    {
+        VkPhysicalDeviceMemoryProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        properties.pNext = &budget;
+        vkGetPhysicalDeviceMemoryProperties2(m_physical_device, &properties);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dirty = false;
+        for (uint32_t i = 0; i < m_heaps.size(); i++)
+        {
+            memory_heap_stats& heap = m_heaps[i];
+            heap.engine_bytes = m_heap_bytes[i];
+            heap.allocation_count = m_heap_counts[i];
+            if (m_budget_extension)
+            {
+                // The budget already accounts for other processes; usage also covers driver-internal allocations
+                heap.budget = std::min(budget.heapBudget[i], heap.size);
+                heap.usage = budget.heapUsage[i];
+            }
+            else
+            {
+                heap.budget = static_cast<VkDeviceSize>(static_cast<double>(heap.size) * FALLBACK_BUDGET_RATIO);
+                heap.usage = heap.engine_bytes;
+            }
+        }
+    }
+
+    // Callbacks run without the lock so they can allocate or free in response
+    for (uint32_t i = 0; i < m_heaps.size(); i++)
+    {
+        memory_heap_stats& heap = m_heaps[i];
+        memory_pressure pressure = evaluate(heap);
+        if (pressure == heap.pressure)
+            continue;
+
+        memory_pressure previous = heap.pressure;
+        heap.pressure = pressure;
+        if (pressure > previous)
+        {
+            log_warn("Memory heap %u%s at %.0f%% of budget (%.1f / %.1f MiB): %s",
+                     i, heap.device_local ? " (device local)" : "", 100.0 * heap.usage / std::max<VkDeviceSize>(heap.budget, 1),
+                     to_mib(heap.usage), to_mib(heap.budget), get_memory_pressure_name(pressure));
+        }
+        else
+        {
+            log_info("Memory heap %u back to %s", i, get_memory_pressure_name(pressure));
+        }
+
+        // A copy, so callbacks may remove themselves
+        std::vector<std::pair<uint32_t, memory_pressure_callback>> callbacks = m_callbacks;
+        for (const auto& [id, callback] : callbacks)
+        {
+            callback(i, heap);
+        }
+    }
+}
+
+memory_pressure memory_stats::evaluate(const memory_heap_stats& heap) const
+{
+    if (heap.budget == 0)
+        return memory_pressure::normal;
+
+    double ratio = static_cast<double>(heap.usage) / static_cast<double>(heap.budget);
+
+    // Dropping a level needs the ratio to clear the threshold by the hysteresis margin
+    double warning = m_config.warning_ratio;
+    double critical = m_config.critical_ratio;
+    if (heap.pressure >= memory_pressure::warning)
+        warning -= m_config.hysteresis;
+    if (heap.pressure >= memory_pressure::critical)
+        critical -= m_config.hysteresis;
+
+    if (ratio >= critical)
+        return memory_pressure::critical;
+    if (ratio >= warning)
+        return memory_pressure::warning;
+    return memory_pressure::normal;
+}
+
+uint32_t memory_stats::get_heap_count() const
+{
+    return static_cast<uint32_t>(m_heaps.size());
+}
+
+const memory_heap_stats& memory_stats::get_heap(uint32_t heap) const
+{
+    return m_heaps[heap];
+}
+
+VkDeviceSize memory_stats::get_device_local_headroom() const
+{
+    VkDeviceSize headroom = UINT64_MAX;
+    for (const memory_heap_stats& heap : m_heaps)
+    {
+        if (!heap.device_local)
+            continue;
+        headroom = std::min(headroom, heap.budget > heap.usage ? heap.budget - heap.usage : 0);
+    }
+    return headroom == UINT64_MAX ? 0 : headroom;
+}
+
+VkDeviceSize memory_stats::get_category_bytes(memory_category category) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_category_bytes[static_cast<uint32_t>(category)];
+}
+
+uint32_t memory_stats::get_category_count(memory_category category) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_category_counts[static_cast<uint32_t>(category)];
+}
+
+bool memory_stats::has_budget_extension() const
+{
+    return m_budget_extension;
+}
+
+uint32_t memory_stats::add_pressure_callback(memory_pressure_callback callback)
+{
+    uint32_t id = m_next_callback_id++;
+    m_callbacks.emplace_back(id, std::move(callback));
+    return id;
+}
+
+void memory_stats::remove_pressure_callback(uint32_t id)
+{
+    m_callbacks.erase(std::remove_if(m_callbacks.begin(), m_callbacks.end(), [id](const auto& entry)
+                                     { return entry.first == id; }),
+                      m_callbacks.end());
+}
+
+void memory_stats::log_report() const
+{
+    for (uint32_t i = 0; i < m_heaps.size(); i++)
+    {
+        const memory_heap_stats& heap = m_heaps[i];
+        log_info("Memory heap %u%s: %.1f / %.1f MiB budget (%.1f MiB heap), engine %.1f MiB in %u allocations, %s",
+                 i, heap.device_local ? " (device local)" : "", to_mib(heap.usage), to_mib(heap.budget), to_mib(heap.size),
+                 to_mib(heap.engine_bytes), heap.allocation_count, get_memory_pressure_name(heap.pressure));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (uint32_t i = 0; i < static_cast<uint32_t>(memory_category::count); i++)
+    {
+        log_info("  %-10s %8.1f MiB in %u allocations", get_memory_category_name(static_cast<memory_category>(i)), to_mib(m_category_bytes[i]), m_category_counts[i]);
+    }
+}
+
+} // namespace juce
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+
+namespace juce
+{
+
+// 엔진이 직접 할당한 device memory의 용도
+enum class memory_category : uint32_t
+{
+    texture,    // 샘플링 / storage 이미지
+    buffer,     // vertex, uniform, storage, indirect...
+    attachment, // color / depth render target
+    staging,    // CPU -> GPU 업로드용
+    count,
+};
+
+const char* get_memory_category_name(memory_category category);
+
+// heap 사용량 / budget 비율 단계
+enum class memory_pressure
+{
+    normal,
+    warning,  // warning_ratio 이상: 캐시 축소 등 대응 시작
+    critical, // critical_ratio 이상: 곧 페이징, 적극적으로 해제
+};
+
+const char* get_memory_pressure_name(memory_pressure pressure);
+
+struct memory_heap_stats
+{
+    VkDeviceSize size = 0;
+    VkDeviceSize budget = 0;       // 이 프로세스가 쓸 수 있는 양 (확장 없으면 size의 80%)
+    VkDeviceSize usage = 0;        // 이 프로세스 전체 사용량 (확장 없으면 엔진 할당량)
+    VkDeviceSize engine_bytes = 0; // 엔진이 memory_stats를 통해 할당한 양
+    uint32_t allocation_count = 0;
+    bool device_local = false;
+    memory_pressure pressure = memory_pressure::normal;
+};
+
+// heap의 압박 단계가 바뀔 때 호출 (메인 스레드, update 중)
+using memory_pressure_callback = std::function<void(uint32_t heap, const memory_heap_stats& stats)>;
+
+/**
+ * memory stats
+ * - 관리: heap별 budget / 사용량 (VK_EXT_memory_budget), 용도별 엔진 할당량, 압박 단계 callback
+ * - 엔진의 device memory 할당 / 해제는 모두 allocate / free를 거침 (deletion queue 포함)
+ * - budget은 update에서 poll 간격마다, 할당이 있었으면 다음 update에서 바로 갱신
+ * - 단계가 내려갈 때는 임계값보다 hysteresis만큼 더 내려가야 함 (경계에서 callback이 반복되지 않도록)
+ */
+class memory_stats
+{
+public:
+    struct config
+    {
+        float warning_ratio = 0.85f;
+        float critical_ratio = 0.95f;
+        float hysteresis = 0.05f;
+        uint32_t poll_interval_ms = 250;
+    };
+
+    memory_stats();
+    ~memory_stats();
+
+    // budget_extension: VK_EXT_memory_budget이 활성화된 device인지
+    void initialize(VkPhysicalDevice physical_device, VkDevice device, bool budget_extension, const config& cfg);
+    // 아직 해제되지 않은 할당이 있으면 경고 (device 파괴 직전)
+    void cleanup();
+
+    // vkAllocateMemory / vkFreeMemory + 용도별 집계 (어느 스레드에서든)
+    VkResult allocate(const VkMemoryAllocateInfo& info, memory_category category, VkDeviceMemory* memory);
+    void free(VkDeviceMemory memory);
+
+    // 프레임 경계에서 호출 (메인 스레드): budget 갱신, 단계가 바뀐 heap마다 callback
+    void update();
+    // poll 간격을 무시하고 지금 갱신
+    void refresh();
+
+    uint32_t get_heap_count() const;
+    const memory_heap_stats& get_heap(uint32_t heap) const;
+    // device-local heap 중 남은 budget이 가장 적은 값 (budget - usage, 넘었으면 0)
+    VkDeviceSize get_device_local_headroom() const;
+
+    VkDeviceSize get_category_bytes(memory_category category) const;
+    uint32_t get_category_count(memory_category category) const;
+
+    bool has_budget_extension() const;
+
+    // callback id 반환 (remove에 사용)
+    uint32_t add_pressure_callback(memory_pressure_callback callback);
+    void remove_pressure_callback(uint32_t id);
+
+    // heap / 용도별 현황을 로그로 출력
+    void log_report() const;
+
+private:
+    struct allocation
+    {
+        VkDeviceSize size;
+        uint32_t heap;
+        memory_category category;
+    };
+
+    memory_pressure evaluate(const memory_heap_stats& heap) const;
+
+    VkPhysicalDevice m_physical_device;
+    VkDevice m_device;
+    bool m_budget_extension;
+    config m_config;
+    std::vector<uint32_t> m_type_to_heap;
+
+    // allocate / free와 공유
+    mutable std::mutex m_mutex;
+    std::unordered_map<uint64_t, allocation> m_allocations; // VkDeviceMemory -> 할당 정보
+    std::vector<VkDeviceSize> m_heap_bytes;
+    std::vector<uint32_t> m_heap_counts;
+    VkDeviceSize m_category_bytes[static_cast<uint32_t>(memory_category::count)];
+    uint32_t m_category_counts[static_cast<uint32_t>(memory_category::count)];
+    bool m_dirty;
+
+    // 메인 스레드 전용
+    std::vector<memory_heap_stats> m_heaps;
+    std::chrono::steady_clock::time_point m_last_poll;
+    std::vector<std::pair<uint32_t, memory_pressure_callback>> m_callbacks;
+    uint32_t m_next_callback_id;
+};
+
+} // namespace juce
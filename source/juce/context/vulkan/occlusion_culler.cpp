@@ -0,0 +1,695 @@
+// occlusion_culler는 "이번 프레임에 어떤 오브젝트를 그릴지"를 GPU에서 판정하는 것을 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "occlusion_culler.h"
+#include "vk_context.h"
+#include "deletion_queue.h"
+#include "shader_module.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace juce
+{
+
+// hiz_cull.comp push constant (std430: mat4, vec2, uint x3)
+struct cull_params
+{
+    float view_proj[16];
+    float pyramid_size[2];
+    uint32_t object_count;
+    uint32_t phase;
+    uint32_t occlusion;
+};
+
+// hiz_reduce.comp push constant
+struct reduce_params
+{
+    int32_t src_size[2];
+    int32_t dst_size[2];
+};
+
+static VkImageAspectFlags depth_aspect_of(VkFormat format)
+{
+    bool stencil = format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
+    return VK_IMAGE_ASPECT_DEPTH_BIT | (stencil ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
+}
+
+occlusion_culler::occlusion_culler()
+    : m_context(nullptr), m_object_count(0), m_visibility_reset(false), m_depth_image(VK_NULL_HANDLE), m_depth_view(VK_NULL_HANDLE), m_depth_format(VK_FORMAT_UNDEFINED), m_depth_extent{0, 0}, m_depth_sampleable(false), m_pyramid_initialized(false), m_sampler(VK_NULL_HANDLE), m_cull_set_layout(VK_NULL_HANDLE), m_reduce_set_layout(VK_NULL_HANDLE), m_cull_layout(VK_NULL_HANDLE), m_reduce_layout(VK_NULL_HANDLE), m_cull_pipeline(VK_NULL_HANDLE), m_reduce_pipeline(VK_NULL_HANDLE), m_descriptor_pool(VK_NULL_HANDLE), m_cull_sets{VK_NULL_HANDLE, VK_NULL_HANDLE}, m_descriptors_dirty(true)
+{
+}
+
+occlusion_culler::~occlusion_culler()
+{
+    cleanup();
+}
+
+bool occlusion_culler::initialize(vk_context* context)
+{
+    if (!context)
+    {
+        log_error("Invalid arguments provided to occlusion_culler::initialize");
+        return false;
+    }
+
+    m_context = context;
+
+    try
+    {
+        create_pipelines();
+    }
+    catch (const std::exception& e)
+    {
+        log_error("Failed to initialize occlusion culler: %s", e.what());
+        cleanup();
+        return false;
+    }
+    return true;
+}
+
+void occlusion_culler::cleanup()
+{
+    if (!m_context)
+        return;
+
+    VkDevice device = m_context->get_device();
+    resource_pool* resources = m_context->get_resources();
+
+    release_pyramid();
+    resources->release(m_sphere_buffer);
+    resources->release(m_template_buffer);
+    resources->release(m_draw_buffers[0]);
+    resources->release(m_draw_buffers[1]);
+    resources->release(m_visibility_buffer);
+    m_object_count = 0;
+
+    vkDestroyDescriptorPool(device, m_descriptor_pool, nullptr);
+    vkDestroyPipeline(device, m_cull_pipeline, nullptr);
+    vkDestroyPipeline(device, m_reduce_pipeline, nullptr);
+    vkDestroyPipelineLayout(device, m_cull_layout, nullptr);
+    vkDestroyPipelineLayout(device, m_reduce_layout, nullptr);
+    vkDestroyDescriptorSetLayout(device, m_cull_set_layout, nullptr);
+    vkDestroyDescriptorSetLayout(device, m_reduce_set_layout, nullptr);
+    vkDestroySampler(device, m_sampler, nullptr);
+    m_descriptor_pool = VK_NULL_HANDLE;
+    m_cull_sets[0] = VK_NULL_HANDLE;
+    m_cull_sets[1] = VK_NULL_HANDLE;
+    m_reduce_sets.clear();
+    m_cull_pipeline = VK_NULL_HANDLE;
+    m_reduce_pipeline = VK_NULL_HANDLE;
+    m_cull_layout = VK_NULL_HANDLE;
+    m_reduce_layout = VK_NULL_HANDLE;
+    m_cull_set_layout = VK_NULL_HANDLE;
+    m_reduce_set_layout = VK_NULL_HANDLE;
+    m_sampler = VK_NULL_HANDLE;
+    m_depth_image = VK_NULL_HANDLE;
+    m_depth_view = VK_NULL_HANDLE;
+    m_descriptors_dirty = true;
+
+    m_context = nullptr;
+}
+
+void occlusion_culler::create_pipelines()
+{
+    VkDevice device = m_context->get_device();
+
+    // Point sampling only: every reduction and test takes the min of explicit texel fetches
+    VkSamplerCreateInfo sampler_info{};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_NEAREST;
+    sampler_info.minFilter = VK_FILTER_NEAREST;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(device, &sampler_info, nullptr, &m_sampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create depth pyramid sampler!");
+    }
+
+    // hiz_cull.comp: spheres, templates, draws, visibility, pyramid
+    VkDescriptorSetLayoutBinding cull_bindings[5]{};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        cull_bindings[i].binding = i;
+        cull_bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        cull_bindings[i].descriptorCount = 1;
+        cull_bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    cull_bindings[4].binding = 4;
+    cull_bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    cull_bindings[4].descriptorCount = 1;
+    cull_bindings[4].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    // hiz_reduce.comp: previous level (or depth), next level
+    VkDescriptorSetLayoutBinding reduce_bindings[2]{};
+    reduce_bindings[0].binding = 0;
+    reduce_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    reduce_bindings[0].descriptorCount = 1;
+    reduce_bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    reduce_bindings[1].binding = 1;
+    reduce_bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    reduce_bindings[1].descriptorCount = 1;
+    reduce_bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = 5;
+    layout_info.pBindings = cull_bindings;
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr, &m_cull_set_layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create cull descriptor set layout!");
+    }
+
+    layout_info.bindingCount = 2;
+    layout_info.pBindings = reduce_bindings;
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr, &m_reduce_set_layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create reduce descriptor set layout!");
+    }
+
+    VkPushConstantRange push_range{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(cull_params)};
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &m_cull_set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_range;
+    if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &m_cull_layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create cull pipeline layout!");
+    }
+
+    push_range.size = sizeof(reduce_params);
+    pipeline_layout_info.pSetLayouts = &m_reduce_set_layout;
+    if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &m_reduce_layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create reduce pipeline layout!");
+    }
+
+    VkShaderModule cull_module = load_shader_module(device, "shaders/hiz_cull.comp.spv");
+    VkShaderModule reduce_module = VK_NULL_HANDLE;
+    try
+    {
+        reduce_module = load_shader_module(device, "shaders/hiz_reduce.comp.spv");
+    }
+    catch (const std::exception&)
+    {
+        vkDestroyShaderModule(device, cull_module, nullptr);
+        throw;
+    }
+
+    VkComputePipelineCreateInfo pipeline_infos[2]{};
+    for (VkComputePipelineCreateInfo& info : pipeline_infos)
+    {
+        info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        info.stage.pName = "main";
+    }
+    pipeline_infos[0].stage.module = cull_module;
+    pipeline_infos[0].layout = m_cull_layout;
+    pipeline_infos[1].stage.module = reduce_module;
+    pipeline_infos[1].layout = m_reduce_layout;
+
+    VkPipeline pipelines[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VkResult result = vkCreateComputePipelines(device, m_context->get_pipeline_cache(), 2, pipeline_infos, nullptr, pipelines);
+    m_cull_pipeline = pipelines[0];
+    m_reduce_pipeline = pipelines[1];
+
+    vkDestroyShaderModule(device, reduce_module, nullptr);
+    vkDestroyShaderModule(device, cull_module, nullptr);
+
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create culling compute pipelines!");
+    }
+}
+
+bool occlusion_culler::set_objects(const cull_object* objects, uint32_t count)
+{
+    resource_pool* resources = m_context->get_resources();
+
+    // Frames in flight keep reading the old buffers until the deletion queue retires them
+    resources->release(m_sphere_buffer);
+    resources->release(m_template_buffer);
+    resources->release(m_draw_buffers[0]);
+    resources->release(m_draw_buffers[1]);
+    resources->release(m_visibility_buffer);
+    m_object_count = 0;
+    m_descriptors_dirty = true;
+
+    if (count == 0)
+        return true;
+
+    const VkMemoryPropertyFlags host_memory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    const VkDeviceSize command_bytes = sizeof(VkDrawIndirectCommand) * count;
+
+    m_sphere_buffer = resources->create_buffer(sizeof(float) * 4 * count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, host_memory);
+    m_template_buffer = resources->create_buffer(command_bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, host_memory);
+    m_draw_buffers[0] = resources->create_buffer(command_bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_draw_buffers[1] = resources->create_buffer(command_bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_visibility_buffer = resources->create_buffer(sizeof(uint32_t) * count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    const gpu_buffer* spheres = resources->get(m_sphere_buffer);
+    const gpu_buffer* templates = resources->get(m_template_buffer);
+    if (!spheres || !templates || !resources->get(m_draw_buffers[0]) || !resources->get(m_draw_buffers[1]) || !resources->get(m_visibility_buffer))
+    {
+        log_error("Failed to create culling buffers for %u objects", count);
+        set_objects(nullptr, 0);
+        return false;
+    }
+
+    // Without drawIndirectFirstInstance the shaders cannot look up per-object data by instance index
+    bool first_instance = m_context->get_enabled_features().drawIndirectFirstInstance == VK_TRUE;
+
+    float* sphere_data = static_cast<float*>(spheres->mapped);
+    VkDrawIndirectCommand* commands = static_cast<VkDrawIndirectCommand*>(templates->mapped);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        std::memcpy(sphere_data + i * 4, objects[i].center, sizeof(float) * 3);
+        sphere_data[i * 4 + 3] = objects[i].radius;
+
+        commands[i].vertexCount = objects[i].vertex_count;
+        commands[i].instanceCount = 1;
+        commands[i].firstVertex = objects[i].first_vertex;
+        commands[i].firstInstance = first_instance ? i : 0;
+    }
+
+    m_object_count = count;
+    m_visibility_reset = true;
+    return true;
+}
+
+uint32_t occlusion_culler::get_object_count() const
+{
+    return m_object_count;
+}
+
+void occlusion_culler::set_depth_source(VkImage depth_image, VkImageView depth_view, VkFormat depth_format, VkExtent2D extent, bool sampleable)
+{
+    if (depth_image == m_depth_image && depth_view == m_depth_view && extent.width == m_depth_extent.width &&
+        extent.height == m_depth_extent.height && sampleable == m_depth_sampleable && m_pyramid.is_valid())
+        return;
+
+    m_depth_image = depth_image;
+    m_depth_view = depth_view;
+    m_depth_format = depth_format;
+    m_depth_extent = extent;
+    m_depth_sampleable = sampleable && depth_view != VK_NULL_HANDLE;
+
+    release_pyramid();
+    create_pyramid();
+    m_descriptors_dirty = true;
+}
+
+bool occlusion_culler::has_pyramid() const
+{
+    return m_depth_sampleable && m_pyramid.is_valid();
+}
+
+VkBuffer occlusion_culler::get_draw_buffer(phase p) const
+{
+    const gpu_buffer* buffer = m_context->get_resources()->get(m_draw_buffers[static_cast<uint32_t>(p)]);
+    return buffer ? buffer->buffer : VK_NULL_HANDLE;
+}
+
+void occlusion_culler::create_pyramid()
+{
+    // Level 0 is half the depth resolution; each level halves again down to 1x1.
+    // Without a sampleable depth a 1x1 placeholder keeps the cull descriptor valid.
+    uint32_t width = m_depth_sampleable ? std::max(1u, m_depth_extent.width / 2) : 1;
+    uint32_t height = m_depth_sampleable ? std::max(1u, m_depth_extent.height / 2) : 1;
+    uint32_t levels = 1;
+    while ((std::max(width, height) >> levels) > 0)
+    {
+        levels++;
+    }
+
+    VkImageCreateInfo image_info{};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.extent = {width, height, 1};
+    image_info.mipLevels = levels;
+    image_info.arrayLayers = 1;
+    image_info.format = VK_FORMAT_R32_SFLOAT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    m_pyramid = m_context->get_resources()->create_image(image_info, VK_IMAGE_ASPECT_COLOR_BIT);
+    const gpu_image* pyramid = m_context->get_resources()->get(m_pyramid);
+    if (!pyramid)
+    {
+        log_error("Failed to create depth pyramid (%ux%u)", width, height);
+        m_depth_sampleable = false;
+        return;
+    }
+    m_pyramid_initialized = false;
+
+    // One view per level: each reduction reads level i - 1 and writes level i
+    for (uint32_t level = 0; level < levels; level++)
+    {
+        VkImageViewCreateInfo view_info{};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.image = pyramid->image;
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = VK_FORMAT_R32_SFLOAT;
+        view_info.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+
+        VkImageView view;
+        if (vkCreateImageView(m_context->get_device(), &view_info, nullptr, &view) != VK_SUCCESS)
+        {
+            log_error("Failed to create depth pyramid view for level %u", level);
+            release_pyramid();
+            m_depth_sampleable = false;
+            return;
+        }
+        m_level_views.push_back(view);
+    }
+
+    if (m_depth_sampleable)
+    {
+        log_debug("Depth pyramid: %ux%u, %u levels", width, height, levels);
+    }
+}
+
+void occlusion_culler::release_pyramid()
+{
+    deletion_queue* queue = m_context->get_deletion_queue();
+    for (VkImageView view : m_level_views)
+    {
+        queue->destroy_image_view(view);
+    }
+    m_level_views.clear();
+    m_context->get_resources()->release(m_pyramid);
+    m_pyramid = image_handle{};
+}
+
+void occlusion_culler::update_descriptors()
+{
+    m_descriptors_dirty = false;
+
+    if (!m_pyramid.is_valid())
+    {
+        create_pyramid();
+    }
+    const gpu_image* pyramid = m_context->get_resources()->get(m_pyramid);
+    if (!pyramid)
+    {
+        throw std::runtime_error("no depth pyramid to bind!");
+    }
+
+    // Sets are rewritten only when objects or the pyramid change, so the whole pool is replaced
+    VkDevice device = m_context->get_device();
+    m_context->get_deletion_queue()->destroy_descriptor_pool(m_descriptor_pool);
+    m_descriptor_pool = VK_NULL_HANDLE;
+    m_cull_sets[0] = VK_NULL_HANDLE;
+    m_cull_sets[1] = VK_NULL_HANDLE;
+    m_reduce_sets.clear();
+
+    uint32_t levels = has_pyramid() ? static_cast<uint32_t>(m_level_views.size()) : 0;
+
+    VkDescriptorPoolSize pool_sizes[] = {
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 8},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 + levels},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, std::max(1u, levels)},
+    };
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = 2 + levels;
+    pool_info.poolSizeCount = 3;
+    pool_info.pPoolSizes = pool_sizes;
+
+    if (vkCreateDescriptorPool(device, &pool_info, nullptr, &m_descriptor_pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create culling descriptor pool!");
+    }
+
+    // One cull set per phase (they differ only in the draw buffer), then one reduce set per level
+    std::vector<VkDescriptorSetLayout> layouts(2 + levels, m_reduce_set_layout);
+    layouts[0] = m_cull_set_layout;
+    layouts[1] = m_cull_set_layout;
+    std::vector<VkDescriptorSet> sets(layouts.size());
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = m_descriptor_pool;
+    alloc_info.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+    alloc_info.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(device, &alloc_info, sets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate culling descriptor sets!");
+    }
+    m_cull_sets[0] = sets[0];
+    m_cull_sets[1] = sets[1];
+    m_reduce_sets.assign(sets.begin() + 2, sets.end());
+
+    std::vector<VkWriteDescriptorSet> writes;
+    std::vector<VkDescriptorBufferInfo> buffer_infos(8);
+    std::vector<VkDescriptorImageInfo> image_infos(1 + levels * 2);
+    image_infos[0] = {m_sampler, pyramid->view, VK_IMAGE_LAYOUT_GENERAL};
+
+    resource_pool* resources = m_context->get_resources();
+    for (uint32_t p = 0; p < 2; p++)
+    {
+        if (m_object_count > 0)
+        {
+            buffer_handle buffers[] = {m_sphere_buffer, m_template_buffer, m_draw_buffers[p], m_visibility_buffer};
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                VkDescriptorBufferInfo& info = buffer_infos[p * 4 + i];
+                info = {resources->get(buffers[i])->buffer, 0, VK_WHOLE_SIZE};
+
+                VkWriteDescriptorSet write{};
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.dstSet = m_cull_sets[p];
+                write.dstBinding = i;
+                write.descriptorCount = 1;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                write.pBufferInfo = &info;
+                writes.push_back(write);
+            }
+        }
+
+        VkWriteDescriptorSet pyramid_write{};
+        pyramid_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        pyramid_write.dstSet = m_cull_sets[p];
+        pyramid_write.dstBinding = 4;
+        pyramid_write.descriptorCount = 1;
+        pyramid_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        pyramid_write.pImageInfo = &image_infos[0];
+        writes.push_back(pyramid_write);
+    }
+
+    for (uint32_t level = 0; level < levels; level++)
+    {
+        VkDescriptorImageInfo& src = image_infos[1 + level * 2];
+        VkDescriptorImageInfo& dst = image_infos[2 + level * 2];
+        if (level == 0)
+        {
+            src = {m_sampler, m_depth_view, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+        }
+        else
+        {
+            src = {m_sampler, m_level_views[level - 1], VK_IMAGE_LAYOUT_GENERAL};
+        }
+        dst = {VK_NULL_HANDLE, m_level_views[level], VK_IMAGE_LAYOUT_GENERAL};
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = m_reduce_sets[level];
+        write.descriptorCount = 1;
+
+        write.dstBinding = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &src;
+        writes.push_back(write);
+
+        write.dstBinding = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        write.pImageInfo = &dst;
+        writes.push_back(write);
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void occlusion_culler::cull(VkCommandBuffer command_buffer, phase p, const float view_proj[16])
+{
+    if (m_object_count == 0)
+        return;
+    if (m_descriptors_dirty)
+    {
+        update_descriptors();
+    }
+
+    // The buffers are shared by all frames in flight: wait for earlier indirect reads and
+    // make the previous late phase's visibility writes visible
+    VkMemoryBarrier memory_barrier{};
+    memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memory_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    VkImageMemoryBarrier pyramid_barrier{};
+    uint32_t image_barrier_count = 0;
+    if (!m_pyramid_initialized)
+    {
+        // The cull shader always binds the pyramid, even when it is never built (MSAA)
+        pyramid_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        pyramid_barrier.srcAccessMask = 0;
+        pyramid_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        pyramid_barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        pyramid_barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        pyramid_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        pyramid_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        pyramid_barrier.image = m_context->get_resources()->get(m_pyramid)->image;
+        pyramid_barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1};
+        image_barrier_count = 1;
+        m_pyramid_initialized = true;
+    }
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &memory_barrier, 0, nullptr, image_barrier_count, &pyramid_barrier);
+
+    resource_pool* resources = m_context->get_resources();
+    if (m_visibility_reset)
+    {
+        // Nothing was visible last frame: the early phase draws nothing, the late phase tests everything
+        vkCmdFillBuffer(command_buffer, resources->get(m_visibility_buffer)->buffer, 0, VK_WHOLE_SIZE, 0);
+        m_visibility_reset = false;
+
+        memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memory_barrier, 0, nullptr, 0, nullptr);
+    }
+
+    cull_params params{};
+    std::memcpy(params.view_proj, view_proj, sizeof(params.view_proj));
+    const gpu_image* pyramid = resources->get(m_pyramid);
+    params.pyramid_size[0] = static_cast<float>(pyramid->extent.width);
+    params.pyramid_size[1] = static_cast<float>(pyramid->extent.height);
+    params.object_count = m_object_count;
+    params.phase = static_cast<uint32_t>(p);
+    params.occlusion = has_pyramid() ? 1 : 0;
+
+    // Each phase writes its own draw buffer through its own set
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cull_pipeline);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cull_layout, 0, 1, &m_cull_sets[params.phase], 0, nullptr);
+    vkCmdPushConstants(command_buffer, m_cull_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdDispatch(command_buffer, (m_object_count + 63) / 64, 1, 1);
+
+    // Draw commands are consumed by the following pass
+    VkBufferMemoryBarrier draw_barrier{};
+    draw_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    draw_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    draw_barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    draw_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    draw_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    draw_barrier.buffer = get_draw_buffer(p);
+    draw_barrier.offset = 0;
+    draw_barrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 0, nullptr, 1, &draw_barrier, 0, nullptr);
+}
+
+void occlusion_culler::build_pyramid(VkCommandBuffer command_buffer, VkImageLayout depth_layout)
+{
+    if (!has_pyramid() || m_descriptors_dirty)
+        return;
+
+    const gpu_image* pyramid = m_context->get_resources()->get(m_pyramid);
+
+    // depth: attachment writes -> compute reads; pyramid: the previous frame's late phase reads -> rewrite
+    VkImageMemoryBarrier barriers[2]{};
+    barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barriers[0].oldLayout = depth_layout;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[0].image = m_depth_image;
+    barriers[0].subresourceRange = {depth_aspect_of(m_depth_format), 0, 1, 0, 1};
+
+    barriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barriers[1].srcAccessMask = 0;
+    barriers[1].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED; // fully rewritten
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barriers[1].image = pyramid->image;
+    barriers[1].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1};
+
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 0, nullptr, 0, nullptr, 2, barriers);
+    m_pyramid_initialized = true;
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_reduce_pipeline);
+
+    uint32_t src_width = m_depth_extent.width;
+    uint32_t src_height = m_depth_extent.height;
+    for (uint32_t level = 0; level < m_reduce_sets.size(); level++)
+    {
+        uint32_t dst_width = std::max(1u, pyramid->extent.width >> level);
+        uint32_t dst_height = std::max(1u, pyramid->extent.height >> level);
+
+        reduce_params params{};
+        params.src_size[0] = static_cast<int32_t>(src_width);
+        params.src_size[1] = static_cast<int32_t>(src_height);
+        params.dst_size[0] = static_cast<int32_t>(dst_width);
+        params.dst_size[1] = static_cast<int32_t>(dst_height);
+
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_reduce_layout, 0, 1, &m_reduce_sets[level], 0, nullptr);
+        vkCmdPushConstants(command_buffer, m_reduce_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+        vkCmdDispatch(command_buffer, (dst_width + 7) / 8, (dst_height + 7) / 8, 1);
+
+        // The next level (or the late cull) reads what this level wrote
+        VkImageMemoryBarrier level_barrier = barriers[1];
+        level_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        level_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        level_barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        level_barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &level_barrier);
+
+        src_width = dst_width;
+        src_height = dst_height;
+    }
+}
+
+void occlusion_culler::draw(VkCommandBuffer command_buffer, phase p) const
+{
+    if (m_object_count == 0)
+        return;
+
+    VkBuffer buffer = get_draw_buffer(p);
+    const uint32_t stride = sizeof(VkDrawIndirectCommand);
+
+    // Culled objects have instanceCount 0 and cost only the command fetch
+    if (m_context->get_enabled_features().multiDrawIndirect)
+    {
+        vkCmdDrawIndirect(command_buffer, buffer, 0, m_object_count, stride);
+        return;
+    }
+    for (uint32_t i = 0; i < m_object_count; i++)
+    {
+        vkCmdDrawIndirect(command_buffer, buffer, static_cast<VkDeviceSize>(i) * stride, 1, stride);
+    }
+}
+
+} // namespace juce
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+#include <juce/context/vulkan/resource_pool.h>
+
+#include <vector>
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+// 컬링 대상 하나: world-space bounding sphere + 그릴 정점 범위
+struct cull_object
+{
+    float center[3];
+    float radius;
+    uint32_t vertex_count;
+    uint32_t first_vertex;
+};
+
+/**
+ * 2단계 Hi-Z occlusion culler
+ * - 관리: depth pyramid (R32F mip chain), 오브젝트 / 가시성 / indirect draw 버퍼, compute 파이프라인
+ * - early: 지난 프레임 가시 집합만 그림 -> 그 depth로 pyramid 생성 (min reduction)
+ *   -> late: 전체를 pyramid로 판정, 새로 보이게 된 것만 그리고 가시성 갱신
+ * - 결과는 오브젝트당 VkDrawIndirectCommand 하나 (컬링되면 instanceCount = 0, firstInstance = 오브젝트 index)
+ * - pyramid를 만들 수 없으면 (MSAA depth 등) frustum 컬링만 수행
+ */
+class occlusion_culler
+{
+public:
+    enum class phase : uint32_t
+    {
+        early = 0,
+        late = 1,
+    };
+
+    occlusion_culler();
+    ~occlusion_culler();
+
+    bool initialize(vk_context* context);
+    void cleanup();
+
+    // 오브젝트 목록 교체 (버퍼 재생성, 가시성 초기화 -> 첫 프레임은 late 단계에서 전부 그림)
+    bool set_objects(const cull_object* objects, uint32_t count);
+    uint32_t get_object_count() const;
+
+    // pyramid 원본 depth 지정, 바뀌었을 때만 pyramid 재생성
+    // - sampleable = false (MSAA, transient depth)면 pyramid 없이 frustum만 판정
+    void set_depth_source(VkImage depth_image, VkImageView depth_view, VkFormat depth_format, VkExtent2D extent, bool sampleable);
+
+    // 컬링 compute 기록 (패스 밖), 끝나면 draw 버퍼는 DRAW_INDIRECT에서 읽을 수 있음
+    // - view_proj: column-major, reverse-Z 투영
+    void cull(VkCommandBuffer command_buffer, phase p, const float view_proj[16]);
+
+    // early 패스 직후 (패스 밖) 기록: depth를 DEPTH_STENCIL_READ_ONLY_OPTIMAL로 전환하고 pyramid 생성
+    // - depth_layout: 현재 depth 레이아웃, late 패스는 READ_ONLY 상태에서 LOAD로 시작해야 함
+    void build_pyramid(VkCommandBuffer command_buffer, VkImageLayout depth_layout);
+
+    // 현재 depth로 pyramid를 만들 수 있는지 (false면 late 단계도 frustum만)
+    bool has_pyramid() const;
+
+    // phase별 indirect draw 버퍼, get_object_count()개의 VkDrawIndirectCommand
+    VkBuffer get_draw_buffer(phase p) const;
+
+    // 기록된 draw 버퍼를 그림 (multiDrawIndirect 없으면 오브젝트마다 indirect draw)
+    void draw(VkCommandBuffer command_buffer, phase p) const;
+
+private:
+    void create_pipelines();
+    void create_pyramid();
+    void release_pyramid();
+    void update_descriptors();
+
+    vk_context* m_context; // 소유하지 않음
+
+    // 오브젝트 데이터 (set_objects마다 재생성, 이전 버퍼는 deletion queue로)
+    buffer_handle m_sphere_buffer;
+    buffer_handle m_template_buffer;
+    buffer_handle m_draw_buffers[2];
+    buffer_handle m_visibility_buffer;
+    uint32_t m_object_count;
+    bool m_visibility_reset;
+
+    // depth pyramid (level 0 = depth의 절반 크기)
+    VkImage m_depth_image;
+    VkImageView m_depth_view;
+    VkFormat m_depth_format;
+    VkExtent2D m_depth_extent;
+    bool m_depth_sampleable;
+    image_handle m_pyramid;
+    std::vector<VkImageView> m_level_views;
+    bool m_pyramid_initialized; // UNDEFINED -> GENERAL 전환 여부
+
+    VkSampler m_sampler;
+    VkDescriptorSetLayout m_cull_set_layout;
+    VkDescriptorSetLayout m_reduce_set_layout;
+    VkPipelineLayout m_cull_layout;
+    VkPipelineLayout m_reduce_layout;
+    VkPipeline m_cull_pipeline;
+    VkPipeline m_reduce_pipeline;
+
+    // 오브젝트나 pyramid가 바뀌면 pool째 교체
+    VkDescriptorPool m_descriptor_pool;
+    VkDescriptorSet m_cull_sets[2];              // phase마다 하나 (draw 버퍼만 다름)
+    std::vector<VkDescriptorSet> m_reduce_sets; // level마다 하나 (src -> dst)
+    bool m_descriptors_dirty;
+};
+
+} // namespace juce
@@ -0,0 +1,654 @@
+// particle_system은 "파티클의 일생 전체를 GPU 안에서 돌리는 것"을 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "particle_system.h"
+#include "vk_context.h"
+#include "deletion_queue.h"
+#include "shader_module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace juce
+{
+
+// particles.glsl particle_params_block (std140)
+struct particle_params
+{
+    float gravity_dt[4];
+    float camera_drag[4];
+    uint32_t counts[4];
+};
+
+// particles.glsl particle_emitter (std430)
+struct gpu_particle_emitter
+{
+    float position_radius[4];
+    float velocity_spread[4];
+    float lifetime_size[4];
+    uint32_t emission[4];
+};
+
+// particles.glsl particle (std430)
+struct gpu_particle
+{
+    float position_age[4];
+    float velocity_lifetime[4];
+    uint32_t appearance[4];
+};
+
+// particles.glsl draw_entry (std430)
+struct gpu_draw_entry
+{
+    float key;
+    uint32_t index;
+};
+
+// particles.glsl particle_counter_buffer (std430), the dispatch / draw members are read as indirect commands
+struct particle_counters
+{
+    uint32_t alive_count;
+    uint32_t next_alive_count;
+    uint32_t dead_count;
+    uint32_t emit_count;
+    VkDispatchIndirectCommand emit_dispatch;
+    VkDispatchIndirectCommand simulate_dispatch;
+    VkDispatchIndirectCommand sort_dispatch;
+    uint32_t sort_count;
+    VkDrawIndirectCommand draw_args;
+};
+
+// particles.glsl particle_dispatch_block
+struct particle_dispatch
+{
+    uint32_t mode;
+    uint32_t k;
+    uint32_t j;
+    uint32_t padding;
+};
+
+// particle.vert particle_draw_params
+struct particle_draw_params
+{
+    float view_proj[16];
+    float camera_right[4];
+    float camera_up[4];
+};
+
+// particles.glsl PARTICLE_* / SORT_* modes
+enum class particle_mode : uint32_t
+{
+    reset = 0,
+    begin = 1,
+    before_simulate = 2,
+    end = 3,
+    sort_presort = 4,
+    sort_global = 5,
+    sort_merge = 6,
+};
+
+static const uint32_t GROUP_SIZE = 64;
+static const uint32_t SORT_BLOCK = 512;
+
+static VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// unpackUnorm4x8 order: r in the lowest byte
+static uint32_t pack_color(const float color[4])
+{
+    uint32_t packed = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        float c = std::min(std::max(color[i], 0.0f), 1.0f);
+        packed |= static_cast<uint32_t>(c * 255.0f + 0.5f) << (i * 8);
+    }
+    return packed;
+}
+
+// Everything written by one compute step is read (or overwritten) by the next, including indirect arguments
+static void compute_barrier(VkCommandBuffer command_buffer)
+{
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+particle_system::particle_system()
+    : m_context(nullptr), m_frames_in_flight(0), m_frame_index(0), m_parity(0), m_sort_size(SORT_BLOCK), m_needs_reset(false), m_updated(false), m_params_size(0), m_emitters_offset(0), m_frame_stride(0), m_set_layout(VK_NULL_HANDLE), m_descriptor_pool(VK_NULL_HANDLE), m_descriptor_sets{VK_NULL_HANDLE, VK_NULL_HANDLE}, m_compute_layout(VK_NULL_HANDLE), m_prepare_pipeline(VK_NULL_HANDLE), m_emit_pipeline(VK_NULL_HANDLE), m_simulate_pipeline(VK_NULL_HANDLE), m_sort_pipeline(VK_NULL_HANDLE), m_registry(nullptr), m_render_layout(VK_NULL_HANDLE), m_render_pipeline(0), m_frame_seed(0)
+{
+    // Identity camera looking down -Z until the first set_camera
+    const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    set_camera(identity, identity);
+}
+
+particle_system::~particle_system()
+{
+    cleanup();
+}
+
+bool particle_system::initialize(vk_context* context, pipeline_registry* registry, uint32_t frames_in_flight, const config& cfg)
+{
+    if (!context || !registry || frames_in_flight == 0 || cfg.max_particles == 0 || cfg.max_emitters == 0)
+    {
+        log_error("Invalid arguments provided to particle_system::initialize");
+        return false;
+    }
+
+    m_context = context;
+    m_registry = registry;
+    m_config = cfg;
+    m_frames_in_flight = frames_in_flight;
+    m_frame_index = 0;
+    m_updated = false;
+
+    m_sort_size = SORT_BLOCK;
+    while (m_sort_size < m_config.max_particles)
+    {
+        m_sort_size <<= 1;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_context->get_physical_device(), &properties);
+    const VkPhysicalDeviceLimits& limits = properties.limits;
+
+    VkDeviceSize alignment = std::max<VkDeviceSize>(std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment), 16);
+    m_params_size = sizeof(particle_params);
+    m_emitters_offset = align_up(m_params_size, alignment);
+    m_frame_stride = align_up(m_emitters_offset + sizeof(gpu_particle_emitter) * m_config.max_emitters, alignment);
+
+    try
+    {
+        // Only the small per-frame region is created up front; particle state waits for the first emitter
+        m_frame_buffer = m_context->get_resources()->create_buffer(m_frame_stride * m_frames_in_flight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (!m_context->get_resources()->get(m_frame_buffer))
+        {
+            throw std::runtime_error("failed to create particle frame buffer!");
+        }
+        create_pipelines();
+    }
+    catch (const std::exception& e)
+    {
+        log_error("Failed to initialize particle system: %s", e.what());
+        cleanup();
+        return false;
+    }
+
+    log_info("GPU particles: up to %u particles, %u emitters, %s", m_config.max_particles, m_config.max_emitters, m_config.sort ? "sorted" : "unsorted");
+    return true;
+}
+
+void particle_system::cleanup()
+{
+    if (!m_context)
+        return;
+
+    VkDevice device = m_context->get_device();
+
+    release_buffers();
+    m_context->get_resources()->release(m_frame_buffer);
+    m_frame_buffer = buffer_handle{};
+
+    vkDestroyPipeline(device, m_prepare_pipeline, nullptr);
+    vkDestroyPipeline(device, m_emit_pipeline, nullptr);
+    vkDestroyPipeline(device, m_simulate_pipeline, nullptr);
+    vkDestroyPipeline(device, m_sort_pipeline, nullptr);
+    vkDestroyPipelineLayout(device, m_render_layout, nullptr);
+    vkDestroyPipelineLayout(device, m_compute_layout, nullptr);
+    vkDestroyDescriptorSetLayout(device, m_set_layout, nullptr);
+    m_prepare_pipeline = VK_NULL_HANDLE;
+    m_emit_pipeline = VK_NULL_HANDLE;
+    m_simulate_pipeline = VK_NULL_HANDLE;
+    m_sort_pipeline = VK_NULL_HANDLE;
+    m_render_layout = VK_NULL_HANDLE;
+    m_compute_layout = VK_NULL_HANDLE;
+    m_set_layout = VK_NULL_HANDLE;
+
+    m_registry = nullptr;
+    m_updated = false;
+    m_context = nullptr;
+}
+
+bool particle_system::resize_frames(uint32_t frames_in_flight)
+{
+    if (!m_context || frames_in_flight == 0)
+        return false;
+
+    // Only the parameter / emitter regions are per frame; particle state and pipelines are kept as they are
+    resource_pool* resources = m_context->get_resources();
+    resources->release(m_frame_buffer);
+    m_frame_buffer = resources->create_buffer(m_frame_stride * frames_in_flight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (!resources->get(m_frame_buffer))
+    {
+        log_error("Failed to resize particle system to %u frames in flight", frames_in_flight);
+        return false;
+    }
+
+    m_frames_in_flight = frames_in_flight;
+    m_frame_index = 0;
+    m_updated = false;
+
+    // The ping-pong sets view the frame buffer, so live particles need them rewritten against the new one
+    if (m_descriptor_pool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(m_context->get_device(), m_descriptor_pool, nullptr);
+        m_descriptor_pool = VK_NULL_HANDLE;
+        try
+        {
+            create_descriptors();
+        }
+        catch (const std::exception& e)
+        {
+            log_error("Failed to resize particle system: %s", e.what());
+            return false;
+        }
+    }
+    return true;
+}
+
+void particle_system::create_pipelines()
+{
+    VkDevice device = m_context->get_device();
+
+    // Written by compute; the billboard vertex shader reads the particles and the draw list
+    VkDescriptorSetLayoutBinding bindings[8]{};
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : i == 1 ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = 8;
+    layout_info.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr, &m_set_layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create particle descriptor set layout!");
+    }
+
+    VkPushConstantRange dispatch_range{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(particle_dispatch)};
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &m_set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &dispatch_range;
+    if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &m_compute_layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create particle compute pipeline layout!");
+    }
+
+    VkPushConstantRange draw_range{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(particle_draw_params)};
+    pipeline_layout_info.pPushConstantRanges = &draw_range;
+    if (vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &m_render_layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create particle render pipeline layout!");
+    }
+
+    const char* shaders[4] = {"shaders/particle_prepare.comp.spv", "shaders/particle_emit.comp.spv", "shaders/particle_simulate.comp.spv", "shaders/particle_sort.comp.spv"};
+    VkPipeline* pipelines[4] = {&m_prepare_pipeline, &m_emit_pipeline, &m_simulate_pipeline, &m_sort_pipeline};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        VkShaderModule module = load_shader_module(device, shaders[i]);
+
+        VkComputePipelineCreateInfo pipeline_info{};
+        pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipeline_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipeline_info.stage.module = module;
+        pipeline_info.stage.pName = "main";
+        pipeline_info.layout = m_compute_layout;
+
+        VkResult result = vkCreateComputePipelines(device, m_context->get_pipeline_cache(), 1, &pipeline_info, nullptr, pipelines[i]);
+        vkDestroyShaderModule(device, module, nullptr);
+
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create particle compute pipeline!");
+        }
+    }
+
+    // Blended on top of the opaque scene: depth tested against it (reverse-Z), never written
+    // Compiled with every other variant on the next set_target, never on the frame that first draws
+    pipeline_desc desc;
+    desc.name = "particles";
+    desc.vertex_shader = "shaders/particle.vert.spv";
+    desc.fragment_shader = "shaders/particle.frag.spv";
+    desc.cull_mode = VK_CULL_MODE_NONE;
+    desc.depth_write = false;
+    desc.alpha_blend = true;
+    desc.layout = m_render_layout;
+    m_render_pipeline = m_registry->register_pipeline(desc);
+}
+
+void particle_system::create_buffers()
+{
+    resource_pool* resources = m_context->get_resources();
+    const VkBufferUsageFlags storage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+    m_particle_buffer = resources->create_buffer(sizeof(gpu_particle) * m_config.max_particles, storage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_dead_buffer = resources->create_buffer(sizeof(uint32_t) * m_config.max_particles, storage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_alive_buffers[0] = resources->create_buffer(sizeof(uint32_t) * m_config.max_particles, storage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_alive_buffers[1] = resources->create_buffer(sizeof(uint32_t) * m_config.max_particles, storage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_counter_buffer = resources->create_buffer(sizeof(particle_counters), storage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_draw_list_buffer = resources->create_buffer(sizeof(gpu_draw_entry) * m_sort_size, storage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (!resources->get(m_particle_buffer) || !resources->get(m_dead_buffer) || !resources->get(m_alive_buffers[0]) ||
+        !resources->get(m_alive_buffers[1]) || !resources->get(m_counter_buffer) || !resources->get(m_draw_list_buffer))
+    {
+        throw std::runtime_error("failed to create particle buffers!");
+    }
+
+    create_descriptors();
+
+    // Contents are undefined until the reset dispatch fills the dead list and counters
+    m_needs_reset = true;
+    m_parity = 0;
+    m_last_update = std::chrono::steady_clock::now();
+}
+
+void particle_system::release_buffers()
+{
+    resource_pool* resources = m_context->get_resources();
+    resources->release(m_particle_buffer);
+    resources->release(m_dead_buffer);
+    resources->release(m_alive_buffers[0]);
+    resources->release(m_alive_buffers[1]);
+    resources->release(m_counter_buffer);
+    resources->release(m_draw_list_buffer);
+    m_particle_buffer = buffer_handle{};
+    m_dead_buffer = buffer_handle{};
+    m_alive_buffers[0] = buffer_handle{};
+    m_alive_buffers[1] = buffer_handle{};
+    m_counter_buffer = buffer_handle{};
+    m_draw_list_buffer = buffer_handle{};
+
+    // Only called with no frame referencing the sets (device idle, or creation just failed)
+    vkDestroyDescriptorPool(m_context->get_device(), m_descriptor_pool, nullptr);
+    m_descriptor_pool = VK_NULL_HANDLE;
+    m_descriptor_sets[0] = VK_NULL_HANDLE;
+    m_descriptor_sets[1] = VK_NULL_HANDLE;
+}
+
+void particle_system::create_descriptors()
+{
+    VkDevice device = m_context->get_device();
+
+    VkDescriptorPoolSize pool_sizes[] = {
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 2},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 2},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 12},
+    };
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = 2;
+    pool_info.poolSizeCount = 3;
+    pool_info.pPoolSizes = pool_sizes;
+    if (vkCreateDescriptorPool(device, &pool_info, nullptr, &m_descriptor_pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create particle descriptor pool!");
+    }
+
+    VkDescriptorSetLayout layouts[2] = {m_set_layout, m_set_layout};
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = m_descriptor_pool;
+    alloc_info.descriptorSetCount = 2;
+    alloc_info.pSetLayouts = layouts;
+    if (vkAllocateDescriptorSets(device, &alloc_info, m_descriptor_sets) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate particle descriptor sets!");
+    }
+
+    // Set p reads alive list p and appends to the other one; the frame region is selected by dynamic offsets
+    resource_pool* resources = m_context->get_resources();
+    VkBuffer frame_buffer = resources->get(m_frame_buffer)->buffer;
+    for (uint32_t p = 0; p < 2; p++)
+    {
+        VkDescriptorBufferInfo buffer_infos[8] = {
+            {frame_buffer, 0, m_params_size},
+            {frame_buffer, m_emitters_offset, sizeof(gpu_particle_emitter) * m_config.max_emitters},
+            {resources->get(m_particle_buffer)->buffer, 0, VK_WHOLE_SIZE},
+            {resources->get(m_dead_buffer)->buffer, 0, VK_WHOLE_SIZE},
+            {resources->get(m_alive_buffers[p])->buffer, 0, VK_WHOLE_SIZE},
+            {resources->get(m_alive_buffers[p ^ 1])->buffer, 0, VK_WHOLE_SIZE},
+            {resources->get(m_counter_buffer)->buffer, 0, VK_WHOLE_SIZE},
+            {resources->get(m_draw_list_buffer)->buffer, 0, VK_WHOLE_SIZE},
+        };
+
+        VkWriteDescriptorSet writes[8]{};
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = m_descriptor_sets[p];
+            writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : i == 1 ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &buffer_infos[i];
+        }
+        vkUpdateDescriptorSets(device, 8, writes, 0, nullptr);
+    }
+}
+
+void particle_system::set_emitters(const particle_emitter* emitters, uint32_t count)
+{
+    if (count > m_config.max_emitters)
+    {
+        log_warn("%u particle emitters exceed the limit of %u, the rest are ignored", count, m_config.max_emitters);
+        count = m_config.max_emitters;
+    }
+    m_emitters.assign(emitters, emitters + count);
+    m_emit_remainders.resize(count, 0.0f);
+}
+
+uint32_t particle_system::get_emitter_count() const
+{
+    return static_cast<uint32_t>(m_emitters.size());
+}
+
+void particle_system::set_camera(const float view[16], const float view_proj[16])
+{
+    std::memcpy(m_view_proj, view_proj, sizeof(m_view_proj));
+
+    // Rows of the view rotation are the camera axes in world space; position = -R^T * t
+    for (int i = 0; i < 3; i++)
+    {
+        m_camera_right[i] = view[i * 4 + 0];
+        m_camera_up[i] = view[i * 4 + 1];
+        m_camera_position[i] = -(view[i * 4 + 0] * view[12] + view[i * 4 + 1] * view[13] + view[i * 4 + 2] * view[14]);
+    }
+}
+
+void particle_system::begin_frame(uint32_t frame_index)
+{
+    if (!m_context)
+        return;
+
+    m_frame_index = frame_index % m_frames_in_flight;
+    m_updated = false;
+}
+
+bool particle_system::is_active() const
+{
+    // Particles already in flight keep simulating after the last emitter is removed
+    return m_context && (!m_emitters.empty() || m_particle_buffer.is_valid());
+}
+
+void particle_system::update(VkCommandBuffer command_buffer)
+{
+    if (!is_active())
+        return;
+
+    if (!m_particle_buffer.is_valid())
+    {
+        try
+        {
+            create_buffers();
+        }
+        catch (const std::exception& e)
+        {
+            log_error("Failed to create particle buffers, emitters dropped: %s", e.what());
+            release_buffers();
+            m_emitters.clear();
+            m_emit_remainders.clear();
+            return;
+        }
+    }
+    // Nothing is simulated until the registry workers have compiled the billboard pipeline that draws it
+    if (!m_registry->is_ready(m_render_pipeline))
+        return;
+
+    // A stalled or first frame must not dump seconds of emission at once
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    float dt = std::min(std::chrono::duration<float>(now - m_last_update).count(), m_config.max_time_step);
+    m_last_update = now;
+
+    uint8_t* region = static_cast<uint8_t*>(m_context->get_resources()->get(m_frame_buffer)->mapped) + m_frame_stride * m_frame_index;
+
+    // Emission counts are the only per-frame CPU work: whole particles this frame, the fraction carries over
+    gpu_particle_emitter* gpu_emitters = reinterpret_cast<gpu_particle_emitter*>(region + m_emitters_offset);
+    uint32_t requested = 0;
+    for (size_t i = 0; i < m_emitters.size(); i++)
+    {
+        const particle_emitter& emitter = m_emitters[i];
+        float exact = std::max(emitter.rate, 0.0f) * dt + m_emit_remainders[i];
+        uint32_t count = std::min(static_cast<uint32_t>(exact), m_config.max_particles - requested);
+        m_emit_remainders[i] = exact - std::floor(exact);
+
+        gpu_particle_emitter& gpu = gpu_emitters[i];
+        std::memcpy(gpu.position_radius, emitter.position, sizeof(float) * 3);
+        gpu.position_radius[3] = emitter.radius;
+        std::memcpy(gpu.velocity_spread, emitter.velocity, sizeof(float) * 3);
+        gpu.velocity_spread[3] = emitter.spread;
+        gpu.lifetime_size[0] = emitter.lifetime_min;
+        gpu.lifetime_size[1] = std::max(emitter.lifetime_max, emitter.lifetime_min);
+        gpu.lifetime_size[2] = emitter.size_begin;
+        gpu.lifetime_size[3] = emitter.size_end;
+        gpu.emission[0] = pack_color(emitter.color_begin);
+        gpu.emission[1] = pack_color(emitter.color_end);
+        gpu.emission[2] = requested;
+        gpu.emission[3] = count;
+        requested += count;
+    }
+
+    particle_params* params = reinterpret_cast<particle_params*>(region);
+    std::memcpy(params->gravity_dt, m_config.gravity, sizeof(float) * 3);
+    params->gravity_dt[3] = dt;
+    std::memcpy(params->camera_drag, m_camera_position, sizeof(float) * 3);
+    params->camera_drag[3] = m_config.drag;
+    params->counts[0] = static_cast<uint32_t>(m_emitters.size());
+    params->counts[1] = requested;
+    params->counts[2] = m_frame_seed++;
+    params->counts[3] = m_config.max_particles;
+
+    // The previous frame's billboard draw must be done reading before the lists are rewritten
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    uint32_t offsets[2] = {static_cast<uint32_t>(m_frame_stride * m_frame_index), static_cast<uint32_t>(m_frame_stride * m_frame_index)};
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_compute_layout, 0, 1, &m_descriptor_sets[m_parity], 2, offsets);
+
+    if (m_needs_reset)
+    {
+        dispatch(command_buffer, m_prepare_pipeline, (m_config.max_particles + GROUP_SIZE - 1) / GROUP_SIZE, static_cast<uint32_t>(particle_mode::reset));
+        compute_barrier(command_buffer);
+        m_needs_reset = false;
+    }
+
+    // Each step sizes the next one on the GPU, so the CPU never learns how many particles are alive
+    dispatch(command_buffer, m_prepare_pipeline, 1, static_cast<uint32_t>(particle_mode::begin));
+    compute_barrier(command_buffer);
+    dispatch_indirect(command_buffer, m_emit_pipeline, offsetof(particle_counters, emit_dispatch), 0);
+    compute_barrier(command_buffer);
+    dispatch(command_buffer, m_prepare_pipeline, 1, static_cast<uint32_t>(particle_mode::before_simulate));
+    compute_barrier(command_buffer);
+    dispatch_indirect(command_buffer, m_simulate_pipeline, offsetof(particle_counters, simulate_dispatch), 0);
+    compute_barrier(command_buffer);
+    dispatch(command_buffer, m_prepare_pipeline, 1, static_cast<uint32_t>(particle_mode::end));
+    compute_barrier(command_buffer);
+
+    if (m_config.sort)
+    {
+        record_sort(command_buffer);
+    }
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    // Survivors were appended to the other list; it is the input next frame
+    m_parity ^= 1;
+    m_updated = true;
+}
+
+void particle_system::record_sort(VkCommandBuffer command_buffer)
+{
+    // Recorded for the largest possible list; the indirect group count follows the live sort_count,
+    // and stages past it only compare already ordered pairs
+    VkDeviceSize offset = offsetof(particle_counters, sort_dispatch);
+    dispatch_indirect(command_buffer, m_sort_pipeline, offset, static_cast<uint32_t>(particle_mode::sort_presort));
+    compute_barrier(command_buffer);
+
+    for (uint32_t k = SORT_BLOCK * 2; k <= m_sort_size; k <<= 1)
+    {
+        for (uint32_t j = k / 2; j >= SORT_BLOCK; j >>= 1)
+        {
+            dispatch_indirect(command_buffer, m_sort_pipeline, offset, static_cast<uint32_t>(particle_mode::sort_global), k, j);
+            compute_barrier(command_buffer);
+        }
+        dispatch_indirect(command_buffer, m_sort_pipeline, offset, static_cast<uint32_t>(particle_mode::sort_merge), k);
+        compute_barrier(command_buffer);
+    }
+}
+
+void particle_system::dispatch(VkCommandBuffer command_buffer, VkPipeline pipeline, uint32_t group_count, uint32_t mode)
+{
+    particle_dispatch params{mode, 0, 0, 0};
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdPushConstants(command_buffer, m_compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdDispatch(command_buffer, group_count, 1, 1);
+}
+
+void particle_system::dispatch_indirect(VkCommandBuffer command_buffer, VkPipeline pipeline, VkDeviceSize offset, uint32_t mode, uint32_t k, uint32_t j)
+{
+    particle_dispatch params{mode, k, j, 0};
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdPushConstants(command_buffer, m_compute_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdDispatchIndirect(command_buffer, m_context->get_resources()->get(m_counter_buffer)->buffer, offset);
+}
+
+void particle_system::draw(VkCommandBuffer command_buffer)
+{
+    if (!m_updated || !m_registry->is_ready(m_render_pipeline))
+        return;
+
+    particle_draw_params params{};
+    std::memcpy(params.view_proj, m_view_proj, sizeof(params.view_proj));
+    std::memcpy(params.camera_right, m_camera_right, sizeof(float) * 3);
+    std::memcpy(params.camera_up, m_camera_up, sizeof(float) * 3);
+
+    // Either set works here: the draw only reads the particles and the draw list, which both share
+    uint32_t offsets[2] = {static_cast<uint32_t>(m_frame_stride * m_frame_index), static_cast<uint32_t>(m_frame_stride * m_frame_index)};
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_registry->get(m_render_pipeline));
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_render_layout, 0, 1, &m_descriptor_sets[m_parity], 2, offsets);
+    vkCmdPushConstants(command_buffer, m_render_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(params), &params);
+
+    // Six vertices per particle, instance count written by the end-of-frame prepare step
+    vkCmdDrawIndirect(command_buffer, m_context->get_resources()->get(m_counter_buffer)->buffer, offsetof(particle_counters, draw_args), 1, sizeof(VkDrawIndirectCommand));
+}
+
+} // namespace juce
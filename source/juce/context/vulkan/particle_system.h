@@ -0,0 +1,144 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+#include <juce/context/vulkan/resource_pool.h>
+#include <juce/context/vulkan/pipeline_registry.h>
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+// world-space 방출기 (초당 rate개, 수명 동안 색 / 크기를 begin -> end로 보간)
+struct particle_emitter
+{
+    float position[3];
+    float radius;       // 이 반경의 구 안에서 생성
+    float velocity[3];
+    float spread;       // 속도에 더해지는 무작위 성분의 최대 크기
+    float color_begin[4];
+    float color_end[4];
+    float lifetime_min; // 초
+    float lifetime_max;
+    float size_begin;   // billboard 반지름 (world 단위)
+    float size_end;
+    float rate;         // 초당 방출 수
+};
+
+/**
+ * GPU compute particle system
+ * - 관리: 파티클 / dead 목록 / alive 목록 2개 (ping-pong) / 정렬 목록 / 카운터 버퍼, compute 파이프라인 4개, billboard 파이프라인 (registry에 등록)
+ * - 방출, 시뮬레이션, 생존 목록, 정렬(back-to-front bitonic)을 모두 compute로, 그리기는 indirect draw
+ *   -> CPU는 방출기별 방출 수만 계산, 파티클 하나하나는 건드리지 않음 (GPU 카운터를 읽어오지도 않음)
+ * - 파티클 버퍼는 처음 방출기가 생길 때 생성, 이후 프레임 사이에 유지
+ *
+ * descriptor set 레이아웃 (compute / 그리기 공용, set 0)
+ * - binding 0: 파라미터 (UNIFORM_BUFFER_DYNAMIC)
+ * - binding 1: 방출기 (STORAGE_BUFFER_DYNAMIC)
+ * - binding 2: 파티클, 3: dead 목록, 4: 이번 프레임 alive 목록, 5: 다음 프레임 alive 목록
+ * - binding 6: 카운터 + indirect 인자, 7: 그리기 목록 (정렬 key + 파티클 index)
+ * - 4 / 5를 바꾼 set 두 개를 프레임마다 번갈아 바인딩
+ */
+class particle_system
+{
+public:
+    struct config
+    {
+        uint32_t max_particles = 1 << 20; // 넘치면 방출이 dead 목록 크기로 잘림
+        uint32_t max_emitters = 64;       // 프레임당 최대 방출기 수
+        bool sort = true;                 // alpha blend를 위해 멀리 있는 것부터 그림
+        float gravity[3] = {0.0f, -9.8f, 0.0f};
+        float drag = 0.0f;                // 초당 속도 감쇠 비율
+        float max_time_step = 0.05f;      // 멈췄다 돌아온 프레임이 한 번에 튀지 않도록
+    };
+
+    particle_system();
+    ~particle_system();
+
+    // 그리기 파이프라인을 registry에 등록하므로 registry에 target이 없을 때 호출 (다음 set_target에서 함께 컴파일)
+    bool initialize(vk_context* context, pipeline_registry* registry, uint32_t frames_in_flight, const config& cfg);
+    // GPU 객체 정리 (device idle 이후), 살아 있던 파티클은 사라지고 방출기 / 카메라는 유지
+    void cleanup();
+    // frames in flight 변경 (device idle 이후): 프레임별 구역만 다시 만들고 방출기 / 살아 있는 파티클은 유지
+    bool resize_frames(uint32_t frames_in_flight);
+
+    // 방출기 목록 교체 (max_emitters 초과분은 무시), 같은 수면 방출 누적값 유지
+    void set_emitters(const particle_emitter* emitters, uint32_t count);
+    uint32_t get_emitter_count() const;
+
+    // column-major view / view * projection (billboard 방향, 정렬 기준 카메라 위치)
+    void set_camera(const float view[16], const float view_proj[16]);
+
+    // 프레임 슬롯 전환 (이 슬롯을 쓰던 GPU 작업이 끝난 뒤 호출)
+    void begin_frame(uint32_t frame_index);
+
+    // 메인 패스 전에 기록 (패스 밖): 방출 + 시뮬레이션 + 정렬, 끝나면 그리기 인자가 준비됨
+    // - 그리기 파이프라인 컴파일이 끝나기 전에는 아무것도 기록하지 않음
+    void update(VkCommandBuffer command_buffer);
+    // 메인 패스 안, 불투명 오브젝트 다음에 기록 (depth test만, 쓰기 없음, viewport / scissor는 패스의 것)
+    void draw(VkCommandBuffer command_buffer);
+
+    // 이번 프레임에 update / draw할 것이 있는지
+    bool is_active() const;
+
+private:
+    void create_pipelines();
+    void create_buffers();
+    void release_buffers();
+    void create_descriptors();
+    void dispatch(VkCommandBuffer command_buffer, VkPipeline pipeline, uint32_t group_count, uint32_t mode);
+    void dispatch_indirect(VkCommandBuffer command_buffer, VkPipeline pipeline, VkDeviceSize offset, uint32_t mode, uint32_t k = 0, uint32_t j = 0);
+    void record_sort(VkCommandBuffer command_buffer);
+
+    vk_context* m_context; // 소유하지 않음
+    config m_config;
+    uint32_t m_frames_in_flight;
+    uint32_t m_frame_index;
+    uint32_t m_parity;      // 이번 프레임에 바인딩할 set (alive 목록 방향)
+    uint32_t m_sort_size;   // 정렬 목록 크기 (max_particles 이상인 2의 거듭제곱)
+    bool m_needs_reset;     // 버퍼 생성 직후: dead 목록 / 카운터 초기화 기록
+    bool m_updated;         // 이번 프레임 update가 기록됨 (draw 가능)
+
+    // 프레임 구역 = [파라미터 | 방출기], dynamic offset으로 바인딩
+    buffer_handle m_frame_buffer;
+    VkDeviceSize m_params_size;
+    VkDeviceSize m_emitters_offset;
+    VkDeviceSize m_frame_stride;
+
+    // 파티클 상태 (GPU 전용, 처음 필요할 때 생성)
+    buffer_handle m_particle_buffer;
+    buffer_handle m_dead_buffer;
+    buffer_handle m_alive_buffers[2];
+    buffer_handle m_counter_buffer;
+    buffer_handle m_draw_list_buffer;
+
+    VkDescriptorSetLayout m_set_layout;
+    VkDescriptorPool m_descriptor_pool;
+    VkDescriptorSet m_descriptor_sets[2];
+    VkPipelineLayout m_compute_layout;
+    VkPipeline m_prepare_pipeline;
+    VkPipeline m_emit_pipeline;
+    VkPipeline m_simulate_pipeline;
+    VkPipeline m_sort_pipeline;
+
+    // 그리기 (registry 워커가 컴파일, fallback은 layout이 달라 쓰지 않음)
+    pipeline_registry* m_registry; // 소유하지 않음
+    VkPipelineLayout m_render_layout;
+    pipeline_id m_render_pipeline;
+
+    // CPU 측 상태 (cleanup 후에도 유지)
+    std::vector<particle_emitter> m_emitters;
+    std::vector<float> m_emit_remainders; // 방출기별 다음 프레임으로 넘기는 소수 부분
+    float m_view_proj[16];
+    float m_camera_right[3];
+    float m_camera_up[3];
+    float m_camera_position[3];
+    std::chrono::steady_clock::time_point m_last_update;
+    uint32_t m_frame_seed;
+};
+
+} // namespace juce
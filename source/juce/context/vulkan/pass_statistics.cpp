@@ -0,0 +1,248 @@
+// pass_statistics는 "각 패스가 GPU에 얼마나 많은 일을 시켰는가"를 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "pass_statistics.h"
+#include "vk_context.h"
+
+#include <algorithm>
+
+namespace juce
+{
+
+// Results are written in ascending bit order, which is also the order of pass_stats' counters
+static const VkQueryPipelineStatisticFlags STATISTICS_FLAGS =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+static const uint32_t STATISTICS_COUNT = 7;
+
+pass_statistics::pass_statistics()
+    : m_context(nullptr), m_frame_index(0), m_enabled(false), m_pipeline_statistics(false), m_occlusion_flags(0)
+{
+}
+
+pass_statistics::~pass_statistics()
+{
+    cleanup();
+}
+
+bool pass_statistics::initialize(vk_context* context, uint32_t frames_in_flight, const config& cfg)
+{
+    if (!context || frames_in_flight == 0 || cfg.max_passes == 0)
+    {
+        log_error("Invalid arguments provided to pass_statistics::initialize");
+        return false;
+    }
+
+    cleanup();
+
+    m_context = context;
+    m_config = cfg;
+    m_frame_index = 0;
+
+    // Both are optional device features; without precise occlusion the sample count may only be zero / non-zero
+    const VkPhysicalDeviceFeatures& features = m_context->get_enabled_features();
+    m_pipeline_statistics = features.pipelineStatisticsQuery == VK_TRUE;
+    m_occlusion_flags = features.occlusionQueryPrecise ? VK_QUERY_CONTROL_PRECISE_BIT : 0;
+    m_results.resize(m_config.max_passes * STATISTICS_COUNT);
+
+    VkQueryPoolCreateInfo statistics_info{};
+    statistics_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    statistics_info.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    statistics_info.queryCount = m_config.max_passes;
+    statistics_info.pipelineStatistics = STATISTICS_FLAGS;
+
+    VkQueryPoolCreateInfo occlusion_info{};
+    occlusion_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    occlusion_info.queryType = VK_QUERY_TYPE_OCCLUSION;
+    occlusion_info.queryCount = m_config.max_passes;
+
+    VkDevice device = m_context->get_device();
+    m_slots.resize(frames_in_flight);
+    for (frame_slot& slot : m_slots)
+    {
+        bool ok = vkCreateQueryPool(device, &occlusion_info, nullptr, &slot.occlusion_pool) == VK_SUCCESS;
+        if (ok && m_pipeline_statistics)
+        {
+            ok = vkCreateQueryPool(device, &statistics_info, nullptr, &slot.statistics_pool) == VK_SUCCESS;
+        }
+        if (!ok)
+        {
+            log_error("Failed to create pass statistics query pools");
+            cleanup();
+            return false;
+        }
+        slot.names.reserve(m_config.max_passes);
+    }
+    return true;
+}
+
+void pass_statistics::cleanup()
+{
+    if (!m_context)
+        return;
+
+    VkDevice device = m_context->get_device();
+    for (frame_slot& slot : m_slots)
+    {
+        vkDestroyQueryPool(device, slot.statistics_pool, nullptr);
+        vkDestroyQueryPool(device, slot.occlusion_pool, nullptr);
+    }
+    m_slots.clear();
+    m_context = nullptr;
+}
+
+void pass_statistics::set_enabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+bool pass_statistics::is_enabled() const
+{
+    return m_enabled;
+}
+
+bool pass_statistics::has_pipeline_statistics() const
+{
+    return m_pipeline_statistics;
+}
+
+void pass_statistics::begin_frame(uint32_t frame_index)
+{
+    if (!m_context)
+        return;
+
+    m_frame_index = frame_index;
+    frame_slot& slot = m_slots[m_frame_index];
+    uint32_t count = static_cast<uint32_t>(slot.names.size());
+    bool recorded = slot.recording && count > 0;
+    slot.recording = false;
+    if (!recorded)
+    {
+        slot.names.clear();
+        return;
+    }
+
+    // The slot's work has completed, so no wait flag is needed; a pass left incomplete keeps the previous results
+    VkDevice device = m_context->get_device();
+    std::vector<pass_stats> latest(count);
+    std::vector<uint64_t> samples(count);
+    if (vkGetQueryPoolResults(device, slot.occlusion_pool, 0, count, count * sizeof(uint64_t), samples.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+    {
+        slot.names.clear();
+        return;
+    }
+    if (m_pipeline_statistics &&
+        vkGetQueryPoolResults(device, slot.statistics_pool, 0, count, count * STATISTICS_COUNT * sizeof(uint64_t), m_results.data(), STATISTICS_COUNT * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+    {
+        slot.names.clear();
+        return;
+    }
+
+    double pixels = std::max(1.0, static_cast<double>(slot.extent.width) * static_cast<double>(slot.extent.height));
+    for (uint32_t i = 0; i < count; i++)
+    {
+        pass_stats& stats = latest[i];
+        stats.name = slot.names[i];
+        stats.samples_passed = samples[i];
+        if (m_pipeline_statistics)
+        {
+            const uint64_t* values = &m_results[i * STATISTICS_COUNT];
+            stats.input_vertices = values[0];
+            stats.input_primitives = values[1];
+            stats.vertex_invocations = values[2];
+            stats.clipping_invocations = values[3];
+            stats.clipping_primitives = values[4];
+            stats.fragment_invocations = values[5];
+            stats.compute_invocations = values[6];
+            stats.overdraw = static_cast<float>(stats.fragment_invocations / pixels);
+        }
+    }
+
+    m_latest.swap(latest);
+    slot.names.clear();
+}
+
+void pass_statistics::begin_commands(VkCommandBuffer command_buffer, VkExtent2D extent)
+{
+    if (!m_context)
+        return;
+
+    frame_slot& slot = m_slots[m_frame_index];
+    slot.recording = m_enabled;
+    slot.names.clear();
+    slot.extent = extent;
+    if (!slot.recording)
+        return;
+
+    vkCmdResetQueryPool(command_buffer, slot.occlusion_pool, 0, m_config.max_passes);
+    if (m_pipeline_statistics)
+    {
+        vkCmdResetQueryPool(command_buffer, slot.statistics_pool, 0, m_config.max_passes);
+    }
+}
+
+uint32_t pass_statistics::begin_pass(VkCommandBuffer command_buffer, const char* name)
+{
+    if (!m_context)
+        return UINT32_MAX;
+
+    frame_slot& slot = m_slots[m_frame_index];
+    if (!slot.recording || slot.names.size() >= m_config.max_passes)
+        return UINT32_MAX;
+
+    uint32_t pass = static_cast<uint32_t>(slot.names.size());
+    slot.names.push_back(name);
+    vkCmdBeginQuery(command_buffer, slot.occlusion_pool, pass, m_occlusion_flags);
+    if (m_pipeline_statistics)
+    {
+        vkCmdBeginQuery(command_buffer, slot.statistics_pool, pass, 0);
+    }
+    return pass;
+}
+
+void pass_statistics::end_pass(VkCommandBuffer command_buffer, uint32_t pass)
+{
+    if (pass == UINT32_MAX)
+        return;
+
+    frame_slot& slot = m_slots[m_frame_index];
+    if (m_pipeline_statistics)
+    {
+        vkCmdEndQuery(command_buffer, slot.statistics_pool, pass);
+    }
+    vkCmdEndQuery(command_buffer, slot.occlusion_pool, pass);
+}
+
+const std::vector<pass_stats>& pass_statistics::get_latest() const
+{
+    return m_latest;
+}
+
+void pass_statistics::log_latest() const
+{
+    for (const pass_stats& stats : m_latest)
+    {
+        if (!m_pipeline_statistics)
+        {
+            log_info("Pass %-28s samples %llu", stats.name, static_cast<unsigned long long>(stats.samples_passed));
+            continue;
+        }
+        log_info("Pass %-28s verts %llu, prims %llu -> %llu clipped, frags %llu (%.2fx overdraw), samples %llu, compute %llu",
+                 stats.name,
+                 static_cast<unsigned long long>(stats.vertex_invocations),
+                 static_cast<unsigned long long>(stats.clipping_invocations),
+                 static_cast<unsigned long long>(stats.clipping_primitives),
+                 static_cast<unsigned long long>(stats.fragment_invocations),
+                 stats.overdraw,
+                 static_cast<unsigned long long>(stats.samples_passed),
+                 static_cast<unsigned long long>(stats.compute_invocations));
+    }
+}
+
+} // namespace juce
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <vector>
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+// 패스 하나가 만든 작업량 (pipelineStatisticsQuery 미지원 장치에서는 samples_passed만 유효)
+struct pass_stats
+{
+    const char* name = nullptr;
+    uint64_t input_vertices = 0;
+    uint64_t input_primitives = 0;
+    uint64_t vertex_invocations = 0;
+    uint64_t clipping_invocations = 0; // clipping 단계에 들어간 primitive
+    uint64_t clipping_primitives = 0;  // clipping 후 rasterizer로 간 primitive
+    uint64_t fragment_invocations = 0;
+    uint64_t compute_invocations = 0;
+    uint64_t samples_passed = 0;       // depth / stencil 테스트를 통과한 샘플 (occlusion query)
+    float overdraw = 0.0f;             // fragment_invocations / 화면 픽셀 수
+};
+
+/**
+ * pass statistics
+ * - 관리: 프레임 슬롯별 pipeline statistics / occlusion query pool, 마지막으로 완료된 프레임의 패스별 결과
+ * - 켜져 있을 때만 query를 기록, 결과는 같은 슬롯을 다시 쓸 때 (GPU 완료 후) 대기 없이 읽음
+ *   -> 최신 결과는 frames in flight만큼 늦음
+ * - 같은 종류의 query는 겹칠 수 없으므로 패스 범위는 중첩하지 않음
+ */
+class pass_statistics
+{
+public:
+    struct config
+    {
+        uint32_t max_passes = 16; // 프레임당 패스 수 (넘치면 기록 안 함)
+    };
+
+    pass_statistics();
+    ~pass_statistics();
+
+    bool initialize(vk_context* context, uint32_t frames_in_flight, const config& cfg);
+    // device idle 이후, 최신 결과는 유지
+    void cleanup();
+
+    void set_enabled(bool enabled);
+    bool is_enabled() const;
+    // pipeline statistics를 지원하는지 (아니면 occlusion 결과만)
+    bool has_pipeline_statistics() const;
+
+    // 프레임 슬롯 전환 (이 슬롯을 쓰던 GPU 작업이 끝난 뒤): 지난 결과를 최신 결과로
+    void begin_frame(uint32_t frame_index);
+    // 명령 버퍼 기록 시작 직후 (패스 밖), extent는 overdraw 계산용
+    void begin_commands(VkCommandBuffer command_buffer, VkExtent2D extent);
+
+    // 패스 시작 / 끝 (render pass 밖에서, 꺼져 있거나 슬롯이 차면 UINT32_MAX, end_pass는 무시)
+    uint32_t begin_pass(VkCommandBuffer command_buffer, const char* name);
+    void end_pass(VkCommandBuffer command_buffer, uint32_t pass);
+
+    // 마지막으로 완료된 프레임의 패스별 결과 (기록 순서)
+    const std::vector<pass_stats>& get_latest() const;
+    // 로그로 출력
+    void log_latest() const;
+
+private:
+    struct frame_slot
+    {
+        VkQueryPool statistics_pool = VK_NULL_HANDLE;
+        VkQueryPool occlusion_pool = VK_NULL_HANDLE;
+        std::vector<const char*> names;
+        VkExtent2D extent{};
+        bool recording = false;
+    };
+
+    vk_context* m_context; // 소유하지 않음
+    config m_config;
+    std::vector<frame_slot> m_slots;
+    uint32_t m_frame_index;
+    bool m_enabled;
+    bool m_pipeline_statistics;
+    VkQueryControlFlags m_occlusion_flags;
+
+    std::vector<uint64_t> m_results;
+    std::vector<pass_stats> m_latest;
+};
+
+// 범위 동안의 패스 통계
+class pass_statistics_scope
+{
+public:
+    pass_statistics_scope(pass_statistics& statistics, VkCommandBuffer command_buffer, const char* name)
+        : m_statistics(statistics), m_command_buffer(command_buffer), m_pass(statistics.begin_pass(command_buffer, name))
+    {
+    }
+
+    ~pass_statistics_scope()
+    {
+        m_statistics.end_pass(m_command_buffer, m_pass);
+    }
+
+    pass_statistics_scope(const pass_statistics_scope&) = delete;
+    pass_statistics_scope& operator=(const pass_statistics_scope&) = delete;
+
+private:
+    pass_statistics& m_statistics;
+    VkCommandBuffer m_command_buffer;
+    uint32_t m_pass;
+};
+
+} // namespace juce
@@ -0,0 +1,495 @@
+// pipeline_registry는 "파이프라인을 언제, 어느 스레드에서 만들지"를 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+#include <juce/core/profiler.h>
+
+#include "pipeline_registry.h"
+#include "vk_context.h"
+#include "deletion_queue.h"
+#include "shader_module.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace juce
+{
+
+static bool has_stencil_component(VkFormat format)
+{
+    return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
+}
+
+pipeline_registry::pipeline_registry()
+    : m_context(nullptr), m_fallback(UINT32_MAX), m_has_target(false), m_pending(0), m_generation(0), m_running(0), m_stop(false)
+{
+}
+
+pipeline_registry::~pipeline_registry()
+{
+    cleanup();
+}
+
+bool pipeline_registry::initialize(vk_context* context, const config& cfg)
+{
+    if (!context)
+    {
+        log_error("Invalid arguments provided to pipeline_registry::initialize");
+        return false;
+    }
+
+    m_context = context;
+
+    uint32_t worker_count = cfg.worker_count;
+    if (worker_count == 0)
+    {
+        // Leave one core to the thread that keeps recording frames
+        uint32_t cores = std::thread::hardware_concurrency();
+        worker_count = cores > 1 ? cores - 1 : 1;
+    }
+
+    m_stop = false;
+    for (uint32_t i = 0; i < worker_count; i++)
+    {
+        m_workers.emplace_back(&pipeline_registry::worker_loop, this);
+    }
+
+    log_info("Pipeline registry: %u compile threads", worker_count);
+    return true;
+}
+
+void pipeline_registry::cleanup()
+{
+    if (!m_workers.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            m_jobs.clear();
+        }
+        m_job_cv.notify_all();
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+        m_workers.clear();
+    }
+
+    if (!m_context)
+        return;
+
+    // The device is idle by now, so nothing has to go through the deletion queue
+    VkDevice device = m_context->get_device();
+    for (const compile_result& result : m_results)
+    {
+        vkDestroyPipeline(device, result.pipeline, nullptr);
+    }
+    for (const entry& e : m_entries)
+    {
+        vkDestroyPipeline(device, e.pipeline, nullptr);
+    }
+    m_results.clear();
+    m_entries.clear();
+    m_fallback = UINT32_MAX;
+    m_has_target = false;
+    m_pending = 0;
+    m_context = nullptr;
+}
+
+pipeline_id pipeline_registry::register_pipeline(const pipeline_desc& desc)
+{
+    for (pipeline_id id = 0; id < m_entries.size(); id++)
+    {
+        if (m_entries[id].desc.name == desc.name)
+        {
+            // Nothing is compiled or queued without a target, so the new description is safe to take
+            if (!m_has_target)
+            {
+                m_entries[id].desc = desc;
+            }
+            return id;
+        }
+    }
+
+    pipeline_id id = static_cast<pipeline_id>(m_entries.size());
+    entry e;
+    e.desc = desc;
+    m_entries.push_back(std::move(e));
+
+    // Registered after the target was set: compile it right away
+    if (m_has_target)
+    {
+        m_entries[id].state = entry_state::pending;
+        m_pending++;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back({id, m_generation, desc});
+        }
+        m_job_cv.notify_one();
+    }
+    return id;
+}
+
+const pipeline_desc& pipeline_registry::get_desc(pipeline_id id) const
+{
+    return m_entries[id].desc;
+}
+
+uint32_t pipeline_registry::get_pipeline_count() const
+{
+    return static_cast<uint32_t>(m_entries.size());
+}
+
+void pipeline_registry::set_fallback(pipeline_id id)
+{
+    m_fallback = id;
+}
+
+void pipeline_registry::set_target(const pipeline_target& target)
+{
+    release_target();
+
+    m_target = target;
+    m_has_target = true;
+    m_pending = static_cast<uint32_t>(m_entries.size());
+    m_compile_start = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job_target = target;
+
+        // The fallback goes first: it is what every other draw uses until its own pipeline lands
+        if (m_fallback < m_entries.size())
+        {
+            m_jobs.push_back({m_fallback, m_generation, m_entries[m_fallback].desc});
+        }
+        for (pipeline_id id = 0; id < m_entries.size(); id++)
+        {
+            m_entries[id].state = entry_state::pending;
+            if (id != m_fallback)
+            {
+                m_jobs.push_back({id, m_generation, m_entries[id].desc});
+            }
+        }
+    }
+    m_job_cv.notify_all();
+}
+
+void pipeline_registry::release_target()
+{
+    if (!m_has_target)
+        return;
+
+    {
+        // Compiles already running hold the layout / render pass about to be destroyed; let them finish
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobs.clear();
+        m_generation++;
+        m_done_cv.wait(lock, [this]()
+                       { return m_running == 0; });
+
+        // Every result left is from the old target and was never handed out
+        for (const compile_result& result : m_results)
+        {
+            vkDestroyPipeline(m_context->get_device(), result.pipeline, nullptr);
+        }
+        m_results.clear();
+    }
+
+    // Frames in flight may still use these
+    deletion_queue* queue = m_context->get_deletion_queue();
+    for (entry& e : m_entries)
+    {
+        queue->destroy_pipeline(e.pipeline);
+        e.pipeline = VK_NULL_HANDLE;
+        e.state = entry_state::idle;
+    }
+    m_pending = 0;
+    m_has_target = false;
+}
+
+const pipeline_target& pipeline_registry::get_target() const
+{
+    return m_target;
+}
+
+void pipeline_registry::update()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    apply_results_locked();
+}
+
+void pipeline_registry::apply_results_locked()
+{
+    if (m_results.empty())
+        return;
+
+    for (const compile_result& result : m_results)
+    {
+        entry& e = m_entries[result.id];
+        if (result.generation != m_generation || e.state != entry_state::pending)
+        {
+            // Stale target, or already replaced by a hot-reload
+            vkDestroyPipeline(m_context->get_device(), result.pipeline, nullptr);
+            continue;
+        }
+
+        if (result.pipeline != VK_NULL_HANDLE)
+        {
+            e.pipeline = result.pipeline;
+            e.state = entry_state::ready;
+        }
+        else
+        {
+            e.state = entry_state::failed;
+            log_warn("Pipeline '%s' unavailable, draws use the fallback", e.desc.name.c_str());
+        }
+
+        if (--m_pending == 0)
+        {
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_compile_start).count();
+            log_info("Pipelines: %u compiled in %.1f ms on %zu threads", get_pipeline_count(), ms, m_workers.size());
+        }
+    }
+    m_results.clear();
+}
+
+VkPipeline pipeline_registry::get(pipeline_id id) const
+{
+    if (id < m_entries.size() && m_entries[id].state == entry_state::ready)
+        return m_entries[id].pipeline;
+
+    if (m_fallback < m_entries.size() && m_entries[m_fallback].state == entry_state::ready)
+        return m_entries[m_fallback].pipeline;
+
+    return VK_NULL_HANDLE;
+}
+
+bool pipeline_registry::is_ready(pipeline_id id) const
+{
+    return id < m_entries.size() && m_entries[id].state == entry_state::ready;
+}
+
+uint32_t pipeline_registry::get_pending_count() const
+{
+    return m_pending;
+}
+
+bool pipeline_registry::wait(pipeline_id id)
+{
+    if (id >= m_entries.size())
+        return false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        apply_results_locked();
+        if (m_entries[id].state != entry_state::pending)
+            break;
+        m_done_cv.wait(lock);
+    }
+    return m_entries[id].state == entry_state::ready;
+}
+
+void pipeline_registry::wait_all()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        apply_results_locked();
+        if (m_pending == 0)
+            break;
+        m_done_cv.wait(lock);
+    }
+}
+
+void pipeline_registry::replace(pipeline_id id, VkPipeline pipeline)
+{
+    if (id >= m_entries.size())
+    {
+        vkDestroyPipeline(m_context->get_device(), pipeline, nullptr);
+        return;
+    }
+
+    entry& e = m_entries[id];
+    m_context->get_deletion_queue()->destroy_pipeline(e.pipeline);
+    if (e.state == entry_state::pending)
+    {
+        m_pending--;
+    }
+    e.pipeline = pipeline;
+    e.state = entry_state::ready;
+}
+
+void pipeline_registry::worker_loop()
+{
+    JUCE_PROFILE_THREAD("pipeline compile");
+
+    for (;;)
+    {
+        compile_job job;
+        pipeline_target target;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_job_cv.wait(lock, [this]()
+                          { return m_stop || !m_jobs.empty(); });
+            if (m_stop)
+                return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            target = m_job_target;
+            m_running++;
+        }
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        try
+        {
+            JUCE_PROFILE_SCOPE("pipeline_registry::compile");
+            pipeline = build_pipeline(job.desc, target);
+        }
+        catch (const std::exception& e)
+        {
+            log_error("Failed to compile pipeline '%s': %s", job.desc.name.c_str(), e.what());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running--;
+            m_results.push_back({job.id, job.generation, pipeline});
+        }
+        m_done_cv.notify_all();
+    }
+}
+
+VkPipeline pipeline_registry::build_pipeline(const pipeline_desc& desc, const pipeline_target& target) const
+{
+    VkDevice device = m_context->get_device();
+    bool depth_only = desc.fragment_shader.empty();
+
+    VkPipelineShaderStageCreateInfo stages[2]{};
+    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stages[0].module = load_shader_module(device, desc.vertex_shader);
+    stages[0].pName = "main";
+    if (!depth_only)
+    {
+        try
+        {
+            stages[1].module = load_shader_module(device, desc.fragment_shader);
+        }
+        catch (...)
+        {
+            vkDestroyShaderModule(device, stages[0].module, nullptr);
+            throw;
+        }
+        stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[1].pName = "main";
+    }
+
+    VkPipelineVertexInputStateCreateInfo vertex_input_info{};
+    vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertex_input_info.vertexBindingDescriptionCount = 0;
+    vertex_input_info.vertexAttributeDescriptionCount = 0;
+
+    VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    input_assembly.topology = desc.topology;
+    input_assembly.primitiveRestartEnable = VK_FALSE;
+
+    // Viewport and scissor are set per frame so a resize does not invalidate the pipeline
+    VkPipelineViewportStateCreateInfo viewport_state{};
+    viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport_state.viewportCount = 1;
+    viewport_state.scissorCount = 1;
+
+    VkDynamicState dynamic_states[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamic_state{};
+    dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state.dynamicStateCount = 2;
+    dynamic_state.pDynamicStates = dynamic_states;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = desc.cull_mode;
+    rasterizer.frontFace = desc.front_face;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = target.samples;
+
+    VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+    depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depth_stencil.depthTestEnable = VK_TRUE;
+    depth_stencil.depthWriteEnable = desc.depth_write ? VK_TRUE : VK_FALSE;
+    depth_stencil.depthCompareOp = desc.depth_compare;
+    depth_stencil.depthBoundsTestEnable = VK_FALSE;
+    depth_stencil.stencilTestEnable = VK_FALSE;
+
+    VkPipelineColorBlendAttachmentState color_blend_attachment{};
+    color_blend_attachment.colorWriteMask = depth_only ? 0 : VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    color_blend_attachment.blendEnable = desc.alpha_blend ? VK_TRUE : VK_FALSE;
+    color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+    color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo color_blending{};
+    color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    color_blending.logicOpEnable = VK_FALSE;
+    color_blending.attachmentCount = 1;
+    color_blending.pAttachments = &color_blend_attachment;
+
+    VkGraphicsPipelineCreateInfo pipeline_info{};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipeline_info.stageCount = depth_only ? 1 : 2;
+    pipeline_info.pStages = stages;
+    pipeline_info.pVertexInputState = &vertex_input_info;
+    pipeline_info.pInputAssemblyState = &input_assembly;
+    pipeline_info.pViewportState = &viewport_state;
+    pipeline_info.pRasterizationState = &rasterizer;
+    pipeline_info.pMultisampleState = &multisampling;
+    pipeline_info.pDepthStencilState = &depth_stencil;
+    pipeline_info.pColorBlendState = &color_blending;
+    pipeline_info.pDynamicState = &dynamic_state;
+    pipeline_info.layout = desc.layout != VK_NULL_HANDLE ? desc.layout : target.layout;
+    pipeline_info.renderPass = target.render_pass;
+    pipeline_info.subpass = 0;
+
+    VkPipelineRenderingCreateInfoKHR rendering_info{};
+    if (target.dynamic_rendering)
+    {
+        rendering_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+        rendering_info.colorAttachmentCount = 1;
+        rendering_info.pColorAttachmentFormats = &target.color_format;
+        rendering_info.depthAttachmentFormat = target.depth_format;
+        if (has_stencil_component(target.depth_format))
+        {
+            rendering_info.stencilAttachmentFormat = target.depth_format;
+        }
+        pipeline_info.renderPass = VK_NULL_HANDLE;
+        pipeline_info.pNext = &rendering_info;
+    }
+
+    // The cache is internally synchronized, so every worker shares it
+    VkPipeline pipeline;
+    VkResult result = vkCreateGraphicsPipelines(device, m_context->get_pipeline_cache(), 1, &pipeline_info, nullptr, &pipeline);
+
+    vkDestroyShaderModule(device, stages[1].module, nullptr);
+    vkDestroyShaderModule(device, stages[0].module, nullptr);
+
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create graphics pipeline: " + desc.name);
+    }
+    return pipeline;
+}
+
+} // namespace juce
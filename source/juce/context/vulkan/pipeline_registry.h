@@ -0,0 +1,159 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+// 등록된 모든 파이프라인이 공유하는 출력 상태 (바뀌면 전부 다시 컴파일)
+struct pipeline_target
+{
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    VkRenderPass render_pass = VK_NULL_HANDLE; // dynamic rendering이면 무시
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    VkFormat color_format = VK_FORMAT_UNDEFINED;
+    VkFormat depth_format = VK_FORMAT_UNDEFINED;
+    bool dynamic_rendering = false;
+};
+
+// 파이프라인 상태 설명 (재질 / 패스 변형마다 하나)
+// - viewport / scissor는 항상 dynamic
+struct pipeline_desc
+{
+    std::string name;
+    std::string vertex_shader;   // .spv 경로
+    std::string fragment_shader; // 비어 있으면 depth only (color 쓰기 없음)
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkCullModeFlags cull_mode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace front_face = VK_FRONT_FACE_CLOCKWISE;
+    bool depth_write = true;
+    VkCompareOp depth_compare = VK_COMPARE_OP_GREATER; // reverse-Z
+    bool alpha_blend = false;
+    VkPipelineLayout layout = VK_NULL_HANDLE; // 있으면 target의 layout 대신 사용 (자체 descriptor를 쓰는 시스템)
+};
+
+using pipeline_id = uint32_t;
+
+/**
+ * pipeline registry
+ * - 관리: 파이프라인 상태 설명 목록, 컴파일 워커 스레드, 설명별 VkPipeline
+ * - set_target 시 등록된 전부를 워커들이 pipeline cache로 병렬 컴파일 (fallback이 맨 앞)
+ * - 아직 컴파일 중이거나 실패한 파이프라인을 요청하면 fallback을 돌려줌
+ * - 완료 결과는 update()에서 반영 (메인 스레드), get()은 lock 없이 읽음
+ */
+class pipeline_registry
+{
+public:
+    struct config
+    {
+        uint32_t worker_count = 0; // 0이면 코어 수 - 1 (최소 1)
+    };
+
+    pipeline_registry();
+    ~pipeline_registry();
+
+    bool initialize(vk_context* context, const config& cfg);
+    // 워커 종료, 모든 파이프라인 파괴 (device idle 이후)
+    void cleanup();
+
+    // 설명 등록 (컴파일은 다음 set_target부터), 같은 이름이면 기존 id 반환
+    // - target이 없을 때 같은 이름을 다시 등록하면 설명을 교체 (소유자가 layout을 다시 만든 경우)
+    pipeline_id register_pipeline(const pipeline_desc& desc);
+    const pipeline_desc& get_desc(pipeline_id id) const;
+    uint32_t get_pipeline_count() const;
+
+    // 컴파일 중인 파이프라인 대신 쓸 파이프라인 (가장 먼저 컴파일)
+    void set_fallback(pipeline_id id);
+
+    // 출력 상태 교체: 이전 상태로 컴파일 중인 작업을 기다린 뒤 전부 다시 컴파일
+    void set_target(const pipeline_target& target);
+    // 현재 상태 해제 (그 layout / render pass를 파괴하기 전에 호출), 기존 파이프라인은 deletion queue로
+    void release_target();
+    const pipeline_target& get_target() const;
+
+    // 프레임 경계에서 호출: 완료된 컴파일 결과 반영
+    void update();
+
+    // 준비된 파이프라인, 아니면 fallback, 그것도 없으면 VK_NULL_HANDLE
+    VkPipeline get(pipeline_id id) const;
+    bool is_ready(pipeline_id id) const;
+    uint32_t get_pending_count() const;
+
+    // 해당 파이프라인의 컴파일이 끝날 때까지 대기 (결과도 반영됨), 실패하면 false
+    bool wait(pipeline_id id);
+    void wait_all();
+
+    // 어느 스레드에서든: 설명 + 출력 상태로 파이프라인 하나 생성 (실패 시 std::runtime_error)
+    VkPipeline build_pipeline(const pipeline_desc& desc, const pipeline_target& target) const;
+    // 외부에서 다시 만든 파이프라인으로 교체 (hot-reload), 이전 것은 deletion queue로
+    void replace(pipeline_id id, VkPipeline pipeline);
+
+private:
+    enum class entry_state
+    {
+        idle,     // target 없음
+        pending,  // 대기열 또는 컴파일 중
+        ready,
+        failed,
+    };
+
+    struct entry
+    {
+        pipeline_desc desc;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        entry_state state = entry_state::idle;
+    };
+
+    struct compile_job
+    {
+        pipeline_id id;
+        uint64_t generation;
+        pipeline_desc desc;
+    };
+
+    struct compile_result
+    {
+        pipeline_id id;
+        uint64_t generation;
+        VkPipeline pipeline; // 실패 시 VK_NULL_HANDLE
+    };
+
+    void worker_loop();
+    // 메인 스레드, m_mutex 보유 중
+    void apply_results_locked();
+
+    vk_context* m_context; // 소유하지 않음
+
+    // 메인 스레드 전용
+    std::vector<entry> m_entries;
+    pipeline_id m_fallback;
+    pipeline_target m_target;
+    bool m_has_target;
+    uint32_t m_pending;
+    std::chrono::steady_clock::time_point m_compile_start;
+
+    // 워커와 공유
+    std::vector<std::thread> m_workers;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_job_cv;  // 새 작업 / 종료
+    std::condition_variable m_done_cv; // 작업 완료
+    std::deque<compile_job> m_jobs;
+    std::vector<compile_result> m_results;
+    pipeline_target m_job_target; // 현재 generation의 출력 상태 (워커가 복사해 사용)
+    uint64_t m_generation;
+    uint32_t m_running;
+    bool m_stop;
+};
+
+} // namespace juce
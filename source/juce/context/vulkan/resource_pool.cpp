@@ -0,0 +1,209 @@
+// resource_pool은 "handle 뒤에 있는 실제 GPU 객체"를 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "resource_pool.h"
+#include "vk_context.h"
+#include "deletion_queue.h"
+
+#include <stdexcept>
+
+namespace juce
+{
+
+resource_pool::resource_pool()
+    : m_context(nullptr)
+{
+}
+
+resource_pool::~resource_pool()
+{
+    cleanup();
+}
+
+void resource_pool::initialize(vk_context* context)
+{
+    m_context = context;
+}
+
+void resource_pool::cleanup()
+{
+    if (!m_context)
+        return;
+
+    VkDevice device = m_context->get_device();
+    memory_stats* memory = m_context->get_memory_stats();
+    for (gpu_buffer& buffer : m_buffers)
+    {
+        vkDestroyBuffer(device, buffer.buffer, nullptr);
+        memory->free(buffer.memory);
+    }
+    for (gpu_image& image : m_images)
+    {
+        vkDestroyImageView(device, image.view, nullptr);
+        vkDestroyImage(device, image.image, nullptr);
+        memory->free(image.memory);
+    }
+    m_buffers.clear();
+    m_images.clear();
+}
+
+buffer_handle resource_pool::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+{
+    VkDevice device = m_context->get_device();
+    gpu_buffer buffer;
+    buffer.size = size;
+
+    try
+    {
+        VkBufferCreateInfo buffer_info{};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size;
+        buffer_info.usage = usage;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(device, &buffer_info, nullptr, &buffer.buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create buffer!");
+        }
+
+        VkMemoryRequirements mem_requirements;
+        vkGetBufferMemoryRequirements(device, buffer.buffer, &mem_requirements);
+
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = mem_requirements.size;
+        alloc_info.memoryTypeIndex = m_context->find_memory_type(mem_requirements.memoryTypeBits, properties);
+
+        // Host-visible transfer sources are upload buffers; everything else is read by the GPU
+        bool staging = (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        if (m_context->get_memory_stats()->allocate(alloc_info, staging ? memory_category::staging : memory_category::buffer, &buffer.memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate buffer memory!");
+        }
+        vkBindBufferMemory(device, buffer.buffer, buffer.memory, 0);
+
+        if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            vkMapMemory(device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &buffer.mapped);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log_error("Failed to create buffer (%llu bytes): %s", static_cast<unsigned long long>(size), e.what());
+        vkDestroyBuffer(device, buffer.buffer, nullptr);
+        m_context->get_memory_stats()->free(buffer.memory);
+        return buffer_handle{};
+    }
+
+    return m_buffers.insert(buffer);
+}
+
+image_handle resource_pool::create_image(const VkImageCreateInfo& image_info, VkImageAspectFlags aspect, VkMemoryPropertyFlags properties)
+{
+    VkDevice device = m_context->get_device();
+    gpu_image image;
+    image.format = image_info.format;
+    image.extent = image_info.extent;
+    image.mip_levels = image_info.mipLevels;
+    image.samples = image_info.samples;
+
+    try
+    {
+        if (vkCreateImage(device, &image_info, nullptr, &image.image) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create image!");
+        }
+
+        VkMemoryRequirements mem_requirements;
+        vkGetImageMemoryRequirements(device, image.image, &mem_requirements);
+
+        // Lazily allocated memory only exists on tile-based GPUs; elsewhere plain device memory is used
+        uint32_t memory_type;
+        try
+        {
+            memory_type = m_context->find_memory_type(mem_requirements.memoryTypeBits, properties);
+        }
+        catch (const std::runtime_error&)
+        {
+            if (!(properties & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT))
+                throw;
+            memory_type = m_context->find_memory_type(mem_requirements.memoryTypeBits, properties & ~VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+        }
+
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = mem_requirements.size;
+        alloc_info.memoryTypeIndex = memory_type;
+
+        const VkImageUsageFlags attachment_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        memory_category category = (image_info.usage & attachment_usage) ? memory_category::attachment : memory_category::texture;
+        if (m_context->get_memory_stats()->allocate(alloc_info, category, &image.memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate image memory!");
+        }
+        vkBindImageMemory(device, image.image, image.memory, 0);
+
+        VkImageViewCreateInfo view_info{};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.image = image.image;
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = image_info.format;
+        view_info.subresourceRange.aspectMask = aspect;
+        view_info.subresourceRange.baseMipLevel = 0;
+        view_info.subresourceRange.levelCount = image_info.mipLevels;
+        view_info.subresourceRange.baseArrayLayer = 0;
+        view_info.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &view_info, nullptr, &image.view) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create image view!");
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log_error("Failed to create image (%ux%u): %s", image_info.extent.width, image_info.extent.height, e.what());
+        vkDestroyImageView(device, image.view, nullptr);
+        vkDestroyImage(device, image.image, nullptr);
+        m_context->get_memory_stats()->free(image.memory);
+        return image_handle{};
+    }
+
+    return m_images.insert(image);
+}
+
+void resource_pool::release(buffer_handle h)
+{
+    gpu_buffer buffer;
+    if (!m_buffers.remove(h, &buffer))
+        return;
+
+    // Freeing the memory implicitly unmaps it
+    deletion_queue* queue = m_context->get_deletion_queue();
+    queue->destroy_buffer(buffer.buffer);
+    queue->free_memory(buffer.memory);
+}
+
+void resource_pool::release(image_handle h)
+{
+    gpu_image image;
+    if (!m_images.remove(h, &image))
+        return;
+
+    deletion_queue* queue = m_context->get_deletion_queue();
+    queue->destroy_image_view(image.view);
+    queue->destroy_image(image.image);
+    queue->free_memory(image.memory);
+}
+
+const gpu_buffer* resource_pool::get(buffer_handle h) const
+{
+    return m_buffers.get(h);
+}
+
+const gpu_image* resource_pool::get(image_handle h) const
+{
+    return m_images.get(h);
+}
+
+} // namespace juce
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+#include <juce/core/handle_pool.h>
+
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+struct gpu_buffer
+{
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    void* mapped = nullptr; // HOST_VISIBLE일 때만 persistently mapped
+};
+
+struct gpu_image
+{
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent3D extent{};
+    uint32_t mip_levels = 1;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+using buffer_handle = handle<gpu_buffer>;
+using image_handle = handle<gpu_image>;
+
+/**
+ * GPU 리소스 pool
+ * - 관리: buffer / image를 generational handle로 발급, dense 배열에 보관
+ * - release: handle은 즉시 무효, 실제 파괴는 deletion queue가 GPU 사용 완료 후 수행
+ */
+class resource_pool
+{
+public:
+    resource_pool();
+    ~resource_pool();
+
+    void initialize(vk_context* context);
+    // 살아 있는 리소스를 즉시 파괴 (device idle 이후에만 호출)
+    void cleanup();
+
+    buffer_handle create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+    // view는 aspect로 생성, 실패 시 무효 handle 반환
+    // LAZILY_ALLOCATED 요청 시 해당 메모리 타입이 없으면 그 비트만 빼고 할당
+    image_handle create_image(const VkImageCreateInfo& image_info, VkImageAspectFlags aspect, VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    void release(buffer_handle h);
+    void release(image_handle h);
+
+    // 무효 / 해제된 handle이면 nullptr
+    const gpu_buffer* get(buffer_handle h) const;
+    const gpu_image* get(image_handle h) const;
+
+private:
+    vk_context* m_context; // 소유하지 않음
+    handle_pool<gpu_buffer> m_buffers;
+    handle_pool<gpu_image> m_images;
+};
+
+} // namespace juce
@@ -0,0 +1,133 @@
+// shader_module은 "SPIR-V 파일을 셰이더 모듈로 만드는 것"을 책임
+#include <juce/core/win32_config.h>
+
+#include "shader_module.h"
+
+#include <juce/core/startup_trace.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace juce
+{
+
+namespace fs = std::filesystem;
+
+struct spirv_prefetch
+{
+    struct file
+    {
+        fs::file_time_type time;
+        std::vector<char> code;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, file> files; // key: 정규화된 경로
+    std::future<void> task;
+};
+
+static spirv_prefetch& get_prefetch()
+{
+    static spirv_prefetch prefetch;
+    return prefetch;
+}
+
+static std::string prefetch_key(const fs::path& path)
+{
+    return path.lexically_normal().generic_string();
+}
+
+static bool read_file(const std::string& filename, std::vector<char>& code)
+{
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    code.resize((size_t)file.tellg());
+    file.seekg(0);
+    file.read(code.data(), code.size());
+    return static_cast<bool>(file);
+}
+
+void prefetch_spirv_files(const std::string& directory)
+{
+    spirv_prefetch& prefetch = get_prefetch();
+    prefetch.task = std::async(std::launch::async, [directory, &prefetch]()
+                               {
+        startup_phase phase("prefetch_spirv_files");
+
+        std::error_code ec;
+        for (const fs::directory_entry& entry : fs::directory_iterator(directory, ec))
+        {
+            if (entry.path().extension() != ".spv")
+                continue;
+
+            spirv_prefetch::file file;
+            file.time = fs::last_write_time(entry.path(), ec);
+            if (ec || !read_file(entry.path().string(), file.code))
+                continue;
+
+            std::lock_guard<std::mutex> lock(prefetch.mutex);
+            prefetch.files[prefetch_key(entry.path())] = std::move(file);
+        } });
+}
+
+std::vector<char> read_spirv_file(const std::string& filename)
+{
+    std::vector<char> code;
+    bool prefetched = false;
+    {
+        // Only valid while the file on disk is still the one that was read
+        spirv_prefetch& prefetch = get_prefetch();
+        std::lock_guard<std::mutex> lock(prefetch.mutex);
+        auto it = prefetch.files.find(prefetch_key(filename));
+        std::error_code ec;
+        if (it != prefetch.files.end() && fs::last_write_time(filename, ec) == it->second.time && !ec)
+        {
+            code = it->second.code;
+            prefetched = true;
+        }
+    }
+
+    if (!prefetched && !read_file(filename, code))
+    {
+        throw std::runtime_error("failed to open file: " + filename);
+    }
+
+    // A file caught mid-write (hot-reload) must not reach the driver
+    const uint32_t spirv_magic = 0x07230203;
+    uint32_t magic = 0;
+    if (code.size() >= sizeof(magic))
+    {
+        std::memcpy(&magic, code.data(), sizeof(magic));
+    }
+    if (code.size() < 20 || code.size() % 4 != 0 || magic != spirv_magic)
+    {
+        throw std::runtime_error("invalid SPIR-V file: " + filename);
+    }
+    return code;
+}
+
+VkShaderModule load_shader_module(VkDevice device, const std::string& filename)
+{
+    std::vector<char> code = read_spirv_file(filename);
+
+    VkShaderModuleCreateInfo create_info{};
+    create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    create_info.codeSize = code.size();
+    create_info.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shader_module;
+    if (vkCreateShaderModule(device, &create_info, nullptr, &shader_module) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create shader module: " + filename);
+    }
+    return shader_module;
+}
+
+} // namespace juce
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <string>
+#include <vector>
+
+namespace juce
+{
+
+// 디렉터리의 .spv를 백그라운드로 미리 읽어 둠 (시작 시 device 생성과 겹치게)
+// - read_spirv_file은 파일 시각이 같을 때만 미리 읽은 내용을 사용
+void prefetch_spirv_files(const std::string& directory);
+
+// SPIR-V 파일 읽기 (실패 / 잘린 파일 / magic 불일치 시 std::runtime_error)
+std::vector<char> read_spirv_file(const std::string& filename);
+
+// 파일에서 셰이더 모듈 생성 (실패 시 std::runtime_error), 파이프라인 생성 후 바로 파괴해도 됨
+VkShaderModule load_shader_module(VkDevice device, const std::string& filename);
+
+} // namespace juce
@@ -0,0 +1,365 @@
+// shader_reloader는 "바뀐 셰이더를 멈춤 없이 반영하는 것"을 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+#include <juce/core/profiler.h>
+
+#include "shader_reloader.h"
+#include "vk_context.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace juce
+{
+
+namespace fs = std::filesystem;
+
+static bool is_stage_source(const fs::path& path)
+{
+    fs::path ext = path.extension();
+    return ext == ".vert" || ext == ".frag" || ext == ".comp";
+}
+
+static bool is_include_source(const fs::path& path)
+{
+    return path.extension() == ".glsl";
+}
+
+shader_reloader::shader_reloader()
+    : m_context(nullptr), m_next_id(0), m_epoch(0), m_stop(false)
+{
+}
+
+shader_reloader::~shader_reloader()
+{
+    stop();
+
+    // Built but never swapped in: no frame has recorded them
+    for (reload_result& result : m_results)
+    {
+        destroy_pipelines(result.pipelines);
+    }
+    m_results.clear();
+}
+
+bool shader_reloader::start(vk_context* context, const config& cfg)
+{
+    if (m_worker.joinable())
+        return true;
+
+    if (!context)
+    {
+        log_error("Invalid arguments provided to shader_reloader::start");
+        return false;
+    }
+
+    m_context = context;
+    m_config = cfg;
+    m_config.poll_interval_ms = std::max(1u, m_config.poll_interval_ms);
+
+    // Only changes after this point trigger a reload
+    m_sources.clear();
+    if (!m_config.source_dir.empty())
+    {
+        std::error_code ec;
+        for (const fs::directory_entry& entry : fs::directory_iterator(m_config.source_dir, ec))
+        {
+            if (is_stage_source(entry.path()) || is_include_source(entry.path()))
+            {
+                m_sources.emplace_back(entry.path(), fs::last_write_time(entry.path(), ec));
+            }
+        }
+        if (ec)
+        {
+            log_warn("Cannot watch shader sources in %s, only SPIR-V changes are picked up", m_config.source_dir.c_str());
+            m_config.source_dir.clear();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::error_code ec;
+        for (target_entry& entry : m_targets)
+        {
+            for (size_t i = 0; i < entry.target.spirv_files.size(); i++)
+            {
+                entry.times[i] = fs::last_write_time(entry.target.spirv_files[i], ec);
+            }
+        }
+        m_stop = false;
+    }
+    m_worker = std::thread(&shader_reloader::worker_loop, this);
+
+    log_info("Shader hot-reload: watching %s%s%s", m_config.spirv_dir.c_str(), m_config.source_dir.empty() ? "" : " and ", m_config.source_dir.c_str());
+    return true;
+}
+
+void shader_reloader::stop()
+{
+    if (!m_worker.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_worker.join();
+}
+
+bool shader_reloader::is_running() const
+{
+    return m_worker.joinable();
+}
+
+uint32_t shader_reloader::add_target(reload_target target)
+{
+    target_entry entry;
+    entry.id = m_next_id++;
+    entry.times.resize(target.spirv_files.size());
+
+    std::error_code ec;
+    for (size_t i = 0; i < target.spirv_files.size(); i++)
+    {
+        entry.times[i] = fs::last_write_time(target.spirv_files[i], ec);
+    }
+    entry.target = std::move(target);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_targets.push_back(std::move(entry));
+    return m_targets.back().id;
+}
+
+void shader_reloader::clear_targets()
+{
+    // Waits out a build in progress: its captured handles are about to be destroyed
+    std::lock_guard<std::mutex> build_lock(m_build_mutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (reload_result& result : m_results)
+    {
+        destroy_pipelines(result.pipelines);
+    }
+    m_results.clear();
+    m_targets.clear();
+    m_epoch++;
+}
+
+void shader_reloader::apply_pending()
+{
+    std::deque<reload_result> results;
+    uint64_t epoch;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_results.empty())
+            return;
+        results.swap(m_results);
+        epoch = m_epoch;
+    }
+
+    // Targets are only added or cleared on this thread, so they can be read without the lock
+    for (reload_result& result : results)
+    {
+        auto it = std::find_if(m_targets.begin(), m_targets.end(), [&](const target_entry& entry)
+                               { return entry.id == result.id; });
+        if (result.epoch != epoch || it == m_targets.end())
+        {
+            destroy_pipelines(result.pipelines);
+            continue;
+        }
+
+        it->target.swap(result.pipelines);
+        log_info("Shader hot-reload: swapped %zu pipeline(s)", result.pipelines.size());
+    }
+}
+
+void shader_reloader::worker_loop()
+{
+    JUCE_PROFILE_THREAD("shader reloader");
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, std::chrono::milliseconds(m_config.poll_interval_ms), [this]()
+                          { return m_stop; });
+            if (m_stop)
+                return;
+        }
+
+        // Recompiled .spv files are picked up by the target scan right after
+        compile_changed_sources();
+
+        std::vector<std::pair<uint32_t, reload_target>> changed;
+        uint64_t epoch;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            epoch = m_epoch;
+            std::error_code ec;
+            for (target_entry& entry : m_targets)
+            {
+                bool dirty = false;
+                for (size_t i = 0; i < entry.target.spirv_files.size(); i++)
+                {
+                    fs::file_time_type time = fs::last_write_time(entry.target.spirv_files[i], ec);
+                    if (!ec && time != entry.times[i])
+                    {
+                        entry.times[i] = time;
+                        dirty = true;
+                    }
+                }
+                if (dirty)
+                {
+                    changed.emplace_back(entry.id, entry.target);
+                }
+            }
+        }
+
+        for (auto& [id, target] : changed)
+        {
+            std::lock_guard<std::mutex> build_lock(m_build_mutex);
+            {
+                // Cleared while we were scanning: the captured state may already be gone
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_stop || m_epoch != epoch)
+                    break;
+            }
+
+            reload_result result;
+            result.id = id;
+            result.epoch = epoch;
+            try
+            {
+                JUCE_PROFILE_SCOPE("shader_reloader::build");
+                result.pipelines = target.build();
+            }
+            catch (const std::exception& e)
+            {
+                // A half-written or broken shader keeps the previous pipeline alive
+                log_warn("Shader hot-reload failed, keeping the previous pipeline: %s", e.what());
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(std::move(result));
+        }
+    }
+}
+
+void shader_reloader::compile_changed_sources()
+{
+    if (m_config.source_dir.empty())
+        return;
+
+    std::vector<fs::path> stale;
+    bool include_changed = false;
+
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(m_config.source_dir, ec))
+    {
+        const fs::path& path = entry.path();
+        bool stage = is_stage_source(path);
+        if (!stage && !is_include_source(path))
+            continue;
+
+        fs::file_time_type time = fs::last_write_time(path, ec);
+        if (ec)
+            continue;
+
+        auto it = std::find_if(m_sources.begin(), m_sources.end(), [&](const auto& source)
+                               { return source.first == path; });
+        if (it == m_sources.end())
+        {
+            m_sources.emplace_back(path, time);
+        }
+        else if (it->second != time)
+        {
+            it->second = time;
+        }
+        else
+        {
+            continue;
+        }
+
+        if (stage)
+        {
+            stale.push_back(path);
+        }
+        else
+        {
+            include_changed = true;
+        }
+    }
+
+    // Include dependencies are not tracked per file, so a shared header rebuilds every stage
+    if (include_changed)
+    {
+        stale.clear();
+        for (const auto& source : m_sources)
+        {
+            if (is_stage_source(source.first))
+            {
+                stale.push_back(source.first);
+            }
+        }
+    }
+
+    for (const fs::path& source : stale)
+    {
+        compile_source(source);
+    }
+}
+
+bool shader_reloader::compile_source(const fs::path& source)
+{
+    if (m_config.glslc.empty())
+        return false;
+
+    fs::path output = fs::path(m_config.spirv_dir) / (source.filename().string() + ".spv");
+    fs::path temp = output;
+    temp += ".tmp";
+
+    // Same flags as the build; compile to a temporary so the watcher never sees a partial .spv
+    std::string command = "\"" + m_config.glslc + "\" --target-env=vulkan1.2 -O \"" + source.string() + "\" -o \"" + temp.string() + "\"";
+#ifdef _WIN32
+    // cmd /c strips the outermost quotes
+    command = "\"" + command + "\"";
+#endif
+
+    std::error_code ec;
+    fs::create_directories(m_config.spirv_dir, ec);
+    if (std::system(command.c_str()) != 0)
+    {
+        log_warn("glslc failed for %s", source.filename().string().c_str());
+        fs::remove(temp, ec);
+        return false;
+    }
+
+    fs::rename(temp, output, ec);
+    if (ec)
+    {
+        log_warn("Failed to replace %s: %s", output.string().c_str(), ec.message().c_str());
+        fs::remove(temp, ec);
+        return false;
+    }
+
+    log_info("Shader hot-reload: recompiled %s", source.filename().string().c_str());
+    return true;
+}
+
+void shader_reloader::destroy_pipelines(std::vector<VkPipeline>& pipelines)
+{
+    // Never recorded into a command buffer, so there is nothing to wait for
+    if (m_context)
+    {
+        for (VkPipeline pipeline : pipelines)
+        {
+            vkDestroyPipeline(m_context->get_device(), pipeline, nullptr);
+        }
+    }
+    pipelines.clear();
+}
+
+} // namespace juce
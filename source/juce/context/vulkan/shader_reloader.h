@@ -0,0 +1,104 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <functional>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+// hot-reload 대상: 같은 셰이더에서 만든 파이프라인 묶음 (함께 재생성, 함께 교체)
+struct reload_target
+{
+    std::vector<std::string> spirv_files; // 감시할 .spv
+    // 워커 스레드에서 호출, 실패 시 std::runtime_error (만든 것은 스스로 정리)
+    // - 캡처한 상태는 값이어야 함: 호출 중에도 메인 스레드는 프레임을 계속 그림
+    std::function<std::vector<VkPipeline>()> build;
+    // 메인 스레드, 프레임 경계에서 호출: 새 파이프라인을 넘겨받고 이전 것은 deletion queue로
+    std::function<void(std::vector<VkPipeline>&)> swap;
+};
+
+/**
+ * shader hot-reload
+ * - 관리: 셰이더 소스 / SPIR-V 감시 워커 스레드, 백그라운드 파이프라인 재생성
+ * - 소스(.vert/.frag/.comp)가 바뀌면 glslc로 .spv를 다시 만들고 (.glsl include가 바뀌면 전부),
+ *   .spv가 바뀌면 그 파일을 쓰는 대상을 pipeline cache로 재생성
+ * - 완료된 결과는 apply_pending()에서 교체: GPU 대기 없이 다음 프레임부터 새 파이프라인 사용
+ * - 컴파일 / 생성이 실패하면 경고만 남기고 이전 파이프라인 유지
+ */
+class shader_reloader
+{
+public:
+    struct config
+    {
+        uint32_t poll_interval_ms = 250;
+        std::string spirv_dir = "shaders"; // 런타임 .spv 위치 (작업 디렉터리 기준)
+        std::string source_dir;            // 비어 있으면 소스 감시 / 재컴파일 안 함
+        std::string glslc;                 // glslc 실행 파일 경로
+    };
+
+    shader_reloader();
+    ~shader_reloader();
+
+    // 감시 스레드 시작 / 중지 (대상 목록은 유지)
+    bool start(vk_context* context, const config& cfg);
+    void stop();
+    bool is_running() const;
+
+    // 대상 등록 (id 반환), 현재 파일 시각을 기준으로 이후 변경만 반영
+    uint32_t add_target(reload_target target);
+    // 대상 전체 제거: 진행 중인 재생성이 끝날 때까지 대기, 아직 교체되지 않은 결과는 파괴
+    // - 대상이 캡처한 render pass / layout을 파괴하기 전에 호출
+    void clear_targets();
+
+    // 프레임 경계에서 호출 (메인 스레드): 완료된 재생성 결과를 교체
+    void apply_pending();
+
+private:
+    struct target_entry
+    {
+        uint32_t id;
+        reload_target target;
+        std::vector<std::filesystem::file_time_type> times;
+    };
+
+    struct reload_result
+    {
+        uint32_t id;
+        uint64_t epoch;
+        std::vector<VkPipeline> pipelines;
+    };
+
+    void worker_loop();
+    void compile_changed_sources();
+    bool compile_source(const std::filesystem::path& source);
+    void destroy_pipelines(std::vector<VkPipeline>& pipelines);
+
+    vk_context* m_context; // 소유하지 않음
+    config m_config;
+
+    // 워커만 사용: 소스 파일별 마지막 수정 시각
+    std::vector<std::pair<std::filesystem::path, std::filesystem::file_time_type>> m_sources;
+
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::mutex m_build_mutex; // 재생성 중 보유, clear_targets가 끝나기를 기다림
+    std::vector<target_entry> m_targets;
+    std::deque<reload_result> m_results;
+    uint32_t m_next_id;
+    uint64_t m_epoch; // clear_targets마다 증가, 이전 epoch의 결과는 버림
+    bool m_stop;
+};
+
+} // namespace juce
@@ -13,8 +13,11 @@
 
 namespace juce
 {
+// Surface formats and present modes of one surface
+static const size_t SUPPORT_SCRATCH_BYTES = 16 * 1024;
+
 swapchain::swapchain()
-    : m_swapchain(VK_NULL_HANDLE), m_format{}, m_extent{}, m_depth_image(VK_NULL_HANDLE), m_depth_image_memory(VK_NULL_HANDLE), m_depth_image_view(VK_NULL_HANDLE), m_context(nullptr), m_width(0), m_height(0)
+    : m_swapchain(VK_NULL_HANDLE), m_format{}, m_extent{}, m_depth_format(VK_FORMAT_UNDEFINED), m_samples(VK_SAMPLE_COUNT_1_BIT), m_context(nullptr), m_width(0), m_height(0), m_frame_config(get_frame_config(frame_profile::balanced)), m_scratch(SUPPORT_SCRATCH_BYTES)
 {
 }
 
@@ -41,7 +44,7 @@ bool swapchain::initialize(vk_context* context, uint32_t width, uint32_t height)
             return false;
         if (!create_image_views())
             return false;
-        if (!create_depth_resources())
+        if (!create_render_targets())
             return false;
     }
     catch (const std::exception& e)
@@ -60,53 +63,33 @@ void swapchain::cleanup()
     if (!m_context || m_context->get_device() == VK_NULL_HANDLE)
         return;
 
-    VkDevice device = m_context->get_device();
-    vkDeviceWaitIdle(device);
+    release_image_resources();
+
+    // Destroyed once the frames that presented from it have completed
+    m_context->get_deletion_queue()->destroy_swapchain(m_swapchain);
+    m_swapchain = VK_NULL_HANDLE;
+}
+
+void swapchain::release_image_resources()
+{
+    deletion_queue* queue = m_context->get_deletion_queue();
 
     // Framebuffers
-    for (auto fb : m_framebuffers)
-    {
-        if (fb != VK_NULL_HANDLE)
-        {
-            vkDestroyFramebuffer(device, fb, nullptr);
-        }
-    }
-    m_framebuffers.clear();
+    cleanup_framebuffers();
 
-    // Depth resources
-    if (m_depth_image_view != VK_NULL_HANDLE)
-    {
-        vkDestroyImageView(device, m_depth_image_view, nullptr);
-        m_depth_image_view = VK_NULL_HANDLE;
-    }
-    if (m_depth_image != VK_NULL_HANDLE)
-    {
-        vkDestroyImage(device, m_depth_image, nullptr);
-        m_depth_image = VK_NULL_HANDLE;
-    }
-    if (m_depth_image_memory != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(device, m_depth_image_memory, nullptr);
-        m_depth_image_memory = VK_NULL_HANDLE;
-    }
+    // Render targets
+    m_context->get_resources()->release(m_depth_image);
+    m_context->get_resources()->release(m_color_target);
+    m_depth_image = image_handle{};
+    m_color_target = image_handle{};
 
     // Image views
     for (auto image_view : m_image_views)
     {
-        if (image_view != VK_NULL_HANDLE)
-        {
-            vkDestroyImageView(device, image_view, nullptr);
-        }
+        queue->destroy_image_view(image_view);
     }
     m_image_views.clear();
     m_images.clear(); // Image handles are owned by the swapchain, no need to destroy
-
-    // swapchain
-    if (m_swapchain != VK_NULL_HANDLE)
-    {
-        vkDestroySwapchainKHR(device, m_swapchain, nullptr);
-        m_swapchain = VK_NULL_HANDLE;
-    }
 }
 
 bool swapchain::recreate(uint32_t width, uint32_t height)
@@ -120,21 +103,20 @@ bool swapchain::recreate(uint32_t width, uint32_t height)
     m_width = width;
     m_height = height;
 
-    if (m_context && m_context->get_device() != VK_NULL_HANDLE)
-    {
-        vkDeviceWaitIdle(m_context->get_device());
-    }
-
-    // Cleanup old resources before creating new ones
-    cleanup();
+    // Old views and the old swapchain go to the deletion queue; frames still in flight keep using them
+    release_image_resources();
+    VkSwapchainKHR old_swapchain = m_swapchain;
+    m_swapchain = VK_NULL_HANDLE;
 
     try
     {
-        if (!create_swapchain())
+        bool created = create_swapchain(old_swapchain);
+        m_context->get_deletion_queue()->destroy_swapchain(old_swapchain);
+        if (!created)
             return false;
         if (!create_image_views())
             return false;
-        if (!create_depth_resources())
+        if (!create_render_targets())
             return false;
     }
     catch (const std::exception& e)
@@ -147,6 +129,21 @@ bool swapchain::recreate(uint32_t width, uint32_t height)
     return true;
 }
 
+void swapchain::set_frame_config(const frame_config& config)
+{
+    m_frame_config = config;
+}
+
+void swapchain::set_sample_count(VkSampleCountFlagBits samples)
+{
+    m_samples = samples;
+}
+
+void swapchain::set_depth_sampled(bool sampled)
+{
+    m_depth_sampled = sampled;
+}
+
 bool swapchain::create_framebuffers(VkRenderPass renderPass)
 {
     if (renderPass == VK_NULL_HANDLE)
@@ -159,12 +156,18 @@ bool swapchain::create_framebuffers(VkRenderPass renderPass)
 
     for (size_t i = 0; i < m_image_views.size(); i++)
     {
+        // Matches the render pass: [color, depth] or, with MSAA, [msaa color, depth, resolve]
         std::vector<VkImageView> attachments;
-        attachments.push_back(m_image_views[i]);
+        const gpu_image* color_target = m_context->get_resources()->get(m_color_target);
+        attachments.push_back(color_target ? color_target->view : m_image_views[i]);
 
-        if (m_depth_image_view != VK_NULL_HANDLE)
+        if (const gpu_image* depth = m_context->get_resources()->get(m_depth_image))
+        {
+            attachments.push_back(depth->view);
+        }
+        if (color_target)
         {
-            attachments.push_back(m_depth_image_view);
+            attachments.push_back(m_image_views[i]);
         }
 
         VkFramebufferCreateInfo framebufferInfo{};
@@ -187,9 +190,10 @@ bool swapchain::create_framebuffers(VkRenderPass renderPass)
 
 void swapchain::cleanup_framebuffers()
 {
+    deletion_queue* queue = m_context->get_deletion_queue();
     for (auto framebuffer : m_framebuffers)
     {
-        vkDestroyFramebuffer(m_context->get_device(), framebuffer, nullptr);
+        queue->destroy_framebuffer(framebuffer);
     }
     m_framebuffers.clear();
 }
@@ -215,15 +219,16 @@ VkResult swapchain::present_image(VkQueue presentQueue, uint32_t imageIndex, VkS
     return vkQueuePresentKHR(presentQueue, &presentInfo);
 }
 
-bool swapchain::create_swapchain()
+bool swapchain::create_swapchain(VkSwapchainKHR old_swapchain)
 {
-    vk_context::swapchainSupportDetails swapchain_support = m_context->get_swapchain_support();
+    m_scratch.reset();
+    vk_context::swapchainSupportDetails swapchain_support = m_context->get_swapchain_support(m_scratch);
 
     VkSurfaceFormatKHR surface_format = choose_swap_surface_format(swapchain_support.formats);
     VkPresentModeKHR present_mode = choose_swap_present_mode(swapchain_support.present_modes);
     VkExtent2D extent = choose_swap_extent(swapchain_support.capabilities);
 
-    uint32_t image_count = swapchain_support.capabilities.minImageCount + 1;
+    uint32_t image_count = swapchain_support.capabilities.minImageCount + m_frame_config.extra_images;
     if (swapchain_support.capabilities.maxImageCount > 0 &&
         image_count > swapchain_support.capabilities.maxImageCount)
     {
@@ -239,6 +244,12 @@ bool swapchain::create_swapchain()
     create_info.imageExtent = extent;
     create_info.imageArrayLayers = 1;
     create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Frame capture copies presented images into host-visible buffers
+    m_readback = (swapchain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+    if (m_readback)
+    {
+        create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
 
     uint32_t queue_family_indices[] = {
         m_context->get_graphics_queue_family(),
@@ -259,7 +270,7 @@ bool swapchain::create_swapchain()
     create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     create_info.presentMode = present_mode;
     create_info.clipped = VK_TRUE;
-    create_info.oldSwapchain = VK_NULL_HANDLE;
+    create_info.oldSwapchain = old_swapchain;
 
     if (vkCreateSwapchainKHR(m_context->get_device(), &create_info, nullptr, &m_swapchain) != VK_SUCCESS)
     {
@@ -303,9 +314,14 @@ bool swapchain::create_image_views()
     return true;
 }
 
-bool swapchain::create_depth_resources()
+bool swapchain::create_render_targets()
 {
     VkFormat depthFormat = find_depth_format();
+    m_depth_format = depthFormat;
+
+    // Depth and MSAA color never leave the pass (cleared on load, not stored), so they are transient:
+    // on tile-based GPUs they live in tile memory and lazily allocated memory is never committed
+    const VkMemoryPropertyFlags transient_memory = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
 
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -316,53 +332,41 @@ bool swapchain::create_depth_resources()
     imageInfo.format = depthFormat;
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+    imageInfo.samples = m_samples;
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-    if (vkCreateImage(m_context->get_device(), &imageInfo, nullptr, &m_depth_image) != VK_SUCCESS)
+    // A depth buffer read after the pass (depth pyramid) has to be stored, so it cannot be transient
+    if (m_depth_sampled)
     {
-        log_error("Failed to create depth image.");
-        return false;
+        imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetImageMemoryRequirements(m_context->get_device(), m_depth_image, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = find_memory_type(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-    if (vkAllocateMemory(m_context->get_device(), &allocInfo, nullptr, &m_depth_image_memory) != VK_SUCCESS)
+    m_depth_image = m_context->get_resources()->create_image(imageInfo, VK_IMAGE_ASPECT_DEPTH_BIT, m_depth_sampled ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : transient_memory);
+    if (!m_depth_image.is_valid())
     {
-        log_error("Failed to allocate depth image memory.");
+        log_error("Failed to create depth image.");
         return false;
     }
 
-    vkBindImageMemory(m_context->get_device(), m_depth_image, m_depth_image_memory, 0);
+    if (m_samples == VK_SAMPLE_COUNT_1_BIT)
+        return true;
 
-    VkImageViewCreateInfo viewInfo{};
-    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    viewInfo.image = m_depth_image;
-    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    viewInfo.format = depthFormat;
-    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-    viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
-    viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount = 1;
+    // Resolved into the swapchain image at the end of the subpass
+    imageInfo.format = m_format;
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
 
-    if (vkCreateImageView(m_context->get_device(), &viewInfo, nullptr, &m_depth_image_view) != VK_SUCCESS)
+    m_color_target = m_context->get_resources()->create_image(imageInfo, VK_IMAGE_ASPECT_COLOR_BIT, transient_memory);
+    if (!m_color_target.is_valid())
     {
-        log_error("Failed to create depth image view.");
+        log_error("Failed to create multisampled color target.");
         return false;
     }
 
     return true;
 }
 
-VkSurfaceFormatKHR swapchain::choose_swap_surface_format(const std::vector<VkSurfaceFormatKHR>& available_formats)
+VkSurfaceFormatKHR swapchain::choose_swap_surface_format(const arena_vector<VkSurfaceFormatKHR>& available_formats)
 {
     if (available_formats.empty())
     {
@@ -381,21 +385,22 @@ VkSurfaceFormatKHR swapchain::choose_swap_surface_format(const std::vector<VkSur
     return available_formats[0];
 }
 
-VkPresentModeKHR swapchain::choose_swap_present_mode(const std::vector<VkPresentModeKHR>& available_present_modes)
+VkPresentModeKHR swapchain::choose_swap_present_mode(const arena_vector<VkPresentModeKHR>& available_present_modes)
 {
     if (available_present_modes.empty())
     {
         throw std::runtime_error("No present modes available!");
     }
 
-    for (const auto& available_present_mode : available_present_modes)
+    for (VkPresentModeKHR preferred : m_frame_config.present_modes)
     {
-        if (available_present_mode == VK_PRESENT_MODE_MAILBOX_KHR)
+        if (std::find(available_present_modes.begin(), available_present_modes.end(), preferred) != available_present_modes.end())
         {
-            return available_present_mode;
+            return preferred;
         }
     }
 
+    // FIFO is the only mode every implementation must support
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -420,51 +425,53 @@ VkExtent2D swapchain::choose_swap_extent(const VkSurfaceCapabilitiesKHR& capabil
 
 VkFormat swapchain::find_supported_format(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
 {
-    for (VkFormat format : candidates)
-    {
-        VkFormatProperties props;
-        vkGetPhysicalDeviceFormatProperties(m_context->get_physical_device(), format, &props);
-
-        if (tiling == VK_IMAGE_TILING_LINEAR && (props.linearTilingFeatures & features) == features)
-        {
-            return format;
-        }
-        else if (tiling == VK_IMAGE_TILING_OPTIMAL && (props.optimalTilingFeatures & features) == features)
-        {
-            return format;
-        }
-    }
-    throw std::runtime_error("Failed to find a supported format!");
+    return m_context->find_supported_format(candidates, tiling, features);
 }
 
 VkFormat swapchain::find_depth_format()
 {
+    // Float depth first: reverse-Z relies on float precision near 0 for distant geometry
     return find_supported_format(
         {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
         VK_IMAGE_TILING_OPTIMAL,
-        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
-}
-
-uint32_t swapchain::find_memory_type(uint32_t typeFilter, VkMemoryPropertyFlags properties)
-{
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(m_context->get_physical_device(), &memProperties);
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-    {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-        {
-            return i;
-        }
-    }
-    throw std::runtime_error("Failed to find suitable memory type!");
+        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | (m_depth_sampled ? VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT : 0));
 }
 
 VkSwapchainKHR swapchain::get_handle() const { return m_swapchain; }
 VkFormat swapchain::get_image_format() const { return m_format; }
 VkExtent2D swapchain::get_extent() const { return m_extent; }
+VkImage swapchain::get_image(uint32_t index) const { return m_images[index]; }
 VkImageView swapchain::get_image_view(uint32_t index) const { return m_image_views[index]; }
 VkFramebuffer swapchain::get_framebuffer(uint32_t index) const { return m_framebuffers[index]; }
+
+VkImage swapchain::get_depth_image() const
+{
+    const gpu_image* depth = m_context->get_resources()->get(m_depth_image);
+    return depth ? depth->image : VK_NULL_HANDLE;
+}
+
+VkImageView swapchain::get_depth_image_view() const
+{
+    const gpu_image* depth = m_context->get_resources()->get(m_depth_image);
+    return depth ? depth->view : VK_NULL_HANDLE;
+}
+
+VkFormat swapchain::get_depth_format() const { return m_depth_format; }
+
+VkImage swapchain::get_color_target() const
+{
+    const gpu_image* color_target = m_context->get_resources()->get(m_color_target);
+    return color_target ? color_target->image : VK_NULL_HANDLE;
+}
+
+VkImageView swapchain::get_color_target_view() const
+{
+    const gpu_image* color_target = m_context->get_resources()->get(m_color_target);
+    return color_target ? color_target->view : VK_NULL_HANDLE;
+}
+
+VkSampleCountFlagBits swapchain::get_sample_count() const { return m_samples; }
 uint32_t swapchain::get_image_count() const { return static_cast<uint32_t>(m_images.size()); }
+bool swapchain::supports_readback() const { return m_readback; }
 
 } // namespace juce
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <juce/core/win32_config.h>
+#include <juce/context/vulkan/frame_profile.h>
+#include <juce/context/vulkan/resource_pool.h>
+#include <juce/core/linear_arena.h>
 #include <vector>
 #include <cstdint>
 
@@ -11,7 +14,7 @@ class vk_context;
 
 /**
  * swapchain wrapper class
- * - 관리: swapchain, ImageViews, DepthBuffer, Framebuffers
+ * - 관리: swapchain, ImageViews, DepthBuffer, MSAA color target, Framebuffers
  * - 기능: 생성/정리/재생성, 이미지 획득, 프레젠트
  */
 class swapchain
@@ -23,12 +26,22 @@ public:
     // swapchain 및 관련 리소스 초기화
     bool initialize(vk_context* context, uint32_t width, uint32_t height);
 
-    // 리소스 정리
+    // 리소스 정리 (실제 파괴는 deletion queue, GPU 대기 없음)
     void cleanup();
 
     // 창 크기 변경 시 swapchain 재생성
     bool recreate(uint32_t width, uint32_t height);
 
+    // 이미지 수 / present mode 정책 (다음 생성/재생성부터 적용)
+    void set_frame_config(const frame_config& config);
+
+    // MSAA 샘플 수 (다음 생성/재생성부터 적용, 1이면 MSAA color target 없음)
+    void set_sample_count(VkSampleCountFlagBits samples);
+
+    // depth를 패스 밖에서 샘플링할지 (Hi-Z 등, 다음 생성/재생성부터 적용)
+    // - 켜면 transient가 아닌 일반 device 메모리 + SAMPLED usage
+    void set_depth_sampled(bool sampled);
+
     // RenderPass에 맞는 Framebuffer 생성
     bool create_framebuffers(VkRenderPass renderPass);
 
@@ -43,19 +56,30 @@ public:
     VkSwapchainKHR get_handle() const;
     VkFormat get_image_format() const;
     VkExtent2D get_extent() const;
+    VkImage get_image(uint32_t index) const;
     VkImageView get_image_view(uint32_t index) const;
     VkFramebuffer get_framebuffer(uint32_t index) const;
+    VkImage get_depth_image() const;
+    VkImageView get_depth_image_view() const;
+    VkFormat get_depth_format() const;
+    // MSAA color target (샘플 수 1이면 VK_NULL_HANDLE)
+    VkImage get_color_target() const;
+    VkImageView get_color_target_view() const;
+    VkSampleCountFlagBits get_sample_count() const;
     uint32_t get_image_count() const;
+    // 이미지를 transfer source로 복사할 수 있는지 (frame capture)
+    bool supports_readback() const;
 
 private:
     // swapchain 관련 생성
-    bool create_swapchain();
+    bool create_swapchain(VkSwapchainKHR old_swapchain = VK_NULL_HANDLE);
     bool create_image_views();
-    bool create_depth_resources();
+    bool create_render_targets();
+    void release_image_resources();
 
     // 선택 헬퍼
-    VkSurfaceFormatKHR choose_swap_surface_format(const std::vector<VkSurfaceFormatKHR>& available_formats);
-    VkPresentModeKHR choose_swap_present_mode(const std::vector<VkPresentModeKHR>& available_present_modes);
+    VkSurfaceFormatKHR choose_swap_surface_format(const arena_vector<VkSurfaceFormatKHR>& available_formats);
+    VkPresentModeKHR choose_swap_present_mode(const arena_vector<VkPresentModeKHR>& available_present_modes);
     VkExtent2D choose_swap_extent(const VkSurfaceCapabilitiesKHR& capabilities);
 
     // Depth 포맷/메모리
@@ -63,7 +87,6 @@ private:
                                    VkImageTiling tiling,
                                    VkFormatFeatureFlags features);
     VkFormat find_depth_format();
-    uint32_t find_memory_type(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
 private:
     VkSwapchainKHR m_swapchain;
@@ -74,13 +97,21 @@ private:
     std::vector<VkImageView> m_image_views;
     std::vector<VkFramebuffer> m_framebuffers;
 
-    VkImage m_depth_image;
-    VkDeviceMemory m_depth_image_memory;
-    VkImageView m_depth_image_view;
+    image_handle m_depth_image;
+    image_handle m_color_target; // MSAA일 때만
+    VkFormat m_depth_format;
+    VkSampleCountFlagBits m_samples;
+    bool m_depth_sampled = false;
+    bool m_readback = false; // TRANSFER_SRC usage
 
     vk_context* m_context; // 소유하지 않음
     uint32_t m_width;
     uint32_t m_height;
+
+    frame_config m_frame_config;
+
+    // surface 지원 조회용 임시 메모리 (create_swapchain마다 reset)
+    linear_arena m_scratch;
 };
 
 } // namespace juce
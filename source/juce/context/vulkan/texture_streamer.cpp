@@ -0,0 +1,822 @@
+// texture_streamer는 "어떤 mip이 VRAM에 있어야 하는가"를 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+#include <juce/core/profiler.h>
+
+#include "texture_streamer.h"
+#include "vk_context.h"
+#include "image_format.h"
+#include "image_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace juce
+{
+
+static uint32_t mip_extent(uint32_t size, uint32_t mip)
+{
+    return std::max(1u, size >> mip);
+}
+
+static VkDeviceSize mip_size(const texture_stream_desc& desc, uint32_t mip)
+{
+    return get_image_size(desc.format, mip_extent(desc.width, mip), mip_extent(desc.height, mip));
+}
+
+texture_streamer::texture_streamer()
+    : m_context(nullptr), m_resident_bytes(0), m_frame(0), m_pressure_callback(UINT32_MAX), m_heap_pressure{}, m_pressure_budget(UINT64_MAX), m_staging_buffer(VK_NULL_HANDLE), m_staging_memory(VK_NULL_HANDLE), m_staging_mapped(nullptr), m_upload_cmd(VK_NULL_HANDLE), m_batch_timeline_value(0), m_batch_in_flight(false), m_scratch(64 * 1024), m_stop(false)
+{
+}
+
+texture_streamer::~texture_streamer()
+{
+    cleanup();
+}
+
+bool texture_streamer::initialize(vk_context* context, const config& cfg)
+{
+    if (!context)
+    {
+        log_error("Invalid context provided to texture_streamer::initialize");
+        return false;
+    }
+
+    m_context = context;
+    m_config = cfg;
+    VkDevice device = m_context->get_device();
+
+    try
+    {
+        VkBufferCreateInfo buffer_info{};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = m_config.staging_bytes;
+        buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(device, &buffer_info, nullptr, &m_staging_buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create staging buffer!");
+        }
+
+        VkMemoryRequirements mem_requirements;
+        vkGetBufferMemoryRequirements(device, m_staging_buffer, &mem_requirements);
+
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = mem_requirements.size;
+        alloc_info.memoryTypeIndex = m_context->find_memory_type(mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        if (m_context->get_memory_stats()->allocate(alloc_info, memory_category::staging, &m_staging_memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate staging memory!");
+        }
+        vkBindBufferMemory(device, m_staging_buffer, m_staging_memory, 0);
+        vkMapMemory(device, m_staging_memory, 0, m_config.staging_bytes, 0, &m_staging_mapped);
+
+        VkCommandBufferAllocateInfo cmd_info{};
+        cmd_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmd_info.commandPool = m_context->get_command_pool();
+        cmd_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cmd_info.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &cmd_info, &m_upload_cmd) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate upload command buffer!");
+        }
+    }
+    catch (const std::exception& e)
+    {
+        log_error("Failed to initialize texture streamer: %s", e.what());
+        cleanup();
+        return false;
+    }
+
+    m_stop = false;
+    m_worker = std::thread(&texture_streamer::worker_loop, this);
+
+    m_pressure_callback = m_context->get_memory_stats()->add_pressure_callback([this](uint32_t heap, const memory_heap_stats& stats)
+                                                                                { on_memory_pressure(heap, stats); });
+
+    log_info("texture streamer initialized (budget %llu MB)", static_cast<unsigned long long>(m_config.budget_bytes >> 20));
+    return true;
+}
+
+void texture_streamer::cleanup()
+{
+    if (m_worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_worker.join();
+    }
+    m_jobs.clear();
+    m_results.clear();
+
+    if (m_context && m_pressure_callback != UINT32_MAX)
+    {
+        m_context->get_memory_stats()->remove_pressure_callback(m_pressure_callback);
+        m_pressure_callback = UINT32_MAX;
+    }
+    std::fill(std::begin(m_heap_pressure), std::end(m_heap_pressure), memory_pressure::normal);
+    m_pressure_budget = UINT64_MAX;
+
+    if (!m_context || m_context->get_device() == VK_NULL_HANDLE)
+        return;
+
+    VkDevice device = m_context->get_device();
+
+    if (m_batch_in_flight)
+    {
+        m_context->get_graphics_timeline()->wait(m_batch_timeline_value);
+        collect_finished_batch();
+    }
+
+    for (uint32_t id = 0; id < m_textures.size(); id++)
+    {
+        destroy_texture(id);
+    }
+    m_textures.clear();
+    m_free_ids.clear();
+
+    if (m_upload_cmd != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(device, m_context->get_command_pool(), 1, &m_upload_cmd);
+        m_upload_cmd = VK_NULL_HANDLE;
+    }
+    if (m_staging_buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(device, m_staging_buffer, nullptr);
+        m_staging_buffer = VK_NULL_HANDLE;
+    }
+    if (m_staging_memory != VK_NULL_HANDLE)
+    {
+        m_context->get_memory_stats()->free(m_staging_memory);
+        m_staging_memory = VK_NULL_HANDLE;
+        m_staging_mapped = nullptr;
+    }
+}
+
+uint32_t texture_streamer::create_texture(const texture_stream_desc& desc)
+{
+    if (desc.width == 0 || desc.height == 0 || desc.mip_levels == 0 || !desc.load_mip)
+    {
+        log_error("Invalid texture_stream_desc");
+        return UINT32_MAX;
+    }
+    format_block_info block_info;
+    if (!get_format_block_info(desc.format, block_info) ||
+        !m_context->is_format_supported(desc.format, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+    {
+        log_error("Unsupported streaming texture format %d", static_cast<int>(desc.format));
+        return UINT32_MAX;
+    }
+
+    uint32_t id;
+    if (!m_free_ids.empty())
+    {
+        id = m_free_ids.back();
+        m_free_ids.pop_back();
+    }
+    else
+    {
+        id = static_cast<uint32_t>(m_textures.size());
+        m_textures.emplace_back();
+    }
+
+    stream_texture& tex = m_textures[id];
+    uint32_t generation = tex.generation;
+    tex = stream_texture{};
+    tex.desc = desc;
+    tex.generation = generation;
+    tex.alive = true;
+
+    // The tail is the first mip that fits in tail_size; it stays resident for the texture's lifetime.
+    tex.tail_mip = desc.mip_levels - 1;
+    for (uint32_t mip = 0; mip < desc.mip_levels; mip++)
+    {
+        if (mip_extent(desc.width, mip) <= m_config.tail_size && mip_extent(desc.height, mip) <= m_config.tail_size)
+        {
+            tex.tail_mip = mip;
+            break;
+        }
+    }
+    tex.resident_mip = desc.mip_levels;
+    tex.desired_mip = tex.tail_mip;
+    tex.last_used_frame = m_frame;
+    tex.pending = true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back({id, tex.generation, tex.tail_mip, desc.mip_levels, desc.load_mip});
+    }
+    m_cv.notify_one();
+
+    return id;
+}
+
+uint32_t texture_streamer::create_texture_from_file(const std::string& path)
+{
+    auto file = std::make_shared<image_file>();
+    if (!file->open(path))
+    {
+        return UINT32_MAX;
+    }
+
+    texture_stream_desc desc;
+    desc.width = file->get_width();
+    desc.height = file->get_height();
+    desc.mip_levels = file->get_mip_levels();
+    desc.format = file->get_format();
+    desc.load_mip = [file](uint32_t mip, std::vector<char>& out)
+    {
+        return file->read_mip(mip, out);
+    };
+
+    return create_texture(desc);
+}
+
+void texture_streamer::destroy_texture(uint32_t id)
+{
+    if (id >= m_textures.size() || !m_textures[id].alive)
+        return;
+
+    stream_texture& tex = m_textures[id];
+    if (tex.image != VK_NULL_HANDLE)
+    {
+        retire(tex.image, tex.memory, tex.view);
+    }
+    m_resident_bytes -= tex.bytes;
+
+    tex.image = VK_NULL_HANDLE;
+    tex.memory = VK_NULL_HANDLE;
+    tex.view = VK_NULL_HANDLE;
+    tex.bytes = 0;
+    tex.alive = false;
+    tex.pending = false;
+    tex.desc.load_mip = nullptr;
+    tex.generation++; // In-flight loads and swaps for the old texture are discarded
+    m_free_ids.push_back(id);
+}
+
+void texture_streamer::report_usage(uint32_t id, float screen_pixels)
+{
+    if (id >= m_textures.size() || !m_textures[id].alive)
+        return;
+
+    stream_texture& tex = m_textures[id];
+    float texels = static_cast<float>(std::max(tex.desc.width, tex.desc.height));
+    float ratio = texels / std::max(screen_pixels, 1.0f);
+    uint32_t mip = ratio <= 1.0f ? 0 : static_cast<uint32_t>(std::floor(std::log2(ratio)));
+    mip = std::min(mip, tex.tail_mip);
+
+    // Several reports in one frame keep the most detailed request
+    if (tex.last_used_frame != m_frame)
+    {
+        tex.desired_mip = mip;
+    }
+    else
+    {
+        tex.desired_mip = std::min(tex.desired_mip, mip);
+    }
+    tex.last_used_frame = m_frame;
+}
+
+void texture_streamer::update()
+{
+    if (!m_context)
+        return;
+
+    m_frame++;
+
+    collect_finished_batch();
+    m_context->get_deletion_queue()->flush();
+
+    m_scratch.reset();
+
+    arena_vector<load_job> evictions{arena_allocator<load_job>(m_scratch)};
+    enforce_budget(evictions);
+
+    if (!m_batch_in_flight)
+    {
+        arena_vector<load_result> results{arena_allocator<load_result>(m_scratch)};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (!m_results.empty() && results.size() < m_config.max_uploads_per_frame)
+            {
+                results.push_back(std::move(m_results.front()));
+                m_results.pop_front();
+            }
+        }
+
+        if (!results.empty() || !evictions.empty())
+        {
+            submit_results(results, evictions);
+        }
+    }
+    else if (!evictions.empty())
+    {
+        // Evictions need the upload command buffer as well; retry next frame
+        for (const auto& job : evictions)
+        {
+            m_textures[job.id].pending = false;
+        }
+    }
+
+    issue_requests();
+}
+
+void texture_streamer::set_budget(VkDeviceSize budget_bytes)
+{
+    m_config.budget_bytes = budget_bytes;
+}
+
+VkDeviceSize texture_streamer::get_effective_budget() const
+{
+    return std::min(m_config.budget_bytes, m_pressure_budget);
+}
+
+void texture_streamer::on_memory_pressure(uint32_t heap, const memory_heap_stats& stats)
+{
+    // Streamed mips only live in device-local memory
+    if (!stats.device_local || heap >= VK_MAX_MEMORY_HEAPS)
+        return;
+
+    m_heap_pressure[heap] = stats.pressure;
+    memory_pressure worst = memory_pressure::normal;
+    for (memory_pressure pressure : m_heap_pressure)
+    {
+        worst = std::max(worst, pressure);
+    }
+
+    // The cap is taken from what is resident now; enforce_budget drops LRU levels down to it on the next update
+    switch (worst)
+    {
+    case memory_pressure::normal:
+        m_pressure_budget = UINT64_MAX;
+        break;
+    case memory_pressure::warning:
+        m_pressure_budget = std::min(m_pressure_budget, m_resident_bytes / 4 * 3);
+        break;
+    case memory_pressure::critical:
+        m_pressure_budget = std::min(m_pressure_budget, m_resident_bytes / 2);
+        break;
+    }
+    log_info("texture streamer budget %llu MB under %s memory pressure", static_cast<unsigned long long>(get_effective_budget() >> 20), get_memory_pressure_name(worst));
+}
+
+VkImageView texture_streamer::get_image_view(uint32_t id) const
+{
+    return id < m_textures.size() ? m_textures[id].view : VK_NULL_HANDLE;
+}
+
+uint32_t texture_streamer::get_resident_mip(uint32_t id) const
+{
+    return id < m_textures.size() ? m_textures[id].resident_mip : UINT32_MAX;
+}
+
+VkDeviceSize texture_streamer::get_resident_bytes() const
+{
+    return m_resident_bytes;
+}
+
+void texture_streamer::worker_loop()
+{
+    JUCE_PROFILE_THREAD("texture streamer");
+
+    for (;;)
+    {
+        load_job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]()
+                      { return m_stop || !m_jobs.empty(); });
+            if (m_stop)
+                return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        load_result result;
+        result.ok = true;
+        result.mips.resize(job.last_mip - job.first_mip);
+        for (uint32_t mip = job.first_mip; mip < job.last_mip && result.ok; mip++)
+        {
+            JUCE_PROFILE_SCOPE("texture_streamer::load_mip");
+            result.ok = job.load_mip(mip, result.mips[mip - job.first_mip]);
+        }
+        result.job = std::move(job);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results.push_back(std::move(result));
+    }
+}
+
+void texture_streamer::collect_finished_batch()
+{
+    if (!m_batch_in_flight || !m_context->get_graphics_timeline()->is_complete(m_batch_timeline_value))
+        return;
+
+    for (const auto& swap : m_batch_swaps)
+    {
+        stream_texture& tex = m_textures[swap.id];
+        if (!tex.alive || tex.generation != swap.generation)
+        {
+            // Destroyed while the upload was in flight
+            retire(swap.image, swap.memory, swap.view);
+            continue;
+        }
+
+        if (tex.image != VK_NULL_HANDLE)
+        {
+            retire(tex.image, tex.memory, tex.view);
+        }
+        m_resident_bytes = m_resident_bytes - tex.bytes + swap.bytes;
+
+        tex.image = swap.image;
+        tex.memory = swap.memory;
+        tex.view = swap.view;
+        tex.bytes = swap.bytes;
+        tex.resident_mip = swap.resident_mip;
+        tex.pending = false;
+    }
+    m_batch_swaps.clear();
+    m_batch_in_flight = false;
+}
+
+void texture_streamer::submit_results(arena_vector<load_result>& results, arena_vector<load_job>& evictions)
+{
+    vkResetCommandBuffer(m_upload_cmd, 0);
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(m_upload_cmd, &begin_info) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin upload command buffer!");
+    }
+
+    VkDeviceSize staging_offset = 0;
+    arena_vector<load_result> deferred{arena_allocator<load_result>(m_scratch)};
+
+    // Evictions are rebuilds without new data, so both paths share the same copy logic
+    arena_vector<load_result> ops{arena_allocator<load_result>(m_scratch)};
+    ops.reserve(results.size() + evictions.size());
+    for (auto& result : results)
+    {
+        ops.push_back(std::move(result));
+    }
+    for (auto& job : evictions)
+    {
+        ops.push_back({std::move(job), true, {}});
+    }
+
+    for (auto& op : ops)
+    {
+        stream_texture& tex = m_textures[op.job.id];
+        if (!tex.alive || tex.generation != op.job.generation)
+            continue;
+
+        if (!op.ok)
+        {
+            log_warn("Failed to load mips %u-%u of streaming texture %u", op.job.first_mip, op.job.last_mip - 1, op.job.id);
+            tex.pending = false;
+            continue;
+        }
+
+        // The copy reads a whole mip from staging, so a short one would pull in the next mip or run past the data
+        VkDeviceSize upload_bytes = 0;
+        bool truncated = false;
+        for (uint32_t i = 0; i < op.mips.size(); i++)
+        {
+            const auto& data = op.mips[i];
+            if (data.size() < mip_size(tex.desc, op.job.first_mip + i))
+            {
+                log_warn("Streaming texture %u mip %u is truncated, keeping the resident mips", op.job.id, op.job.first_mip + i);
+                truncated = true;
+                break;
+            }
+            upload_bytes += (data.size() + 15) & ~VkDeviceSize(15);
+        }
+        if (truncated)
+        {
+            tex.pending = false;
+            continue;
+        }
+        if (staging_offset + upload_bytes > m_config.staging_bytes)
+        {
+            if (upload_bytes > m_config.staging_bytes)
+            {
+                log_error("Streaming texture %u mip data exceeds the staging buffer", op.job.id);
+                tex.pending = false;
+            }
+            else
+            {
+                deferred.push_back(std::move(op));
+            }
+            continue;
+        }
+
+        uint32_t new_first = op.job.first_mip;
+        uint32_t old_first = tex.resident_mip;
+        uint32_t levels = tex.desc.mip_levels;
+
+        VkImage image;
+        VkDeviceMemory memory;
+        VkImageView view;
+        if (!create_image(tex, new_first, image, memory, view))
+        {
+            tex.pending = false;
+            continue;
+        }
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.subresourceRange.baseMipLevel = 0;
+
+        barrier.image = image;
+        barrier.subresourceRange.levelCount = levels - new_first;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(m_upload_cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        // Carry over the levels that stay resident
+        if (tex.image != VK_NULL_HANDLE)
+        {
+            uint32_t copy_first = std::max(new_first, old_first);
+
+            barrier.image = tex.image;
+            barrier.subresourceRange.levelCount = levels - old_first;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            vkCmdPipelineBarrier(m_upload_cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+            arena_vector<VkImageCopy> copies{arena_allocator<VkImageCopy>(m_scratch)};
+            for (uint32_t mip = copy_first; mip < levels; mip++)
+            {
+                VkImageCopy copy{};
+                copy.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip - old_first, 0, 1};
+                copy.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip - new_first, 0, 1};
+                copy.extent = {mip_extent(tex.desc.width, mip), mip_extent(tex.desc.height, mip), 1};
+                copies.push_back(copy);
+            }
+            vkCmdCopyImage(m_upload_cmd, tex.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copies.size()), copies.data());
+
+            // The old image keeps serving frames until the swap
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(m_upload_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+
+        // Upload the newly loaded levels
+        for (uint32_t i = 0; i < op.mips.size(); i++)
+        {
+            uint32_t mip = op.job.first_mip + i;
+            const auto& data = op.mips[i];
+            std::memcpy(static_cast<char*>(m_staging_mapped) + staging_offset, data.data(), data.size());
+
+            VkBufferImageCopy region{};
+            region.bufferOffset = staging_offset;
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip - new_first, 0, 1};
+            region.imageExtent = {mip_extent(tex.desc.width, mip), mip_extent(tex.desc.height, mip), 1};
+            vkCmdCopyBufferToImage(m_upload_cmd, m_staging_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+            staging_offset += (data.size() + 15) & ~VkDeviceSize(15);
+        }
+
+        barrier.image = image;
+        barrier.subresourceRange.levelCount = levels - new_first;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(m_upload_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        m_batch_swaps.push_back({op.job.id, op.job.generation, new_first, image, memory, view, mip_chain_size(tex, new_first)});
+    }
+
+    if (vkEndCommandBuffer(m_upload_cmd) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to record upload command buffer!");
+    }
+
+    if (!deferred.empty())
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = deferred.rbegin(); it != deferred.rend(); ++it)
+        {
+            m_results.push_front(std::move(*it));
+        }
+    }
+
+    if (m_batch_swaps.empty())
+        return;
+
+    m_batch_timeline_value = m_context->get_graphics_timeline()->submit(m_context->get_graphics_queue(), m_upload_cmd, nullptr, 0, nullptr, 0);
+    m_batch_in_flight = true;
+}
+
+void texture_streamer::enforce_budget(arena_vector<load_job>& evictions)
+{
+    VkDeviceSize projected = m_resident_bytes;
+
+    // Textures that have not been seen for a while fall back to their tail
+    for (uint32_t id = 0; id < m_textures.size(); id++)
+    {
+        stream_texture& tex = m_textures[id];
+        if (!tex.alive)
+            continue;
+
+        if (m_frame - tex.last_used_frame > m_config.usage_timeout_frames)
+        {
+            tex.desired_mip = tex.tail_mip;
+        }
+
+        if (!tex.pending && tex.image != VK_NULL_HANDLE && tex.resident_mip < tex.tail_mip && m_frame - tex.last_used_frame > m_config.usage_timeout_frames)
+        {
+            projected -= tex.bytes - mip_chain_size(tex, tex.tail_mip);
+            tex.pending = true;
+            evictions.push_back({id, tex.generation, tex.tail_mip, tex.tail_mip, nullptr});
+        }
+    }
+
+    // Then drop one level at a time from the least recently used textures
+    while (projected > get_effective_budget())
+    {
+        uint32_t victim = UINT32_MAX;
+        for (uint32_t id = 0; id < m_textures.size(); id++)
+        {
+            const stream_texture& tex = m_textures[id];
+            if (!tex.alive || tex.pending || tex.image == VK_NULL_HANDLE || tex.resident_mip >= tex.tail_mip)
+                continue;
+            if (victim == UINT32_MAX || tex.last_used_frame < m_textures[victim].last_used_frame)
+            {
+                victim = id;
+            }
+        }
+        if (victim == UINT32_MAX)
+            break;
+
+        stream_texture& tex = m_textures[victim];
+        uint32_t new_first = tex.resident_mip + 1;
+        projected -= tex.bytes - mip_chain_size(tex, new_first);
+        tex.pending = true;
+        tex.desired_mip = std::max(tex.desired_mip, new_first);
+        evictions.push_back({victim, tex.generation, new_first, new_first, nullptr});
+    }
+}
+
+void texture_streamer::issue_requests()
+{
+    VkDeviceSize projected = m_resident_bytes;
+
+    // Largest residency gap first, one level per request
+    arena_vector<uint32_t> candidates{arena_allocator<uint32_t>(m_scratch)};
+    for (uint32_t id = 0; id < m_textures.size(); id++)
+    {
+        const stream_texture& tex = m_textures[id];
+        if (tex.alive && !tex.pending && tex.image != VK_NULL_HANDLE && tex.desired_mip < tex.resident_mip)
+        {
+            candidates.push_back(id);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b)
+              { return m_textures[a].resident_mip - m_textures[a].desired_mip > m_textures[b].resident_mip - m_textures[b].desired_mip; });
+
+    arena_vector<load_job> jobs{arena_allocator<load_job>(m_scratch)};
+    for (uint32_t id : candidates)
+    {
+        stream_texture& tex = m_textures[id];
+        uint32_t mip = tex.resident_mip - 1;
+        VkDeviceSize growth = mip_size(tex.desc, mip);
+        if (projected + growth > get_effective_budget())
+            break;
+
+        projected += growth;
+        tex.pending = true;
+        jobs.push_back({id, tex.generation, mip, mip + 1, tex.desc.load_mip});
+    }
+
+    if (jobs.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& job : jobs)
+        {
+            m_jobs.push_back(std::move(job));
+        }
+    }
+    m_cv.notify_one();
+}
+
+void texture_streamer::retire(VkImage image, VkDeviceMemory memory, VkImageView view)
+{
+    // Everything submitted so far may still sample the image
+    deletion_queue* queue = m_context->get_deletion_queue();
+    queue->destroy_image_view(view);
+    queue->destroy_image(image);
+    queue->free_memory(memory);
+}
+
+bool texture_streamer::create_image(const stream_texture& tex, uint32_t first_mip, VkImage& image, VkDeviceMemory& memory, VkImageView& view)
+{
+    VkDevice device = m_context->get_device();
+    uint32_t levels = tex.desc.mip_levels - first_mip;
+
+    VkImageCreateInfo image_info{};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.extent = {mip_extent(tex.desc.width, first_mip), mip_extent(tex.desc.height, first_mip), 1};
+    image_info.mipLevels = levels;
+    image_info.arrayLayers = 1;
+    image_info.format = tex.desc.format;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateImage(device, &image_info, nullptr, &image) != VK_SUCCESS)
+    {
+        log_error("Failed to create streaming texture image.");
+        return false;
+    }
+
+    VkMemoryRequirements mem_requirements;
+    vkGetImageMemoryRequirements(device, image, &mem_requirements);
+
+    VkMemoryAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_requirements.size;
+    try
+    {
+        alloc_info.memoryTypeIndex = m_context->find_memory_type(mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+    catch (const std::exception& e)
+    {
+        // Runs inside update() on the frame path; failure keeps the resident mips like any other
+        log_error("Failed to create streaming texture image: %s", e.what());
+        vkDestroyImage(device, image, nullptr);
+        return false;
+    }
+
+    if (m_context->get_memory_stats()->allocate(alloc_info, memory_category::texture, &memory) != VK_SUCCESS)
+    {
+        log_error("Failed to allocate streaming texture memory.");
+        vkDestroyImage(device, image, nullptr);
+        return false;
+    }
+    vkBindImageMemory(device, image, memory, 0);
+
+    VkImageViewCreateInfo view_info{};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = tex.desc.format;
+    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    view_info.subresourceRange.baseMipLevel = 0;
+    view_info.subresourceRange.levelCount = levels;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(device, &view_info, nullptr, &view) != VK_SUCCESS)
+    {
+        log_error("Failed to create streaming texture image view.");
+        vkDestroyImage(device, image, nullptr);
+        m_context->get_memory_stats()->free(memory);
+        return false;
+    }
+
+    return true;
+}
+
+VkDeviceSize texture_streamer::mip_chain_size(const stream_texture& tex, uint32_t first_mip) const
+{
+    VkDeviceSize size = 0;
+    for (uint32_t mip = first_mip; mip < tex.desc.mip_levels; mip++)
+    {
+        size += mip_size(tex.desc, mip);
+    }
+    return size;
+}
+
+} // namespace juce
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+#include <juce/core/linear_arena.h>
+#include <juce/context/vulkan/memory_stats.h>
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+// 스트리밍 텍스처 설명
+// - load_mip: 워커 스레드에서 호출, mip 데이터를 out에 채워서 반환
+struct texture_stream_desc
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mip_levels = 1;
+    VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+    std::function<bool(uint32_t mip, std::vector<char>& out)> load_mip;
+};
+
+/**
+ * texture streamer
+ * - 관리: mip 단위 상주(residency), VRAM 예산, 백그라운드 업로드
+ * - 낮은 해상도 mip tail을 먼저 올리고, 화면 사용량 피드백에 따라 높은 mip을 스트리밍
+ * - 예산 초과 시 가장 오래 쓰이지 않은 텍스처의 상위 mip부터 내림
+ * - device-local heap 압박 시 (memory_stats callback) 예산을 상주량 아래로 낮춰 내림, normal로 돌아오면 복구
+ */
+class texture_streamer
+{
+public:
+    struct config
+    {
+        VkDeviceSize budget_bytes = 256ull * 1024 * 1024;
+        VkDeviceSize staging_bytes = 16ull * 1024 * 1024;
+        uint32_t tail_size = 64;           // 이 크기 이하의 mip은 항상 상주
+        uint32_t max_uploads_per_frame = 4;
+        uint32_t usage_timeout_frames = 120; // 이 기간 동안 사용되지 않으면 tail로 내림
+    };
+
+    texture_streamer();
+    ~texture_streamer();
+
+    bool initialize(vk_context* context, const config& cfg);
+    void cleanup();
+
+    // 텍스처 등록 / 해제 (id 반환, 실패 시 UINT32_MAX)
+    uint32_t create_texture(const texture_stream_desc& desc);
+    // KTX2 / DDS 파일에서 mip 블록을 그대로 스트리밍 (BC1-7 포함)
+    uint32_t create_texture_from_file(const std::string& path);
+    void destroy_texture(uint32_t id);
+
+    // 화면 공간 사용량 피드백 (투영된 긴 변의 픽셀 수)
+    void report_usage(uint32_t id, float screen_pixels);
+
+    // 매 프레임 호출: 완료된 로드 업로드, 예산 적용, 요청 발행
+    void update();
+
+    void set_budget(VkDeviceSize budget_bytes);
+    // 설정 예산과 memory pressure 제한 중 작은 값
+    VkDeviceSize get_effective_budget() const;
+
+    // Getters
+    VkImageView get_image_view(uint32_t id) const;
+    uint32_t get_resident_mip(uint32_t id) const;
+    VkDeviceSize get_resident_bytes() const;
+
+private:
+    struct stream_texture
+    {
+        texture_stream_desc desc;
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkDeviceSize bytes = 0;
+        uint32_t tail_mip = 0;     // 항상 상주하는 첫 mip
+        uint32_t resident_mip = 0; // 상주 중인 가장 상세한 mip (mip_levels면 없음)
+        uint32_t desired_mip = 0;
+        uint64_t last_used_frame = 0;
+        uint32_t generation = 0;
+        bool pending = false;
+        bool alive = false;
+    };
+
+    struct load_job
+    {
+        uint32_t id;
+        uint32_t generation;
+        uint32_t first_mip; // 새로 올릴 mip 범위 [first_mip, last_mip)
+        uint32_t last_mip;
+        std::function<bool(uint32_t mip, std::vector<char>& out)> load_mip;
+    };
+
+    struct load_result
+    {
+        load_job job;
+        bool ok;
+        std::vector<std::vector<char>> mips;
+    };
+
+    struct pending_swap
+    {
+        uint32_t id;
+        uint32_t generation;
+        uint32_t resident_mip;
+        VkImage image;
+        VkDeviceMemory memory;
+        VkImageView view;
+        VkDeviceSize bytes;
+    };
+
+    void worker_loop();
+    // memory_stats callback (메인 스레드, memory_stats::update 중)
+    void on_memory_pressure(uint32_t heap, const memory_heap_stats& stats);
+    void collect_finished_batch();
+    void submit_results(arena_vector<load_result>& results, arena_vector<load_job>& evictions);
+    void enforce_budget(arena_vector<load_job>& evictions);
+    void issue_requests();
+    // deletion queue로 넘김 (이미 제출된 작업이 끝난 뒤 파괴)
+    void retire(VkImage image, VkDeviceMemory memory, VkImageView view);
+
+    bool create_image(const stream_texture& tex, uint32_t first_mip, VkImage& image, VkDeviceMemory& memory, VkImageView& view);
+    VkDeviceSize mip_chain_size(const stream_texture& tex, uint32_t first_mip) const;
+
+    vk_context* m_context; // 소유하지 않음
+    config m_config;
+
+    std::vector<stream_texture> m_textures;
+    std::vector<uint32_t> m_free_ids;
+    VkDeviceSize m_resident_bytes;
+    uint64_t m_frame;
+
+    // memory pressure
+    uint32_t m_pressure_callback; // UINT32_MAX = 등록 안 됨
+    memory_pressure m_heap_pressure[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize m_pressure_budget; // 압박이 없으면 UINT64_MAX
+
+    // 업로드 배치 (한 번에 하나만 in-flight)
+    VkBuffer m_staging_buffer;
+    VkDeviceMemory m_staging_memory;
+    void* m_staging_mapped;
+    VkCommandBuffer m_upload_cmd;
+    uint64_t m_batch_timeline_value;
+    bool m_batch_in_flight;
+    std::vector<pending_swap> m_batch_swaps;
+
+    // update() 한 번 동안만 쓰는 임시 데이터
+    linear_arena m_scratch;
+
+    // 워커 스레드
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<load_job> m_jobs;
+    std::deque<load_result> m_results;
+    bool m_stop;
+};
+
+} // namespace juce
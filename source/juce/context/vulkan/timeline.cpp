@@ -0,0 +1,150 @@
+#include <juce/core/logger.h>
+
+#include "timeline.h"
+
+#include <stdexcept>
+
+namespace juce
+{
+
+static const uint32_t MAX_SUBMIT_SEMAPHORES = 8;
+
+timeline::timeline()
+    : m_device(VK_NULL_HANDLE), m_semaphore(VK_NULL_HANDLE), m_last_submitted(0), m_completed(0)
+{
+}
+
+timeline::~timeline()
+{
+    cleanup();
+}
+
+bool timeline::initialize(VkDevice device)
+{
+    m_device = device;
+    m_last_submitted = 0;
+    m_completed = 0;
+
+    VkSemaphoreTypeCreateInfo type_info{};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphore_info{};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_info.pNext = &type_info;
+
+    if (vkCreateSemaphore(m_device, &semaphore_info, nullptr, &m_semaphore) != VK_SUCCESS)
+    {
+        log_error("Failed to create timeline semaphore.");
+        return false;
+    }
+    return true;
+}
+
+void timeline::cleanup()
+{
+    if (m_semaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(m_device, m_semaphore, nullptr);
+        m_semaphore = VK_NULL_HANDLE;
+    }
+}
+
+uint64_t timeline::submit(VkQueue queue, VkCommandBuffer command_buffer,
+                          const timeline_wait* waits, uint32_t wait_count,
+                          const VkSemaphore* binary_signals, uint32_t binary_signal_count)
+{
+    if (wait_count > MAX_SUBMIT_SEMAPHORES || binary_signal_count + 1 > MAX_SUBMIT_SEMAPHORES)
+    {
+        throw std::runtime_error("too many semaphores in a single submit!");
+    }
+
+    VkSemaphore wait_semaphores[MAX_SUBMIT_SEMAPHORES];
+    uint64_t wait_values[MAX_SUBMIT_SEMAPHORES];
+    VkPipelineStageFlags wait_stages[MAX_SUBMIT_SEMAPHORES];
+    for (uint32_t i = 0; i < wait_count; i++)
+    {
+        wait_semaphores[i] = waits[i].semaphore;
+        wait_values[i] = waits[i].value;
+        wait_stages[i] = waits[i].stage;
+    }
+
+    // Binary semaphores ignore their value slot; the timeline goes last
+    uint64_t value = m_last_submitted + 1;
+    VkSemaphore signal_semaphores[MAX_SUBMIT_SEMAPHORES];
+    uint64_t signal_values[MAX_SUBMIT_SEMAPHORES];
+    for (uint32_t i = 0; i < binary_signal_count; i++)
+    {
+        signal_semaphores[i] = binary_signals[i];
+        signal_values[i] = 0;
+    }
+    signal_semaphores[binary_signal_count] = m_semaphore;
+    signal_values[binary_signal_count] = value;
+
+    VkTimelineSemaphoreSubmitInfo timeline_info{};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.waitSemaphoreValueCount = wait_count;
+    timeline_info.pWaitSemaphoreValues = wait_values;
+    timeline_info.signalSemaphoreValueCount = binary_signal_count + 1;
+    timeline_info.pSignalSemaphoreValues = signal_values;
+
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.pNext = &timeline_info;
+    submit_info.waitSemaphoreCount = wait_count;
+    submit_info.pWaitSemaphores = wait_semaphores;
+    submit_info.pWaitDstStageMask = wait_stages;
+    submit_info.commandBufferCount = command_buffer != VK_NULL_HANDLE ? 1 : 0;
+    submit_info.pCommandBuffers = &command_buffer;
+    submit_info.signalSemaphoreCount = binary_signal_count + 1;
+    submit_info.pSignalSemaphores = signal_semaphores;
+
+    if (vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit command buffer!");
+    }
+
+    m_last_submitted = value;
+    return value;
+}
+
+uint64_t timeline::get_completed_value()
+{
+    if (m_completed < m_last_submitted)
+    {
+        vkGetSemaphoreCounterValue(m_device, m_semaphore, &m_completed);
+    }
+    return m_completed;
+}
+
+bool timeline::is_complete(uint64_t value)
+{
+    return value <= m_completed || value <= get_completed_value();
+}
+
+bool timeline::wait(uint64_t value, uint64_t timeout)
+{
+    if (is_complete(value))
+        return true;
+
+    VkSemaphoreWaitInfo wait_info{};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &m_semaphore;
+    wait_info.pValues = &value;
+
+    if (vkWaitSemaphores(m_device, &wait_info, timeout) != VK_SUCCESS)
+        return false;
+
+    if (value > m_completed)
+    {
+        m_completed = value;
+    }
+    return true;
+}
+
+VkSemaphore timeline::get_semaphore() const { return m_semaphore; }
+uint64_t timeline::get_last_submitted() const { return m_last_submitted; }
+
+} // namespace juce
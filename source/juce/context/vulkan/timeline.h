@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+#include <cstdint>
+
+namespace juce
+{
+
+// 제출 시 대기할 지점 (바이너리 세마포어면 value 무시)
+struct timeline_wait
+{
+    VkSemaphore semaphore;
+    uint64_t value;
+    VkPipelineStageFlags stage;
+};
+
+/**
+ * timeline semaphore wrapper
+ * - 큐마다 하나, 제출할 때마다 값이 단조 증가
+ * - CPU 대기, 다른 큐 대기, 리소스 재사용/지연 삭제 모두 이 값을 기준으로 판단
+ */
+class timeline
+{
+public:
+    timeline();
+    ~timeline();
+
+    bool initialize(VkDevice device);
+    void cleanup();
+
+    // 커맨드 버퍼 제출 후 새로 시그널될 값을 반환
+    uint64_t submit(VkQueue queue, VkCommandBuffer command_buffer,
+                    const timeline_wait* waits, uint32_t wait_count,
+                    const VkSemaphore* binary_signals, uint32_t binary_signal_count);
+
+    // GPU 진행 상황
+    uint64_t get_completed_value();
+    bool is_complete(uint64_t value);
+    bool wait(uint64_t value, uint64_t timeout = UINT64_MAX);
+
+    // Getters
+    VkSemaphore get_semaphore() const;
+    uint64_t get_last_submitted() const;
+
+private:
+    VkDevice m_device; // 소유하지 않음
+    VkSemaphore m_semaphore;
+    uint64_t m_last_submitted;
+    uint64_t m_completed; // 마지막으로 조회한 완료 값 (캐시)
+};
+
+} // namespace juce
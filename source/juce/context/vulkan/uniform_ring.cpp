@@ -0,0 +1,284 @@
+// uniform_ring은 "셰이더 상수를 이번 프레임 어디에 둘지"를 책임
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "uniform_ring.h"
+#include "vk_context.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace juce
+{
+
+static VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uniform_ring::uniform_ring()
+    : m_context(nullptr), m_frames_in_flight(0), m_buffer(VK_NULL_HANDLE), m_memory(VK_NULL_HANDLE), m_mapped(nullptr), m_set_layout(VK_NULL_HANDLE), m_descriptor_pool(VK_NULL_HANDLE), m_descriptor_set(VK_NULL_HANDLE), m_uniform_alignment(256), m_storage_alignment(256), m_push_constant_bytes(0), m_frame_begin(0), m_frame_offset(0), m_frame_data_offset(0)
+{
+}
+
+uniform_ring::~uniform_ring()
+{
+    cleanup();
+}
+
+bool uniform_ring::initialize(vk_context* context, uint32_t frames_in_flight, const config& cfg)
+{
+    if (!context || frames_in_flight == 0)
+    {
+        log_error("Invalid arguments provided to uniform_ring::initialize");
+        return false;
+    }
+
+    m_context = context;
+    m_config = cfg;
+    m_frames_in_flight = frames_in_flight;
+    VkDevice device = m_context->get_device();
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_context->get_physical_device(), &properties);
+    const VkPhysicalDeviceLimits& limits = properties.limits;
+
+    m_uniform_alignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 16);
+    m_storage_alignment = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, 16);
+    m_push_constant_bytes = std::min(m_config.push_constant_bytes, limits.maxPushConstantsSize) & ~3u;
+    m_config.uniform_range = std::min<VkDeviceSize>(m_config.uniform_range, limits.maxUniformBufferRange);
+    m_config.storage_range = std::min<VkDeviceSize>(m_config.storage_range, limits.maxStorageBufferRange);
+    m_config.frame_bytes = align_up(m_config.frame_bytes, std::max(m_uniform_alignment, m_storage_alignment));
+
+    try
+    {
+        // The tail padding keeps offset + descriptor range inside the buffer for the last allocation
+        VkBufferCreateInfo buffer_info{};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = m_config.frame_bytes * m_frames_in_flight + std::max(m_config.uniform_range, m_config.storage_range);
+        buffer_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(device, &buffer_info, nullptr, &m_buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create uniform ring buffer!");
+        }
+
+        VkMemoryRequirements mem_requirements;
+        vkGetBufferMemoryRequirements(device, m_buffer, &mem_requirements);
+
+        // Prefer host-visible VRAM (resizable BAR) so shaders read without crossing the bus
+        uint32_t memory_type;
+        try
+        {
+            memory_type = m_context->find_memory_type(mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        }
+        catch (const std::runtime_error&)
+        {
+            memory_type = m_context->find_memory_type(mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        }
+
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = mem_requirements.size;
+        alloc_info.memoryTypeIndex = memory_type;
+
+        if (m_context->get_memory_stats()->allocate(alloc_info, memory_category::buffer, &m_memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate uniform ring memory!");
+        }
+        vkBindBufferMemory(device, m_buffer, m_memory, 0);
+
+        void* mapped = nullptr;
+        if (vkMapMemory(device, m_memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to map uniform ring memory!");
+        }
+        m_mapped = static_cast<char*>(mapped);
+
+        create_descriptors();
+    }
+    catch (const std::exception& e)
+    {
+        log_error("Failed to initialize uniform ring: %s", e.what());
+        cleanup();
+        return false;
+    }
+
+    begin_frame(0);
+
+    log_info("uniform ring initialized (%u x %llu KB, push constants %u bytes)", m_frames_in_flight, static_cast<unsigned long long>(m_config.frame_bytes >> 10), m_push_constant_bytes);
+    return true;
+}
+
+void uniform_ring::create_descriptors()
+{
+    VkDevice device = m_context->get_device();
+
+    VkDescriptorSetLayoutBinding bindings[3]{};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_ALL;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_ALL;
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    bindings[2].descriptorCount = 1;
+    bindings[2].stageFlags = VK_SHADER_STAGE_ALL;
+
+    VkDescriptorSetLayoutCreateInfo layout_info{};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = 3;
+    layout_info.pBindings = bindings;
+
+    if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr, &m_set_layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create uniform ring descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize pool_sizes[2]{};
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    pool_sizes[0].descriptorCount = 2;
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+    pool_sizes[1].descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = 1;
+    pool_info.poolSizeCount = 2;
+    pool_info.pPoolSizes = pool_sizes;
+
+    if (vkCreateDescriptorPool(device, &pool_info, nullptr, &m_descriptor_pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create uniform ring descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = m_descriptor_pool;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &m_set_layout;
+
+    if (vkAllocateDescriptorSets(device, &alloc_info, &m_descriptor_set) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate uniform ring descriptor set!");
+    }
+
+    // Written once: every binding views the buffer from 0 and the dynamic offset selects the data
+    VkDescriptorBufferInfo buffer_infos[3]{};
+    buffer_infos[0] = {m_buffer, 0, m_config.uniform_range};
+    buffer_infos[1] = {m_buffer, 0, m_config.uniform_range};
+    buffer_infos[2] = {m_buffer, 0, m_config.storage_range};
+
+    VkWriteDescriptorSet writes[3]{};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = m_descriptor_set;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = bindings[i].descriptorType;
+        writes[i].pBufferInfo = &buffer_infos[i];
+    }
+    vkUpdateDescriptorSets(device, 3, writes, 0, nullptr);
+}
+
+void uniform_ring::cleanup()
+{
+    if (!m_context)
+        return;
+
+    VkDevice device = m_context->get_device();
+
+    if (m_descriptor_pool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(device, m_descriptor_pool, nullptr);
+        m_descriptor_pool = VK_NULL_HANDLE;
+        m_descriptor_set = VK_NULL_HANDLE;
+    }
+    if (m_set_layout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(device, m_set_layout, nullptr);
+        m_set_layout = VK_NULL_HANDLE;
+    }
+    if (m_memory != VK_NULL_HANDLE)
+    {
+        vkUnmapMemory(device, m_memory);
+        m_context->get_memory_stats()->free(m_memory);
+        m_memory = VK_NULL_HANDLE;
+        m_mapped = nullptr;
+    }
+    if (m_buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(device, m_buffer, nullptr);
+        m_buffer = VK_NULL_HANDLE;
+    }
+}
+
+void uniform_ring::begin_frame(uint32_t frame_index)
+{
+    m_frame_begin = m_config.frame_bytes * (frame_index % m_frames_in_flight);
+    m_frame_offset = 0;
+
+    // Until the frame writes its own data, binding 0 points at the start of its region
+    m_frame_data_offset = static_cast<uint32_t>(m_frame_begin);
+}
+
+ring_allocation uniform_ring::allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    VkDeviceSize offset = align_up(m_frame_begin + m_frame_offset, alignment);
+    if (offset + size > m_frame_begin + m_config.frame_bytes)
+    {
+        throw std::runtime_error("uniform ring frame region exhausted!");
+    }
+    m_frame_offset = offset + size - m_frame_begin;
+
+    ring_allocation allocation;
+    allocation.data = m_mapped + offset;
+    allocation.offset = static_cast<uint32_t>(offset);
+    allocation.size = size;
+    return allocation;
+}
+
+ring_allocation uniform_ring::allocate_uniform(VkDeviceSize size)
+{
+    if (size > m_config.uniform_range)
+    {
+        throw std::runtime_error("uniform allocation exceeds the descriptor range!");
+    }
+    return allocate(size, m_uniform_alignment);
+}
+
+void uniform_ring::set_frame_data(const void* data, VkDeviceSize size)
+{
+    ring_allocation allocation = allocate_uniform(size);
+    std::memcpy(allocation.data, data, static_cast<size_t>(size));
+    m_frame_data_offset = allocation.offset;
+}
+
+void uniform_ring::bind(VkCommandBuffer command_buffer, VkPipelineLayout layout, VkPipelineBindPoint bind_point)
+{
+    // Bindings 1 and 2 have no per-draw writer yet, so they view the start of the frame region
+    uint32_t frame_begin = static_cast<uint32_t>(m_frame_begin);
+    uint32_t dynamic_offsets[3] = {m_frame_data_offset, frame_begin, frame_begin};
+    vkCmdBindDescriptorSets(command_buffer, bind_point, layout, 0, 1, &m_descriptor_set, 3, dynamic_offsets);
+}
+
+VkDescriptorSetLayout uniform_ring::get_descriptor_set_layout() const { return m_set_layout; }
+
+VkPushConstantRange uniform_ring::get_push_constant_range() const
+{
+    VkPushConstantRange range{};
+    range.stageFlags = VK_SHADER_STAGE_ALL;
+    range.offset = 0;
+    range.size = m_push_constant_bytes;
+    return range;
+}
+
+VkDeviceSize uniform_ring::get_frame_used() const { return m_frame_offset; }
+
+} // namespace juce
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <juce/core/win32_config.h>
+
+#include <cstdint>
+
+namespace juce
+{
+
+class vk_context;
+
+// ring에서 잘라낸 영역: data에 바로 쓰고, offset은 dynamic offset으로 사용
+struct ring_allocation
+{
+    void* data = nullptr;
+    uint32_t offset = 0;
+    VkDeviceSize size = 0;
+};
+
+/**
+ * per-frame uniform / storage ring buffer
+ * - 관리: persistently mapped 버퍼 1개를 frames in flight 수만큼 구역으로 나눠 사용
+ * - 프레임 데이터는 구역 안에서 선형 할당, dynamic offset으로 바인딩 (map/unmap, 할당 없음)
+ *
+ * descriptor set 0 레이아웃
+ * - binding 0: 프레임 uniform (UNIFORM_BUFFER_DYNAMIC)
+ * - binding 1: 드로우 uniform (UNIFORM_BUFFER_DYNAMIC), 현재는 프레임 구역 시작을 가리킴
+ * - binding 2: 드로우 storage (STORAGE_BUFFER_DYNAMIC), 현재는 프레임 구역 시작을 가리킴
+ */
+class uniform_ring
+{
+public:
+    struct config
+    {
+        VkDeviceSize frame_bytes = 4ull * 1024 * 1024; // 프레임 구역 크기
+        VkDeviceSize uniform_range = 16 * 1024;       // binding 0/1이 한 번에 볼 수 있는 크기
+        VkDeviceSize storage_range = 256 * 1024;      // binding 2가 한 번에 볼 수 있는 크기
+        uint32_t push_constant_bytes = 128;            // 파이프라인 레이아웃에 선언할 push constant 크기
+    };
+
+    uniform_ring();
+    ~uniform_ring();
+
+    bool initialize(vk_context* context, uint32_t frames_in_flight, const config& cfg);
+    void cleanup();
+
+    // 프레임 슬롯의 GPU 작업이 끝난 뒤 호출, 해당 구역을 처음부터 다시 사용
+    void begin_frame(uint32_t frame_index);
+
+    ring_allocation allocate_uniform(VkDeviceSize size);
+
+    // 프레임 uniform 기록 (binding 0), 다음 bind부터 적용
+    void set_frame_data(const void* data, VkDeviceSize size);
+
+    // 현재 offset들로 set 0 바인딩
+    void bind(VkCommandBuffer command_buffer, VkPipelineLayout layout, VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+    // Getters
+    VkDescriptorSetLayout get_descriptor_set_layout() const;
+    VkPushConstantRange get_push_constant_range() const;
+    VkDeviceSize get_frame_used() const;
+
+private:
+    ring_allocation allocate(VkDeviceSize size, VkDeviceSize alignment);
+    void create_descriptors();
+
+    vk_context* m_context; // 소유하지 않음
+    config m_config;
+    uint32_t m_frames_in_flight;
+
+    VkBuffer m_buffer;
+    VkDeviceMemory m_memory;
+    char* m_mapped;
+
+    VkDescriptorSetLayout m_set_layout;
+    VkDescriptorPool m_descriptor_pool;
+    VkDescriptorSet m_descriptor_set; // dynamic offset으로 모든 프레임 구역을 가리키므로 1개면 충분
+
+    VkDeviceSize m_uniform_alignment;
+    VkDeviceSize m_storage_alignment;
+    uint32_t m_push_constant_bytes;
+
+    // 현재 프레임 구역 [m_frame_begin, m_frame_begin + frame_bytes)
+    VkDeviceSize m_frame_begin;
+    VkDeviceSize m_frame_offset;
+
+    uint32_t m_frame_data_offset;
+};
+
+} // namespace juce
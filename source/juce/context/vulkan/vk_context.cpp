@@ -2,10 +2,15 @@
 #include <juce/core/win32_config.h>
 #include "vk_context.h"
 #include <juce/core/logger.h>
+#include <juce/core/startup_trace.h>
 #include <iostream>
 #include <set>
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <stdexcept>
+#include <fstream>
+#include <cstring>
 
 // --- Debug Callback Function ---
 // Called when a message is generated from a Vulkan validation layer.
@@ -75,8 +80,11 @@ void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& create
     createInfo.pfnUserCallback = debugCallback;
 }
 
+// Queue family / extension / surface format lists of one device fit without overflow
+static const size_t QUERY_SCRATCH_BYTES = 64 * 1024;
+
 vk_context::vk_context()
-    : m_instance(VK_NULL_HANDLE), m_physical_device(VK_NULL_HANDLE), m_device(VK_NULL_HANDLE), m_graphics_queue(VK_NULL_HANDLE), m_present_queue(VK_NULL_HANDLE), m_surface(VK_NULL_HANDLE), m_command_pool(VK_NULL_HANDLE), m_debug_messenger(VK_NULL_HANDLE), m_graphics_queue_family(UINT32_MAX), m_present_queue_family(UINT32_MAX), m_hwnd(nullptr), m_hinstance(nullptr)
+    : m_instance(VK_NULL_HANDLE), m_physical_device(VK_NULL_HANDLE), m_device(VK_NULL_HANDLE), m_graphics_queue(VK_NULL_HANDLE), m_present_queue(VK_NULL_HANDLE), m_surface(VK_NULL_HANDLE), m_command_pool(VK_NULL_HANDLE), m_debug_messenger(VK_NULL_HANDLE), m_pipeline_cache(VK_NULL_HANDLE), m_graphics_queue_family(UINT32_MAX), m_present_queue_family(UINT32_MAX), m_hwnd(nullptr), m_hinstance(nullptr), m_scratch(QUERY_SCRATCH_BYTES)
 {
 }
 
@@ -85,34 +93,101 @@ vk_context::~vk_context()
     cleanup();
 }
 
+void vk_context::set_device_override(const std::string& selector)
+{
+    m_device_override = selector;
+}
+
+static const char* PIPELINE_CACHE_PATH = "pipeline_cache.bin";
+
+static std::vector<char> read_pipeline_cache_file()
+{
+    startup_phase phase("vk_context::read_pipeline_cache");
+
+    std::vector<char> data;
+    std::ifstream file(PIPELINE_CACHE_PATH, std::ios::ate | std::ios::binary);
+    if (file.is_open())
+    {
+        data.resize((size_t)file.tellg());
+        file.seekg(0);
+        file.read(data.data(), data.size());
+    }
+    return data;
+}
+
+bool vk_context::initialize_instance()
+{
+    if (m_instance != VK_NULL_HANDLE)
+        return true;
+
+    // Disk I/O for the cache overlaps instance creation and device selection
+    m_pipeline_cache_data = std::async(std::launch::async, read_pipeline_cache_file);
+
+    try
+    {
+        {
+            startup_phase phase("vk_context::create_instance");
+            if (!create_instance())
+            {
+                return false;
+            }
+        }
+        setup_debug_messenger();
+    }
+    catch (const std::exception& e)
+    {
+        log_error("Vulkan instance initialization failed: %s", e.what());
+        cleanup();
+        return false;
+    }
+    return true;
+}
+
 bool vk_context::initialize(HWND hwnd, HINSTANCE hinstance)
 {
     m_hwnd = hwnd;
     m_hinstance = hinstance;
 
+    if (!initialize_instance())
+    {
+        return false;
+    }
+
     try
     {
-        if (!create_instance())
         {
-            return false;
+            startup_phase phase("vk_context::create_surface");
+            if (!create_surface())
+            {
+                return false;
+            }
         }
-        setup_debug_messenger();
-        if (!create_surface())
         {
-            return false;
+            startup_phase phase("vk_context::pick_physical_device");
+            if (!pick_physical_device())
+            {
+                return false;
+            }
         }
-        if (!pick_physical_device())
         {
-            return false;
+            startup_phase phase("vk_context::create_logical_device");
+            if (!create_logical_device())
+            {
+                return false;
+            }
         }
-        if (!create_logical_device())
+        if (!create_command_pool())
         {
             return false;
         }
-        if (!create_command_pool())
+        if (!create_timelines())
         {
             return false;
         }
+        {
+            startup_phase phase("vk_context::create_pipeline_cache");
+            create_pipeline_cache();
+        }
     }
     catch (const std::exception& e)
     {
@@ -128,6 +203,13 @@ bool vk_context::initialize(HWND hwnd, HINSTANCE hinstance)
 
 void vk_context::cleanup()
 {
+    // A read still in flight after a failed initialization must finish before the context goes away
+    if (m_pipeline_cache_data.valid())
+    {
+        m_pipeline_cache_data.wait();
+        m_pipeline_cache_data = {};
+    }
+
     // Destroy device-dependent objects first
     if (m_command_pool != VK_NULL_HANDLE)
     {
@@ -138,6 +220,11 @@ void vk_context::cleanup()
     if (m_device != VK_NULL_HANDLE)
     {
         vkDeviceWaitIdle(m_device);
+        m_resources.cleanup();
+        m_deletion_queue.flush_all();
+        m_memory_stats.cleanup();
+        save_pipeline_cache();
+        m_graphics_timeline.cleanup();
         vkDestroyDevice(m_device, nullptr);
         m_device = VK_NULL_HANDLE;
     }
@@ -175,7 +262,7 @@ bool vk_context::create_instance()
     app_info.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     app_info.pEngineName = "Juce Engine";
     app_info.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    app_info.apiVersion = VK_API_VERSION_1_0;
+    app_info.apiVersion = VK_API_VERSION_1_2;
 
     auto extensions = get_required_extensions();
 
@@ -255,15 +342,77 @@ bool vk_context::pick_physical_device()
     std::vector<VkPhysicalDevice> devices(device_count);
     vkEnumeratePhysicalDevices(m_instance, &device_count, devices.data());
 
-    for (const auto& device : devices)
+    std::string selector = m_device_override;
+    if (selector.empty())
     {
-        if (is_device_suitable(device))
+        if (const char* env = std::getenv("JUCE_GPU"))
         {
-            m_physical_device = device;
-            break;
+            selector = env;
         }
     }
 
+    // Rank every suitable device; an explicit selector wins over the score
+    uint64_t best_score = 0;
+    VkPhysicalDevice best_device = VK_NULL_HANDLE;
+    VkPhysicalDevice selected_device = VK_NULL_HANDLE;
+
+    // Capability queries go to each driver separately; first-time queries can be slow, so devices are evaluated concurrently
+    std::vector<std::future<std::pair<bool, uint64_t>>> evaluations;
+    for (uint32_t i = 0; i < device_count; i++)
+    {
+        VkPhysicalDevice device = devices[i];
+        evaluations.push_back(std::async(std::launch::async, [this, device]()
+                                         {
+                                             // One block per evaluation thread instead of a vector per query
+                                             linear_arena scratch(QUERY_SCRATCH_BYTES);
+                                             bool suitable = is_device_suitable(device, scratch);
+                                             scratch.reset();
+                                             return std::make_pair(suitable, suitable ? score_device(device, scratch) : 0ull); }));
+    }
+
+    for (uint32_t i = 0; i < device_count; i++)
+    {
+        auto [suitable, score] = evaluations[i].get();
+        log_device_report(i, devices[i], suitable, score);
+
+        if (!suitable)
+        {
+            continue;
+        }
+
+        if (best_device == VK_NULL_HANDLE || score > best_score)
+        {
+            best_device = devices[i];
+            best_score = score;
+        }
+
+        if (!selector.empty() && selected_device == VK_NULL_HANDLE)
+        {
+            VkPhysicalDeviceProperties props;
+            vkGetPhysicalDeviceProperties(devices[i], &props);
+
+            std::string name = props.deviceName;
+            std::string lowered_name = name;
+            std::string lowered_selector = selector;
+            std::transform(lowered_name.begin(), lowered_name.end(), lowered_name.begin(), [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            std::transform(lowered_selector.begin(), lowered_selector.end(), lowered_selector.begin(), [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+
+            if (selector == std::to_string(i) || lowered_name.find(lowered_selector) != std::string::npos)
+            {
+                selected_device = devices[i];
+            }
+        }
+    }
+
+    if (!selector.empty() && selected_device == VK_NULL_HANDLE)
+    {
+        log_warn("GPU override '%s' matched no suitable device, using the highest ranked one", selector.c_str());
+    }
+
+    m_physical_device = selected_device != VK_NULL_HANDLE ? selected_device : best_device;
+
     if (m_physical_device == VK_NULL_HANDLE)
     {
         throw std::runtime_error("Failed to find a suitable GPU!");
@@ -271,32 +420,187 @@ bool vk_context::pick_physical_device()
 
     VkPhysicalDeviceProperties device_props;
     vkGetPhysicalDeviceProperties(m_physical_device, &device_props);
-    log_info("Selected GPU: %s", device_props.deviceName);
+    log_info("Selected GPU: %s%s", device_props.deviceName, selected_device != VK_NULL_HANDLE ? " (override)" : "");
 
     return true;
 }
 
-bool vk_context::is_device_suitable(VkPhysicalDevice device)
+uint64_t vk_context::score_device(VkPhysicalDevice device, linear_arena& scratch)
+{
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(device, &props);
+    VkPhysicalDeviceMemoryProperties mem_props;
+    vkGetPhysicalDeviceMemoryProperties(device, &mem_props);
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(device, &features);
+
+    // Device type dominates: discrete > integrated > virtual > CPU
+    uint64_t type_rank = 0;
+    switch (props.deviceType)
+    {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+        type_rank = 4;
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+        type_rank = 3;
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+        type_rank = 2;
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:
+        type_rank = 1;
+        break;
+    default:
+        break;
+    }
+
+    // Then dedicated VRAM in MB (capped so it never outweighs the type)
+    VkDeviceSize vram = 0;
+    for (uint32_t i = 0; i < mem_props.memoryHeapCount; i++)
+    {
+        if (mem_props.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+        {
+            vram += mem_props.memoryHeaps[i].size;
+        }
+    }
+    uint64_t vram_mb = std::min<uint64_t>(vram >> 20, 999999);
+
+    // Then queue capabilities and features the renderer benefits from
+    uint32_t queue_family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, nullptr);
+    arena_vector<VkQueueFamilyProperties> queue_families(queue_family_count, arena_allocator<VkQueueFamilyProperties>(scratch));
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, queue_families.data());
+
+    uint64_t bonus = 0;
+    for (const auto& family : queue_families)
+    {
+        bool graphics = (family.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        if (!graphics && (family.queueFlags & VK_QUEUE_COMPUTE_BIT))
+        {
+            bonus += 100; // async compute
+        }
+        else if (!graphics && (family.queueFlags & VK_QUEUE_TRANSFER_BIT))
+        {
+            bonus += 100; // dedicated DMA
+        }
+    }
+    if (features.textureCompressionBC)
+        bonus += 100;
+    if (is_device_extension_available(device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME, scratch))
+        bonus += 50;
+    bonus = std::min<uint64_t>(bonus, 999);
+
+    return type_rank * 1000000000ull + vram_mb * 1000 + bonus;
+}
+
+void vk_context::log_device_report(uint32_t index, VkPhysicalDevice device, bool suitable, uint64_t score)
+{
+    m_scratch.reset();
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(device, &props);
+    VkPhysicalDeviceMemoryProperties mem_props;
+    vkGetPhysicalDeviceMemoryProperties(device, &mem_props);
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(device, &features);
+
+    const char* type_name = "other";
+    switch (props.deviceType)
+    {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+        type_name = "discrete";
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+        type_name = "integrated";
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+        type_name = "virtual";
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:
+        type_name = "cpu";
+        break;
+    default:
+        break;
+    }
+
+    VkDeviceSize vram = 0;
+    VkDeviceSize shared = 0;
+    for (uint32_t i = 0; i < mem_props.memoryHeapCount; i++)
+    {
+        if (mem_props.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            vram += mem_props.memoryHeaps[i].size;
+        else
+            shared += mem_props.memoryHeaps[i].size;
+    }
+
+    uint32_t queue_family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, nullptr);
+    arena_vector<VkQueueFamilyProperties> queue_families(queue_family_count, arena_allocator<VkQueueFamilyProperties>(m_scratch));
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, queue_families.data());
+
+    uint32_t graphics_queues = 0, compute_queues = 0, transfer_queues = 0;
+    for (const auto& family : queue_families)
+    {
+        if (family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            graphics_queues += family.queueCount;
+        else if (family.queueFlags & VK_QUEUE_COMPUTE_BIT)
+            compute_queues += family.queueCount;
+        else if (family.queueFlags & VK_QUEUE_TRANSFER_BIT)
+            transfer_queues += family.queueCount;
+    }
+
+    log_info("GPU %u: %s [%s] Vulkan %u.%u.%u, VRAM %llu MB, shared %llu MB",
+             index, props.deviceName, type_name,
+             VK_VERSION_MAJOR(props.apiVersion), VK_VERSION_MINOR(props.apiVersion), VK_VERSION_PATCH(props.apiVersion),
+             static_cast<unsigned long long>(vram >> 20), static_cast<unsigned long long>(shared >> 20));
+    log_info("    queues: %u graphics, %u async compute, %u transfer | BC %s, present wait %s | %s (score %llu)",
+             graphics_queues, compute_queues, transfer_queues,
+             features.textureCompressionBC ? "yes" : "no",
+             is_device_extension_available(device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME, m_scratch) ? "yes" : "no",
+             suitable ? "suitable" : "unsuitable",
+             static_cast<unsigned long long>(score));
+}
+
+bool vk_context::is_device_suitable(VkPhysicalDevice device, linear_arena& scratch)
 {
-    QueueFamilyIndices indices = find_queue_families(device);
-    bool extensions_supported = check_device_extension_support(device);
+    // Frame synchronization is built on timeline semaphores (core in 1.2)
+    VkPhysicalDeviceProperties device_props;
+    vkGetPhysicalDeviceProperties(device, &device_props);
+    if (device_props.apiVersion < VK_API_VERSION_1_2)
+    {
+        return false;
+    }
+
+    VkPhysicalDeviceTimelineSemaphoreFeatures timeline_features{};
+    timeline_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &timeline_features;
+    vkGetPhysicalDeviceFeatures2(device, &features2);
+    if (!timeline_features.timelineSemaphore)
+    {
+        return false;
+    }
+
+    QueueFamilyIndices indices = find_queue_families(device, scratch);
+    bool extensions_supported = check_device_extension_support(device, scratch);
 
     bool swapchain_adequate = false;
     if (extensions_supported)
     {
-        swapchainSupportDetails swapchain_support = query_swapchain_support(device);
+        swapchainSupportDetails swapchain_support = query_swapchain_support(device, scratch);
         swapchain_adequate = !swapchain_support.formats.empty() && !swapchain_support.present_modes.empty();
     }
 
     return indices.is_complete() && extensions_supported && swapchain_adequate;
 }
 
-vk_context::QueueFamilyIndices vk_context::find_queue_families(VkPhysicalDevice device)
+vk_context::QueueFamilyIndices vk_context::find_queue_families(VkPhysicalDevice device, linear_arena& scratch)
 {
     QueueFamilyIndices indices;
     uint32_t queue_family_count = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, nullptr);
-    std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+    arena_vector<VkQueueFamilyProperties> queue_families(queue_family_count, arena_allocator<VkQueueFamilyProperties>(scratch));
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, queue_families.data());
 
     int i = 0;
@@ -324,26 +628,46 @@ vk_context::QueueFamilyIndices vk_context::find_queue_families(VkPhysicalDevice
     return indices;
 }
 
-bool vk_context::check_device_extension_support(VkPhysicalDevice device)
+bool vk_context::check_device_extension_support(VkPhysicalDevice device, linear_arena& scratch)
 {
     uint32_t extension_count;
     vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, nullptr);
-    std::vector<VkExtensionProperties> available_extensions(extension_count);
+    arena_vector<VkExtensionProperties> available_extensions(extension_count, arena_allocator<VkExtensionProperties>(scratch));
     vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, available_extensions.data());
 
-    std::set<std::string> required_extensions(m_device_extensions.begin(), m_device_extensions.end());
+    // The required list is a handful of names, so a linear scan replaces the string set
+    for (const char* required : m_device_extensions)
+    {
+        bool found = std::any_of(available_extensions.begin(), available_extensions.end(), [required](const VkExtensionProperties& extension)
+                                 { return strcmp(extension.extensionName, required) == 0; });
+        if (!found)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool vk_context::is_device_extension_available(VkPhysicalDevice device, const char* name, linear_arena& scratch) const
+{
+    uint32_t extension_count;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, nullptr);
+    arena_vector<VkExtensionProperties> available_extensions(extension_count, arena_allocator<VkExtensionProperties>(scratch));
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, available_extensions.data());
 
     for (const auto& extension : available_extensions)
     {
-        required_extensions.erase(extension.extensionName);
+        if (strcmp(extension.extensionName, name) == 0)
+        {
+            return true;
+        }
     }
-
-    return required_extensions.empty();
+    return false;
 }
 
-vk_context::swapchainSupportDetails vk_context::query_swapchain_support(VkPhysicalDevice device) const
+vk_context::swapchainSupportDetails vk_context::query_swapchain_support(VkPhysicalDevice device, linear_arena& scratch) const
 {
-    swapchainSupportDetails details;
+    swapchainSupportDetails details(scratch);
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, m_surface, &details.capabilities);
 
     uint32_t format_count;
@@ -366,7 +690,8 @@ vk_context::swapchainSupportDetails vk_context::query_swapchain_support(VkPhysic
 
 bool vk_context::create_logical_device()
 {
-    QueueFamilyIndices indices = find_queue_families(m_physical_device);
+    m_scratch.reset();
+    QueueFamilyIndices indices = find_queue_families(m_physical_device, m_scratch);
     if (!indices.is_complete())
     {
         throw std::runtime_error("Could not find all required queue families.");
@@ -388,15 +713,91 @@ bool vk_context::create_logical_device()
         queue_create_infos.push_back(queue_create_info);
     }
 
+    VkPhysicalDeviceFeatures supported_features;
+    vkGetPhysicalDeviceFeatures(m_physical_device, &supported_features);
+
+    // Block-compressed textures are uploaded as-is, so BC sampling must be enabled when present
     VkPhysicalDeviceFeatures device_features{};
+    device_features.textureCompressionBC = supported_features.textureCompressionBC;
+    // GPU-driven culling issues one indirect draw for the whole object list and
+    // passes the object index as firstInstance when available
+    device_features.multiDrawIndirect = supported_features.multiDrawIndirect;
+    device_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+    // Per-pass statistics; occlusion queries themselves are core, only exact sample counts are optional
+    device_features.pipelineStatisticsQuery = supported_features.pipelineStatisticsQuery;
+    device_features.occlusionQueryPrecise = supported_features.occlusionQueryPrecise;
+
+    VkPhysicalDeviceTimelineSemaphoreFeatures timeline_features{};
+    timeline_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    timeline_features.timelineSemaphore = VK_TRUE;
+
+    // Optional extensions are enabled only when the device supports them and their features;
+    // each enabled feature struct is pushed onto the front of the chain.
+    m_enabled_device_extensions = m_device_extensions;
+    void* feature_chain = &timeline_features;
+
+    VkPhysicalDevicePresentIdFeaturesKHR present_id_features{};
+    present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{};
+    present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+    if (is_device_extension_available(m_physical_device, VK_KHR_PRESENT_ID_EXTENSION_NAME, m_scratch) &&
+        is_device_extension_available(m_physical_device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME, m_scratch))
+    {
+        present_id_features.pNext = &present_wait_features;
+        VkPhysicalDeviceFeatures2 query{};
+        query.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        query.pNext = &present_id_features;
+        vkGetPhysicalDeviceFeatures2(m_physical_device, &query);
+
+        if (present_id_features.presentId && present_wait_features.presentWait)
+        {
+            present_wait_features.pNext = feature_chain;
+            feature_chain = &present_id_features;
+            m_enabled_device_extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            m_enabled_device_extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        }
+    }
+
+    // Dynamic rendering depends on create_renderpass2 and depth_stencil_resolve, both core in 1.2
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering_features{};
+    dynamic_rendering_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+    if (is_device_extension_available(m_physical_device, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, m_scratch))
+    {
+        VkPhysicalDeviceFeatures2 query{};
+        query.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        query.pNext = &dynamic_rendering_features;
+        vkGetPhysicalDeviceFeatures2(m_physical_device, &query);
+
+        if (dynamic_rendering_features.dynamicRendering)
+        {
+            dynamic_rendering_features.pNext = feature_chain;
+            feature_chain = &dynamic_rendering_features;
+            m_enabled_device_extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        }
+    }
+
+    // Lets GPU timestamps be placed on the CPU profiler timeline; no features to enable
+    if (is_device_extension_available(m_physical_device, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME, m_scratch))
+    {
+        m_enabled_device_extensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+    }
+
+    // Per-heap budget and usage from the OS; without it memory_stats estimates both
+    if (is_device_extension_available(m_physical_device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, m_scratch))
+    {
+        m_enabled_device_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
 
     VkDeviceCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    create_info.pNext = feature_chain;
     create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
     create_info.pQueueCreateInfos = queue_create_infos.data();
     create_info.pEnabledFeatures = &device_features;
-    create_info.enabledExtensionCount = static_cast<uint32_t>(m_device_extensions.size());
-    create_info.ppEnabledExtensionNames = m_device_extensions.data();
+    create_info.enabledExtensionCount = static_cast<uint32_t>(m_enabled_device_extensions.size());
+    create_info.ppEnabledExtensionNames = m_enabled_device_extensions.data();
 
     // For modern Vulkan, validation layers are set at the instance level.
     if (m_enable_validation_layers)
@@ -415,6 +816,8 @@ bool vk_context::create_logical_device()
         return false;
     }
 
+    m_enabled_features = device_features;
+
     vkGetDeviceQueue(m_device, indices.graphics_family.value(), 0, &m_graphics_queue);
     vkGetDeviceQueue(m_device, indices.present_family.value(), 0, &m_present_queue);
 
@@ -426,7 +829,8 @@ bool vk_context::create_logical_device()
 
 bool vk_context::create_command_pool()
 {
-    QueueFamilyIndices indices = find_queue_families(m_physical_device);
+    m_scratch.reset();
+    QueueFamilyIndices indices = find_queue_families(m_physical_device, m_scratch);
     if (!indices.graphics_family.has_value())
     {
         throw std::runtime_error("Graphics queue family not found for command pool creation.");
@@ -446,6 +850,77 @@ bool vk_context::create_command_pool()
     return true;
 }
 
+bool vk_context::create_timelines()
+{
+    if (!m_graphics_timeline.initialize(m_device))
+    {
+        return false;
+    }
+    m_memory_stats.initialize(m_physical_device, m_device, is_device_extension_enabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME), memory_stats::config{});
+    m_deletion_queue.initialize(m_device, &m_graphics_timeline, &m_memory_stats);
+    m_resources.initialize(this);
+    return true;
+}
+
+void vk_context::create_pipeline_cache()
+{
+    std::vector<char> data = m_pipeline_cache_data.valid() ? m_pipeline_cache_data.get() : read_pipeline_cache_file();
+
+    // The driver is allowed to reject foreign data, but only the header check is guaranteed to be safe
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_physical_device, &properties);
+
+    VkPipelineCacheHeaderVersionOne header{};
+    if (data.size() >= sizeof(header))
+    {
+        std::memcpy(&header, data.data(), sizeof(header));
+    }
+    bool compatible = data.size() >= sizeof(header) &&
+                      header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                      header.vendorID == properties.vendorID &&
+                      header.deviceID == properties.deviceID &&
+                      std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    if (!data.empty() && !compatible)
+    {
+        log_info("Pipeline cache belongs to another device or driver, starting empty");
+    }
+
+    VkPipelineCacheCreateInfo cache_info{};
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.initialDataSize = compatible ? data.size() : 0;
+    cache_info.pInitialData = compatible ? data.data() : nullptr;
+
+    if (vkCreatePipelineCache(m_device, &cache_info, nullptr, &m_pipeline_cache) != VK_SUCCESS)
+    {
+        // Pipelines still build without a cache, just slower
+        log_warn("Failed to create pipeline cache");
+        m_pipeline_cache = VK_NULL_HANDLE;
+        return;
+    }
+    log_debug("Pipeline cache: %zu bytes loaded", compatible ? data.size() : (size_t)0);
+}
+
+void vk_context::save_pipeline_cache()
+{
+    if (m_pipeline_cache == VK_NULL_HANDLE)
+        return;
+
+    size_t size = 0;
+    std::vector<char> data;
+    if (vkGetPipelineCacheData(m_device, m_pipeline_cache, &size, nullptr) == VK_SUCCESS && size > 0)
+    {
+        data.resize(size);
+        if (vkGetPipelineCacheData(m_device, m_pipeline_cache, &size, data.data()) == VK_SUCCESS)
+        {
+            std::ofstream file(PIPELINE_CACHE_PATH, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), size);
+        }
+    }
+
+    vkDestroyPipelineCache(m_device, m_pipeline_cache, nullptr);
+    m_pipeline_cache = VK_NULL_HANDLE;
+}
+
 // --- Helper Functions ---
 bool vk_context::check_validation_layer_support()
 {
@@ -486,8 +961,64 @@ std::vector<const char*> vk_context::get_required_extensions()
     return extensions;
 }
 
+uint32_t vk_context::find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) const
+{
+    VkPhysicalDeviceMemoryProperties mem_properties;
+    vkGetPhysicalDeviceMemoryProperties(m_physical_device, &mem_properties);
+
+    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; i++)
+    {
+        if ((type_filter & (1 << i)) && (mem_properties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+VkSampleCountFlagBits vk_context::get_max_sample_count() const
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_physical_device, &properties);
+
+    VkSampleCountFlags counts = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+    for (VkSampleCountFlagBits samples : {VK_SAMPLE_COUNT_64_BIT, VK_SAMPLE_COUNT_32_BIT, VK_SAMPLE_COUNT_16_BIT, VK_SAMPLE_COUNT_8_BIT, VK_SAMPLE_COUNT_4_BIT, VK_SAMPLE_COUNT_2_BIT})
+    {
+        if (counts & samples)
+        {
+            return samples;
+        }
+    }
+    return VK_SAMPLE_COUNT_1_BIT;
+}
+
+bool vk_context::is_format_supported(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features) const
+{
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(m_physical_device, format, &props);
+
+    if (tiling == VK_IMAGE_TILING_LINEAR)
+    {
+        return (props.linearTilingFeatures & features) == features;
+    }
+    return (props.optimalTilingFeatures & features) == features;
+}
+
+VkFormat vk_context::find_supported_format(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const
+{
+    for (VkFormat format : candidates)
+    {
+        if (is_format_supported(format, tiling, features))
+        {
+            return format;
+        }
+    }
+    throw std::runtime_error("Failed to find a supported format!");
+}
+
 // --- Getters ---
 VkDevice vk_context::get_device() const { return m_device; }
+VkInstance vk_context::get_instance() const { return m_instance; }
 VkPhysicalDevice vk_context::get_physical_device() const { return m_physical_device; }
 VkQueue vk_context::get_graphics_queue() const { return m_graphics_queue; }
 VkQueue vk_context::get_present_queue() const { return m_present_queue; }
@@ -495,6 +1026,29 @@ VkSurfaceKHR vk_context::get_surface() const { return m_surface; }
 VkCommandPool vk_context::get_command_pool() const { return m_command_pool; }
 uint32_t vk_context::get_graphics_queue_family() const { return m_graphics_queue_family; }
 uint32_t vk_context::get_present_queue_family() const { return m_present_queue_family; }
-vk_context::swapchainSupportDetails vk_context::get_swapchain_support() const { return query_swapchain_support(m_physical_device); }
+timeline* vk_context::get_graphics_timeline() { return &m_graphics_timeline; }
+deletion_queue* vk_context::get_deletion_queue() { return &m_deletion_queue; }
+resource_pool* vk_context::get_resources() { return &m_resources; }
+memory_stats* vk_context::get_memory_stats() { return &m_memory_stats; }
+VkPipelineCache vk_context::get_pipeline_cache() const { return m_pipeline_cache; }
+
+bool vk_context::is_device_extension_enabled(const char* name) const
+{
+    for (const char* extension : m_enabled_device_extensions)
+    {
+        if (strcmp(extension, name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+const VkPhysicalDeviceFeatures& vk_context::get_enabled_features() const
+{
+    return m_enabled_features;
+}
+
+vk_context::swapchainSupportDetails vk_context::get_swapchain_support(linear_arena& scratch) const { return query_swapchain_support(m_physical_device, scratch); }
 
 } // namespace juce
@@ -2,9 +2,15 @@
 
 #include <juce/core/typedef.h>
 #include <juce/core/win32_config.h>
+#include <juce/context/vulkan/timeline.h>
+#include <juce/context/vulkan/deletion_queue.h>
+#include <juce/context/vulkan/resource_pool.h>
+#include <juce/context/vulkan/memory_stats.h>
+#include <juce/core/linear_arena.h>
 #include <vector>
 #include <optional>
 #include <string>
+#include <future>
 
 namespace juce
 {
@@ -12,12 +18,17 @@ namespace juce
 class vk_context
 {
 public:
-    // --- swapchain 지원 구조체 ---
+    // --- swapchain 지원 구조체 (목록은 호출자 arena에, reset 전까지 유효) ---
     struct swapchainSupportDetails
     {
+        explicit swapchainSupportDetails(linear_arena& arena)
+            : capabilities{}, formats(arena_allocator<VkSurfaceFormatKHR>(arena)), present_modes(arena_allocator<VkPresentModeKHR>(arena))
+        {
+        }
+
         VkSurfaceCapabilitiesKHR capabilities;
-        std::vector<VkSurfaceFormatKHR> formats;
-        std::vector<VkPresentModeKHR> present_modes;
+        arena_vector<VkSurfaceFormatKHR> formats;
+        arena_vector<VkPresentModeKHR> present_modes;
     };
 
     // --- 큐 패밀리 인덱스 ---
@@ -37,10 +48,18 @@ public:
     ~vk_context();
 
     // --- 초기화 & 정리 ---
+    // 창이 필요 없는 앞부분 (instance, debug messenger, pipeline cache 파일 읽기 시작)
+    // - 창 생성과 겹치도록 다른 스레드에서 먼저 호출 가능, 생략하면 initialize가 호출
+    bool initialize_instance();
     bool initialize(HWND hwnd, HINSTANCE hinstance);
     void cleanup();
 
+    // --- GPU 선택 강제 (initialize 전에 호출) ---
+    // 인덱스("1") 또는 이름 일부("RTX"), 비어 있으면 환경 변수 JUCE_GPU 사용
+    void set_device_override(const std::string& selector);
+
     // --- Getters ---
+    VkInstance get_instance() const;
     VkDevice get_device() const;
     VkPhysicalDevice get_physical_device() const;
     VkQueue get_graphics_queue() const;
@@ -49,7 +68,30 @@ public:
     VkCommandPool get_command_pool() const;
     uint32_t get_graphics_queue_family() const;
     uint32_t get_present_queue_family() const;
-    swapchainSupportDetails get_swapchain_support() const;
+    timeline* get_graphics_timeline();
+    deletion_queue* get_deletion_queue();
+    resource_pool* get_resources();
+    // device memory 할당 / 해제 창구 + heap budget / 용도별 통계
+    memory_stats* get_memory_stats();
+    // 모든 파이프라인 생성에 사용 (내부 동기화, 워커 스레드에서도 사용 가능)
+    VkPipelineCache get_pipeline_cache() const;
+
+    // --- 선택적 확장 / 기능 ---
+    bool is_device_extension_enabled(const char* name) const;
+    // 논리 디바이스 생성 시 실제로 켠 core 기능
+    const VkPhysicalDeviceFeatures& get_enabled_features() const;
+    swapchainSupportDetails get_swapchain_support(linear_arena& scratch) const;
+
+    // --- 메모리 헬퍼 ---
+    uint32_t find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) const;
+
+    // --- 포맷 헬퍼 ---
+    bool is_format_supported(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features) const;
+    VkFormat find_supported_format(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const;
+
+    // --- MSAA ---
+    // color와 depth framebuffer가 모두 지원하는 최대 샘플 수
+    VkSampleCountFlagBits get_max_sample_count() const;
 
 private:
     // --- 내부 초기화 단계 ---
@@ -59,14 +101,22 @@ private:
     bool pick_physical_device();
     bool create_logical_device();
     bool create_command_pool();
+    bool create_timelines();
+    // pipeline_cache.bin에서 읽어 생성 (다른 장치 / 드라이버의 데이터면 빈 cache), cleanup 시 저장
+    void create_pipeline_cache();
+    void save_pipeline_cache();
 
     // --- 헬퍼 함수 ---
+    // 장치 조회의 임시 목록은 scratch에 할당 (reset은 호출자가), 장치 평가 스레드마다 자기 arena 사용
     bool check_validation_layer_support();
     std::vector<const char*> get_required_extensions();
-    bool is_device_suitable(VkPhysicalDevice device);
-    QueueFamilyIndices find_queue_families(VkPhysicalDevice device);
-    bool check_device_extension_support(VkPhysicalDevice device);
-    swapchainSupportDetails query_swapchain_support(VkPhysicalDevice device) const;
+    bool is_device_suitable(VkPhysicalDevice device, linear_arena& scratch);
+    uint64_t score_device(VkPhysicalDevice device, linear_arena& scratch);
+    void log_device_report(uint32_t index, VkPhysicalDevice device, bool suitable, uint64_t score);
+    QueueFamilyIndices find_queue_families(VkPhysicalDevice device, linear_arena& scratch);
+    bool check_device_extension_support(VkPhysicalDevice device, linear_arena& scratch);
+    bool is_device_extension_available(VkPhysicalDevice device, const char* name, linear_arena& scratch) const;
+    swapchainSupportDetails query_swapchain_support(VkPhysicalDevice device, linear_arena& scratch) const;
 
     // --- Vulkan 객체 ---
     VkInstance m_instance;
@@ -77,20 +127,41 @@ private:
     VkSurfaceKHR m_surface;
     VkCommandPool m_command_pool;
     VkDebugUtilsMessengerEXT m_debug_messenger;
+    VkPipelineCache m_pipeline_cache;
+
+    // --- 큐별 timeline ---
+    timeline m_graphics_timeline;
+
+    // --- device memory 통계 (deletion queue / resource pool보다 먼저 초기화, 나중에 정리) ---
+    memory_stats m_memory_stats;
+
+    // --- 지연 파괴 / handle 리소스 (graphics timeline 기준) ---
+    deletion_queue m_deletion_queue;
+    resource_pool m_resources;
 
     // --- 큐 패밀리 인덱스 ---
     uint32_t m_graphics_queue_family;
     uint32_t m_present_queue_family;
 
+    std::string m_device_override;
+
+    // initialize_instance에서 읽기 시작한 pipeline_cache.bin (create_pipeline_cache가 사용)
+    std::future<std::vector<char>> m_pipeline_cache_data;
+
     // --- Win32 핸들 ---
     HWND m_hwnd;
     HINSTANCE m_hinstance;
 
+    // 메인 스레드 장치 조회용 임시 메모리 (조회를 시작하는 함수가 reset)
+    linear_arena m_scratch;
+
     // --- 설정값 ---
     const std::vector<const char*> m_validation_layers = {
         "VK_LAYER_KHRONOS_validation"};
     const std::vector<const char*> m_device_extensions = {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    std::vector<const char*> m_enabled_device_extensions; // 필수 + 지원되는 선택적 확장
+    VkPhysicalDeviceFeatures m_enabled_features{};
     const bool m_enable_validation_layers =
 #ifdef NDEBUG
         false;
@@ -1,11 +1,19 @@
 #include "application.h"
 #include "win32_config.h"
 #include "logger.h"
+#include "startup_trace.h"
+#include "profiler.h"
+#include "scene_file.h"
 #include <cassert>
+#include <cstdlib>
 
 namespace juce
 {
 
+// F12 captures this many frames, written relative to the working directory
+static const uint32_t PROFILE_CAPTURE_FRAMES = 120;
+static const char* PROFILE_CAPTURE_PATH = "profile.json";
+
 LRESULT WINAPI static_wnd_proc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
 {
     application* app = nullptr;
@@ -51,14 +59,57 @@ LRESULT WINAPI static_wnd_proc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp)
 }
 
 application::application(int args, char* argv[], int cx, int cy)
-    : m_hwnd(nullptr), m_context(nullptr)
+    : m_hwnd(nullptr), m_context(nullptr), m_scene(nullptr)
+{
+    startup_trace::get_instance()->start();
+    JUCE_PROFILE_THREAD("main");
+
+#if JUCE_ENABLE_PROFILER
+    // JUCE_PROFILE_CAPTURE=120 writes a trace of the first 120 frames to profile.json
+    if (const char* capture = std::getenv("JUCE_PROFILE_CAPTURE"))
+    {
+        profiler::get_instance()->capture_frames(static_cast<uint32_t>(std::atoi(capture)), PROFILE_CAPTURE_PATH);
+    }
+#endif
+
+    // Instance creation and shader / cache reads need no window, so they run while it is created
+    m_context = new context();
+    m_context->begin_initialize();
+
+    HINSTANCE hinstance = GetModuleHandle(nullptr);
+    if (!create_window(hinstance, cx, cy))
+    {
+        delete m_context;
+        m_context = nullptr;
+        return;
+    }
+
+    // Initialize backend Renderer
+    {
+        startup_phase phase("context::initialize");
+        if (!m_context->initialize(m_hwnd, hinstance, cx, cy))
+        {
+            log_error("Failed to initialize backend");
+            delete m_context;
+            m_context = nullptr;
+            return;
+        }
+    }
+
+    ::ShowWindow(m_hwnd, SW_SHOW);
+    log_info("%s window created with Vulkan", "Juce Engine");
+}
+
+bool application::create_window(HINSTANCE hinstance, int cx, int cy)
 {
+    startup_phase phase("application::create_window");
+
     // 1. Register the window class
     WNDCLASSEXA wc{};
     wc.cbSize = sizeof(WNDCLASSEXA);
     wc.style = CS_HREDRAW | CS_VREDRAW;
     wc.lpfnWndProc = static_wnd_proc;
-    wc.hInstance = GetModuleHandle(nullptr);
+    wc.hInstance = hinstance;
     wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
     wc.hbrBackground = (HBRUSH)GetStockObject(DKGRAY_BRUSH);
     wc.lpszClassName = "Juce Engine";
@@ -67,7 +118,7 @@ application::application(int args, char* argv[], int cx, int cy)
     if (!::RegisterClassExA(&wc))
     {
         assert(0 && "failed to registered class");
-        return;
+        return false;
     }
 
     // 2. Create the window
@@ -89,19 +140,7 @@ application::application(int args, char* argv[], int cx, int cy)
     );
 
     assert(m_hwnd && L"failed to create window");
-
-    // Initialize backend Renderer
-    m_context = new context();
-    if (!m_context->initialize(m_hwnd, wc.hInstance, cx, cy))
-    {
-        log_error("Failed to initialize backend");
-        delete m_context;
-        m_context = nullptr;
-        return;
-    }
-
-    ::ShowWindow(m_hwnd, SW_SHOW);
-    log_info("%s window created with Vulkan", wc.lpszClassName);
+    return m_hwnd != nullptr;
 }
 
 application::~application()
@@ -113,8 +152,10 @@ application::~application()
     // HWND is destroyed by the OS
 }
 
-int application::exec(void* scene)
+int application::exec(scene_file* scene)
 {
+    m_scene = scene;
+
     MSG msg{};
     while (msg.message != WM_QUIT)
     {
@@ -124,20 +165,42 @@ int application::exec(void* scene)
             {
                 PostQuitMessage(0);
             }
+#if JUCE_ENABLE_PROFILER
+            if (msg.message == WM_KEYDOWN && msg.wParam == VK_F12)
+            {
+                profiler::get_instance()->capture_frames(PROFILE_CAPTURE_FRAMES, PROFILE_CAPTURE_PATH);
+            }
+#endif
             ::TranslateMessage(&msg);
             ::DispatchMessage(&msg);
         }
 
         // Main loop logic
-        update();
-        render();
+        {
+            JUCE_PROFILE_SCOPE("application::update");
+            update();
+        }
+        {
+            JUCE_PROFILE_SCOPE("application::render");
+            render();
+        }
+        JUCE_PROFILE_FRAME();
+
+        // No-op once a renderer has reported its first present
+        startup_trace::get_instance()->mark_first_frame();
     }
+    m_scene = nullptr;
     return static_cast<int>(msg.wParam);
 }
 
 void application::update()
 {
     // Game/application logic updates go here
+    if (m_scene)
+    {
+        // Sub-scenes mapped by the streaming worker become visible here, between frames
+        m_scene->update();
+    }
 }
 
 void application::render()
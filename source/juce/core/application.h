@@ -7,6 +7,7 @@
 namespace juce
 {
 class vk_context;
+class scene_file;
 } // namespace juce
 
 namespace juce
@@ -18,7 +19,8 @@ public:
     application(int args, char* argv[], int cx, int cy);
     ~application();
 
-    int exec(void* scene);
+    // scene은 소유하지 않음 (nullptr 가능), 매 프레임 끝난 sub-scene 로드를 반영
+    int exec(scene_file* scene);
     void update();
     void render();
 
@@ -29,8 +31,12 @@ public:
     HWND get_hwnd() const;
 
 private:
+    // 창 클래스 등록 + 창 생성 (표시는 context 초기화 후)
+    bool create_window(HINSTANCE hinstance, int cx, int cy);
+
     HWND m_hwnd;
     context* m_context;
+    scene_file* m_scene; // exec 동안만, 소유하지 않음
 };
 
 } // namespace juce
\ No newline at end of file
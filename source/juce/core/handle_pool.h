@@ -0,0 +1,142 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+namespace juce
+{
+
+/**
+ * generational handle (index + generation)
+ * - Tag로 타입 구분: buffer handle을 image handle 자리에 넘길 수 없음
+ * - generation 0은 항상 무효 (기본 생성 handle)
+ */
+template <typename Tag>
+struct handle
+{
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    bool is_valid() const { return generation != 0; }
+
+    bool operator==(const handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const handle& other) const { return !(*this == other); }
+};
+
+/**
+ * handle로 접근하는 dense pool
+ * - 값은 빈틈없는 배열(dense)에 저장, 순회가 캐시 친화적
+ * - slot 배열이 handle index -> dense 위치를 매핑, 제거 시 마지막 원소와 swap
+ * - 제거된 slot은 generation이 올라가므로 오래된 handle은 get에서 nullptr
+ */
+template <typename T, typename Tag = T>
+class handle_pool
+{
+public:
+    using handle_type = handle<Tag>;
+
+    handle_type insert(T value)
+    {
+        uint32_t slot_index;
+        if (!m_free_slots.empty())
+        {
+            slot_index = m_free_slots.back();
+            m_free_slots.pop_back();
+        }
+        else
+        {
+            slot_index = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back({0, 1});
+        }
+
+        m_slots[slot_index].dense = static_cast<uint32_t>(m_dense.size());
+        m_dense.push_back(std::move(value));
+        m_dense_to_slot.push_back(slot_index);
+        return {slot_index, m_slots[slot_index].generation};
+    }
+
+    T* get(handle_type h)
+    {
+        if (!contains(h))
+            return nullptr;
+        return &m_dense[m_slots[h.index].dense];
+    }
+
+    const T* get(handle_type h) const
+    {
+        if (!contains(h))
+            return nullptr;
+        return &m_dense[m_slots[h.index].dense];
+    }
+
+    bool contains(handle_type h) const
+    {
+        return h.is_valid() && h.index < m_slots.size() && m_slots[h.index].generation == h.generation;
+    }
+
+    // 제거된 값은 out으로 넘겨줌 (해제를 호출자가 처리)
+    bool remove(handle_type h, T* out = nullptr)
+    {
+        if (!contains(h))
+            return false;
+
+        slot& removed = m_slots[h.index];
+        uint32_t dense_index = removed.dense;
+        uint32_t last = static_cast<uint32_t>(m_dense.size()) - 1;
+
+        if (out)
+        {
+            *out = std::move(m_dense[dense_index]);
+        }
+        if (dense_index != last)
+        {
+            m_dense[dense_index] = std::move(m_dense[last]);
+            m_dense_to_slot[dense_index] = m_dense_to_slot[last];
+            m_slots[m_dense_to_slot[dense_index]].dense = dense_index;
+        }
+        m_dense.pop_back();
+        m_dense_to_slot.pop_back();
+
+        // Skip 0 on wrap-around so a recycled slot never matches a default handle
+        removed.generation = removed.generation + 1 != 0 ? removed.generation + 1 : 1;
+        m_free_slots.push_back(h.index);
+        return true;
+    }
+
+    void clear()
+    {
+        for (uint32_t slot_index : m_dense_to_slot)
+        {
+            slot& s = m_slots[slot_index];
+            s.generation = s.generation + 1 != 0 ? s.generation + 1 : 1;
+            m_free_slots.push_back(slot_index);
+        }
+        m_dense.clear();
+        m_dense_to_slot.clear();
+    }
+
+    // dense 순회 (순서는 제거 시 바뀜)
+    typename std::vector<T>::iterator begin() { return m_dense.begin(); }
+    typename std::vector<T>::iterator end() { return m_dense.end(); }
+    typename std::vector<T>::const_iterator begin() const { return m_dense.begin(); }
+    typename std::vector<T>::const_iterator end() const { return m_dense.end(); }
+
+    size_t size() const { return m_dense.size(); }
+    bool empty() const { return m_dense.empty(); }
+
+private:
+    struct slot
+    {
+        uint32_t dense;
+        uint32_t generation;
+    };
+
+    std::vector<T> m_dense;
+    std::vector<uint32_t> m_dense_to_slot;
+    std::vector<slot> m_slots;
+    std::vector<uint32_t> m_free_slots;
+};
+
+} // namespace juce
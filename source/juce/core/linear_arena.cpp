@@ -0,0 +1,156 @@
+#include "linear_arena.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace juce
+{
+
+static size_t align_up(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+linear_arena::linear_arena(size_t capacity)
+    : m_base(nullptr), m_capacity(0), m_offset(0), m_used(0), m_high_water(0)
+{
+    if (capacity > 0)
+    {
+        m_base = static_cast<char*>(std::malloc(capacity));
+        if (!m_base)
+        {
+            throw std::bad_alloc();
+        }
+        m_capacity = capacity;
+    }
+}
+
+linear_arena::~linear_arena()
+{
+    release();
+}
+
+linear_arena::linear_arena(linear_arena&& other) noexcept
+    : m_base(other.m_base), m_capacity(other.m_capacity), m_offset(other.m_offset), m_used(other.m_used), m_high_water(other.m_high_water), m_overflow(std::move(other.m_overflow))
+{
+    other.m_base = nullptr;
+    other.m_capacity = 0;
+    other.m_offset = 0;
+    other.m_used = 0;
+    other.m_overflow.clear();
+}
+
+linear_arena& linear_arena::operator=(linear_arena&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        m_base = other.m_base;
+        m_capacity = other.m_capacity;
+        m_offset = other.m_offset;
+        m_used = other.m_used;
+        m_high_water = other.m_high_water;
+        m_overflow = std::move(other.m_overflow);
+
+        other.m_base = nullptr;
+        other.m_capacity = 0;
+        other.m_offset = 0;
+        other.m_used = 0;
+        other.m_overflow.clear();
+    }
+    return *this;
+}
+
+void* linear_arena::allocate(size_t size, size_t alignment)
+{
+    if (size == 0)
+    {
+        size = 1;
+    }
+
+    // Align the address itself, the base block is only malloc-aligned
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_base);
+    size_t offset = align_up(base + m_offset, alignment) - base;
+    if (m_base && offset + size <= m_capacity)
+    {
+        m_used += offset + size - m_offset;
+        m_offset = offset + size;
+        return m_base + offset;
+    }
+
+    // Out of space: serve from a dedicated block until the next reset grows the arena
+    char* block = static_cast<char*>(std::malloc(size + alignment));
+    if (!block)
+    {
+        throw std::bad_alloc();
+    }
+    m_overflow.push_back(block);
+    m_used += size + alignment;
+
+    uintptr_t aligned = align_up(reinterpret_cast<uintptr_t>(block), alignment);
+    return reinterpret_cast<void*>(aligned);
+}
+
+void linear_arena::reset()
+{
+    if (m_used > m_high_water)
+    {
+        m_high_water = m_used;
+    }
+
+    if (!m_overflow.empty())
+    {
+        for (char* block : m_overflow)
+        {
+            std::free(block);
+        }
+        m_overflow.clear();
+
+        // Grow once to the peak so the same workload fits without overflow next time
+        size_t capacity = align_up(m_high_water + m_high_water / 4, 4096);
+        std::free(m_base);
+        m_base = static_cast<char*>(std::malloc(capacity));
+        if (!m_base)
+        {
+            m_capacity = 0;
+            throw std::bad_alloc();
+        }
+        m_capacity = capacity;
+    }
+
+    m_offset = 0;
+    m_used = 0;
+}
+
+void linear_arena::release()
+{
+    for (char* block : m_overflow)
+    {
+        std::free(block);
+    }
+    m_overflow.clear();
+    std::free(m_base);
+    m_base = nullptr;
+    m_capacity = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+void frame_arena::initialize(uint32_t frame_count, size_t capacity_per_frame)
+{
+    m_arenas.clear();
+    m_arenas.reserve(frame_count);
+    for (uint32_t i = 0; i < frame_count; i++)
+    {
+        m_arenas.emplace_back(capacity_per_frame);
+    }
+    m_current = 0;
+}
+
+void frame_arena::begin_frame(uint32_t frame_index)
+{
+    m_current = frame_index;
+    m_arenas[m_current].reset();
+}
+
+} // namespace juce
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace juce
+{
+
+/**
+ * linear (bump) arena
+ * - allocate는 포인터 증가만, 개별 해제 없음, reset으로 한 번에 해제
+ * - 용량 초과 시 임시 블록으로 넘치고, 다음 reset에서 최대 사용량만큼 키움
+ *   -> 정상 상태(steady state)에서는 malloc 0회
+ */
+class linear_arena
+{
+public:
+    explicit linear_arena(size_t capacity = 0);
+    ~linear_arena();
+
+    linear_arena(const linear_arena&) = delete;
+    linear_arena& operator=(const linear_arena&) = delete;
+    linear_arena(linear_arena&& other) noexcept;
+    linear_arena& operator=(linear_arena&& other) noexcept;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void reset();
+
+    template <typename T>
+    T* allocate_array(size_t count)
+    {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Getters
+    size_t get_used() const { return m_used; }
+    size_t get_capacity() const { return m_capacity; }
+    size_t get_high_water() const { return m_high_water; }
+
+private:
+    void release();
+
+    char* m_base;
+    size_t m_capacity;
+    size_t m_offset;
+    size_t m_used;       // 이번 프레임 사용량 (넘친 블록 포함)
+    size_t m_high_water; // 지금까지의 최대 사용량
+    std::vector<char*> m_overflow;
+};
+
+/**
+ * frames in flight 수만큼 arena를 두고 프레임 슬롯마다 돌려 쓰는 arena
+ * - begin_frame(slot): 해당 슬롯의 GPU 작업이 끝난 뒤 호출, 그 슬롯 arena를 reset
+ */
+class frame_arena
+{
+public:
+    frame_arena() = default;
+
+    void initialize(uint32_t frame_count, size_t capacity_per_frame);
+    void begin_frame(uint32_t frame_index);
+
+    linear_arena& current() { return m_arenas[m_current]; }
+
+private:
+    std::vector<linear_arena> m_arenas;
+    uint32_t m_current = 0;
+};
+
+// STL 호환 allocator: deallocate는 아무것도 하지 않음 (arena reset에서 해제)
+template <typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+
+    arena_allocator(linear_arena& arena) noexcept
+        : m_arena(&arena)
+    {
+    }
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& other) noexcept
+        : m_arena(other.get_arena())
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        return m_arena->allocate_array<T>(count);
+    }
+
+    void deallocate(T*, size_t) noexcept
+    {
+    }
+
+    linear_arena* get_arena() const noexcept { return m_arena; }
+
+private:
+    linear_arena* m_arena;
+};
+
+template <typename T, typename U>
+bool operator==(const arena_allocator<T>& a, const arena_allocator<U>& b) noexcept
+{
+    return a.get_arena() == b.get_arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const arena_allocator<T>& a, const arena_allocator<U>& b) noexcept
+{
+    return !(a == b);
+}
+
+template <typename T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+} // namespace juce
@@ -0,0 +1,279 @@
+// profiler는 "각 프레임의 시간이 어느 스레드 어디에 쓰였는가"를 책임
+#include "profiler.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace juce
+{
+
+// 32K events * 24 bytes per recording thread, allocated on the thread's first captured event
+static const uint32_t EVENTS_PER_THREAD = 1u << 15;
+// GPU results of the last captured frames arrive this many frames later
+static const uint32_t CAPTURE_DRAIN_FRAMES = 4;
+
+// Chrome trace tids: frames and GPU get fixed tracks, CPU threads follow
+static const uint32_t FRAME_TRACK = 0;
+static const uint32_t GPU_TRACK = 1;
+static const uint32_t FIRST_THREAD_TRACK = 2;
+
+static void append_json_string(std::string& out, const char* text)
+{
+    out += '"';
+    for (const char* c = text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            out += '\\';
+            out += *c;
+        }
+        else if (static_cast<unsigned char>(*c) < 0x20)
+        {
+            out += ' ';
+        }
+        else
+        {
+            out += *c;
+        }
+    }
+    out += '"';
+}
+
+static void append_complete_event(std::string& out, const char* name, uint32_t tid, double ts_us, double dur_us)
+{
+    char buffer[128];
+    out += "{\"ph\":\"X\",\"name\":";
+    append_json_string(out, name);
+    std::snprintf(buffer, sizeof(buffer), ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n", tid, ts_us, dur_us);
+    out += buffer;
+}
+
+static void append_thread_name(std::string& out, uint32_t tid, const char* name)
+{
+    char buffer[96];
+    std::snprintf(buffer, sizeof(buffer), "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", tid);
+    out += buffer;
+    append_json_string(out, name);
+    std::snprintf(buffer, sizeof(buffer), "}},\n{\"ph\":\"M\",\"name\":\"thread_sort_index\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}},\n", tid, tid);
+    out += buffer;
+}
+
+profiler::thread_buffer::thread_buffer(uint32_t capacity)
+    : events(new event[capacity]), mask(capacity - 1), head(0), index(0), name(nullptr)
+{
+}
+
+profiler* profiler::get_instance()
+{
+    static profiler instance;
+    return &instance;
+}
+
+uint64_t profiler::now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+profiler::profiler()
+    : m_capturing(false),
+      m_gpu(new thread_buffer(EVENTS_PER_THREAD)),
+      m_frame_number(0),
+      m_requested_frames(0),
+      m_remaining_frames(0),
+      m_drain_frames(0),
+      m_capture_begin_ns(0),
+      m_capture_end_ns(0),
+      m_first_frame_number(0)
+{
+    m_gpu->index = GPU_TRACK;
+    m_gpu->name = "GPU";
+}
+
+void profiler::capture_frames(uint32_t frame_count, const std::string& path)
+{
+    if (frame_count == 0)
+        return;
+
+    if (is_busy())
+    {
+        log_warn("Profiler: a capture is already in progress, ignoring the request for %u frames", frame_count);
+        return;
+    }
+
+    m_requested_frames = frame_count;
+    m_path = path;
+    log_info("Profiler: capturing %u frames to %s", frame_count, path.c_str());
+}
+
+bool profiler::is_busy() const
+{
+    return m_requested_frames > 0 || m_remaining_frames > 0 || m_drain_frames > 0;
+}
+
+void profiler::mark_frame()
+{
+    uint64_t now = now_ns();
+
+    if (m_remaining_frames > 0)
+    {
+        m_frame_begins.push_back(now);
+        if (--m_remaining_frames == 0)
+        {
+            m_capturing.store(false, std::memory_order_relaxed);
+            m_capture_end_ns = now;
+            m_drain_frames = CAPTURE_DRAIN_FRAMES;
+        }
+    }
+    else if (m_drain_frames > 0 && --m_drain_frames == 0)
+    {
+        uint32_t frames = static_cast<uint32_t>(m_frame_begins.size() - 1);
+        if (write_chrome_trace(m_path))
+        {
+            log_info("Profiler: wrote %u frames (%.2f ms) to %s", frames, (m_capture_end_ns - m_capture_begin_ns) / 1e6, m_path.c_str());
+        }
+        else
+        {
+            log_warn("Profiler: failed to write %s", m_path.c_str());
+        }
+    }
+
+    // Captures start on a frame boundary so every captured frame is complete
+    if (m_requested_frames > 0 && m_remaining_frames == 0 && m_drain_frames == 0)
+    {
+        m_remaining_frames = m_requested_frames;
+        m_requested_frames = 0;
+        m_capture_begin_ns = now;
+        m_capture_end_ns = now;
+        m_first_frame_number = m_frame_number;
+        m_frame_begins.clear();
+        m_frame_begins.push_back(now);
+        m_capturing.store(true, std::memory_order_relaxed);
+    }
+
+    m_frame_number++;
+}
+
+uint64_t profiler::get_frame_number() const
+{
+    return m_frame_number;
+}
+
+void profiler::set_thread_name(const char* name)
+{
+    // Named threads register up front, even if they never record
+    thread_buffer* buffer = get_thread_buffer();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    buffer->name = name;
+}
+
+profiler::thread_buffer* profiler::get_thread_buffer()
+{
+    static thread_local thread_buffer* t_buffer = nullptr;
+    if (t_buffer)
+        return t_buffer;
+
+    // Buffers outlive their threads so an export never reads freed memory
+    std::unique_ptr<thread_buffer> buffer(new thread_buffer(EVENTS_PER_THREAD));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    buffer->index = FIRST_THREAD_TRACK + static_cast<uint32_t>(m_threads.size());
+    m_threads.push_back(std::move(buffer));
+    t_buffer = m_threads.back().get();
+    return t_buffer;
+}
+
+void profiler::push(thread_buffer& buffer, const char* name, uint64_t begin_ns, uint64_t end_ns)
+{
+    // Single writer: the slot is filled before the new head is published to the exporter
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head & buffer.mask] = {name, begin_ns, end_ns};
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void profiler::record(const char* name, uint64_t begin_ns, uint64_t end_ns)
+{
+    // Scopes still open when the capture ends are dropped; at most one write per thread can race the export
+    if (!is_capturing())
+        return;
+
+    push(*get_thread_buffer(), name, begin_ns, end_ns);
+}
+
+void profiler::record_gpu(const char* name, uint64_t begin_ns, uint64_t end_ns)
+{
+    push(*m_gpu, name, begin_ns, end_ns);
+}
+
+bool profiler::write_chrome_trace(const std::string& path) const
+{
+    if (m_frame_begins.size() < 2)
+        return false;
+
+    std::vector<std::pair<const thread_buffer*, const char*>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& buffer : m_threads)
+        {
+            buffers.emplace_back(buffer.get(), buffer->name);
+        }
+    }
+
+    const double origin = static_cast<double>(m_capture_begin_ns);
+    std::string out;
+    out.reserve(1 << 20);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out += "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"juce\"}},\n";
+
+    append_thread_name(out, FRAME_TRACK, "Frames");
+    for (size_t i = 0; i + 1 < m_frame_begins.size(); i++)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "Frame %llu", static_cast<unsigned long long>(m_first_frame_number + i));
+        append_complete_event(out, name, FRAME_TRACK, (m_frame_begins[i] - origin) / 1e3, (m_frame_begins[i + 1] - m_frame_begins[i]) / 1e3);
+    }
+
+    auto append_buffer = [&](const thread_buffer& buffer, const char* name, uint64_t readable)
+    {
+        char fallback[32];
+        if (!name)
+        {
+            std::snprintf(fallback, sizeof(fallback), "Thread %u", buffer.index - FIRST_THREAD_TRACK);
+            name = fallback;
+        }
+        append_thread_name(out, buffer.index, name);
+
+        uint64_t head = buffer.head.load(std::memory_order_acquire);
+        uint64_t count = std::min(head, readable);
+        for (uint64_t i = head - count; i < head; i++)
+        {
+            const event& e = buffer.events[i & buffer.mask];
+            // Rings are never cleared, so older captures are filtered out by time
+            if (e.begin_ns < m_capture_begin_ns || e.begin_ns >= m_capture_end_ns)
+                continue;
+            append_complete_event(out, e.name, buffer.index, (e.begin_ns - origin) / 1e3, (e.end_ns - e.begin_ns) / 1e3);
+        }
+    };
+
+    // The GPU track is written on this thread; a CPU ring may still take one late write,
+    // which lands in its oldest slot, so only the newest capacity - 1 events are read
+    append_buffer(*m_gpu, m_gpu->name, m_gpu->mask + 1);
+    for (const auto& [buffer, name] : buffers)
+    {
+        append_buffer(*buffer, name, buffer->mask);
+    }
+
+    // Every entry above ends with a comma; this one closes the array
+    out += "{\"ph\":\"M\",\"name\":\"process_sort_index\",\"pid\":1,\"args\":{\"sort_index\":0}}\n]}\n";
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+} // namespace juce
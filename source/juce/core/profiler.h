@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+// CMake 옵션 JUCE_PROFILER (기본 ON), 끄면 아래 매크로는 코드를 만들지 않음
+#ifndef JUCE_ENABLE_PROFILER
+#define JUCE_ENABLE_PROFILER 1
+#endif
+
+#if JUCE_ENABLE_PROFILER
+#define JUCE_PROFILE_CONCAT_INNER(a, b) a##b
+#define JUCE_PROFILE_CONCAT(a, b) JUCE_PROFILE_CONCAT_INNER(a, b)
+// 범위 측정, name은 문자열 리터럴 (복사하지 않음)
+#define JUCE_PROFILE_SCOPE(name) ::juce::profile_scope JUCE_PROFILE_CONCAT(juce_profile_scope_, __LINE__)(name)
+// 프레임 경계 (메인 루프에서 한 번)
+#define JUCE_PROFILE_FRAME() ::juce::profiler::get_instance()->mark_frame()
+// 보고서에 표시할 현재 스레드 이름 (문자열 리터럴)
+#define JUCE_PROFILE_THREAD(name) ::juce::profiler::get_instance()->set_thread_name(name)
+#else
+#define JUCE_PROFILE_SCOPE(name) ((void)0)
+#define JUCE_PROFILE_FRAME() ((void)0)
+#define JUCE_PROFILE_THREAD(name) ((void)0)
+#endif
+
+namespace juce
+{
+
+/**
+ * profiler
+ * - 관리: 스레드별 이벤트 ring buffer, GPU 트랙, 캡처할 프레임 구간, Chrome trace 내보내기
+ * - 캡처 중이 아닐 때 범위 하나의 비용은 atomic load 한 번
+ * - 기록은 스레드별 단일 작성자 (lock 없음), 스레드 등록만 lock
+ * - 시간은 steady_clock 기준 ns, GPU 시간은 gpu_profiler가 같은 기준으로 변환해 넘김
+ * - 결과는 chrome://tracing 또는 ui.perfetto.dev에서 열기
+ */
+class profiler
+{
+public:
+    static profiler* get_instance();
+
+    // steady_clock 기준 현재 시각 (ns)
+    static uint64_t now_ns();
+
+    // 다음 프레임 경계부터 frame_count 프레임을 캡처해 path로 내보냄
+    // - GPU 결과가 도착하도록 끝난 뒤 몇 프레임 더 기다렸다가 씀
+    void capture_frames(uint32_t frame_count, const std::string& path);
+    bool is_capturing() const { return m_capturing.load(std::memory_order_relaxed); }
+    // 캡처 요청부터 파일을 쓸 때까지
+    bool is_busy() const;
+
+    // 메인 스레드, 프레임 경계마다 호출: 캡처 시작 / 종료 / 내보내기
+    void mark_frame();
+    uint64_t get_frame_number() const;
+
+    // 현재 스레드 이름 (문자열 리터럴)
+    void set_thread_name(const char* name);
+
+    // 현재 스레드의 ring buffer에 완료된 범위 기록 (캡처 중일 때만)
+    void record(const char* name, uint64_t begin_ns, uint64_t end_ns);
+    // GPU 트랙에 기록 (메인 스레드, 캡처가 끝난 뒤 도착한 결과도 받음)
+    void record_gpu(const char* name, uint64_t begin_ns, uint64_t end_ns);
+
+    // 마지막 캡처 구간을 Chrome trace JSON으로 저장
+    bool write_chrome_trace(const std::string& path) const;
+
+private:
+    profiler();
+
+    struct event
+    {
+        const char* name;
+        uint64_t begin_ns;
+        uint64_t end_ns;
+    };
+
+    // 스레드 하나의 ring buffer (작성자는 그 스레드뿐)
+    struct thread_buffer
+    {
+        explicit thread_buffer(uint32_t capacity);
+
+        std::unique_ptr<event[]> events;
+        uint32_t mask;
+        std::atomic<uint64_t> head; // 지금까지 쓴 이벤트 수
+        uint32_t index;             // trace의 tid
+        const char* name;
+    };
+
+    thread_buffer* get_thread_buffer();
+    static void push(thread_buffer& buffer, const char* name, uint64_t begin_ns, uint64_t end_ns);
+
+    std::atomic<bool> m_capturing;
+
+    mutable std::mutex m_mutex; // 스레드 등록
+    std::vector<std::unique_ptr<thread_buffer>> m_threads;
+    std::unique_ptr<thread_buffer> m_gpu;
+
+    // 메인 스레드 전용
+    uint64_t m_frame_number;
+    uint32_t m_requested_frames; // 다음 경계에서 시작할 캡처 길이 (0이면 없음)
+    uint32_t m_remaining_frames; // 캡처 중 남은 프레임
+    uint32_t m_drain_frames;     // 캡처 후 내보내기까지 남은 프레임
+    std::string m_path;
+    uint64_t m_capture_begin_ns;
+    uint64_t m_capture_end_ns;
+    std::vector<uint64_t> m_frame_begins; // 캡처 구간의 프레임 시작 시각
+    uint64_t m_first_frame_number;
+};
+
+// 범위 동안의 CPU 이벤트 (JUCE_PROFILE_SCOPE로 사용)
+class profile_scope
+{
+public:
+    explicit profile_scope(const char* name)
+        : m_name(name), m_begin(profiler::get_instance()->is_capturing() ? profiler::now_ns() : 0)
+    {
+    }
+
+    ~profile_scope()
+    {
+        if (m_begin != 0)
+        {
+            profiler::get_instance()->record(m_name, m_begin, profiler::now_ns());
+        }
+    }
+
+    profile_scope(const profile_scope&) = delete;
+    profile_scope& operator=(const profile_scope&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_begin; // 캡처 중이 아니었으면 0
+};
+
+} // namespace juce
@@ -0,0 +1,255 @@
+// scene은 "scene 데이터의 디스크 / 메모리 공용 레이아웃"을 책임
+#include "scene.h"
+#include "logger.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace juce
+{
+
+static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Every column lies after the header, inside the blob and on a column boundary
+template <typename T>
+static bool check_column(const scene_ref<T>& ref, uint64_t count, uint64_t blob_size)
+{
+    if (count == 0)
+        return true;
+    if (ref.offset < sizeof(scene) || ref.offset % SCENE_COLUMN_ALIGNMENT != 0 || ref.offset > blob_size)
+        return false;
+    return count * sizeof(T) <= blob_size - ref.offset;
+}
+
+template <typename T>
+static void fix_column(scene_ref<T>& ref, uint64_t count, char* base)
+{
+    ref.pointer = count != 0 ? reinterpret_cast<T*>(base + ref.offset) : nullptr;
+}
+
+bool scene_fixup(void* blob, size_t size)
+{
+    if (size < sizeof(scene) || reinterpret_cast<uintptr_t>(blob) % SCENE_COLUMN_ALIGNMENT != 0)
+        return false;
+
+    scene* s = static_cast<scene*>(blob);
+    if (s->magic != SCENE_MAGIC || s->version != SCENE_VERSION || s->size < sizeof(scene) || s->size > size)
+        return false;
+
+    // O(columns): per-element data (parents, name offsets) is trusted as written by scene_builder
+    const uint64_t objects = s->object_count;
+    const uint64_t lights = s->light_count;
+    bool valid = check_column(s->positions, objects, s->size) &&
+                 check_column(s->rotations, objects, s->size) &&
+                 check_column(s->scales, objects, s->size) &&
+                 check_column(s->bounds, objects, s->size) &&
+                 check_column(s->parents, objects, s->size) &&
+                 check_column(s->first_vertices, objects, s->size) &&
+                 check_column(s->vertex_counts, objects, s->size) &&
+                 check_column(s->names, objects, s->size) &&
+                 check_column(s->light_positions, lights, s->size) &&
+                 check_column(s->light_colors, lights, s->size) &&
+                 check_column(s->chunks, s->chunk_count, s->size) &&
+                 check_column(s->strings, s->string_bytes, s->size);
+    if (!valid)
+        return false;
+
+    char* base = static_cast<char*>(blob);
+    if (s->string_bytes != 0 && base[s->strings.offset + s->string_bytes - 1] != '\0')
+        return false;
+
+    fix_column(s->positions, objects, base);
+    fix_column(s->rotations, objects, base);
+    fix_column(s->scales, objects, base);
+    fix_column(s->bounds, objects, base);
+    fix_column(s->parents, objects, base);
+    fix_column(s->first_vertices, objects, base);
+    fix_column(s->vertex_counts, objects, base);
+    fix_column(s->names, objects, base);
+    fix_column(s->light_positions, lights, base);
+    fix_column(s->light_colors, lights, base);
+    fix_column(s->chunks, s->chunk_count, base);
+    fix_column(s->strings, s->string_bytes, base);
+    return true;
+}
+
+const char* get_scene_string(const scene& s, uint32_t offset)
+{
+    // The last byte is a terminator (checked by scene_fixup), so any in-range offset is a valid string
+    if (offset >= s.string_bytes)
+        return "";
+    return s.strings.get() + offset;
+}
+
+uint32_t scene_builder::add_string(const char* text)
+{
+    if (m_strings.empty())
+    {
+        // Offset 0 is the empty string
+        m_strings.push_back('\0');
+    }
+    if (!text || text[0] == '\0')
+        return 0;
+
+    uint32_t offset = static_cast<uint32_t>(m_strings.size());
+    m_strings.insert(m_strings.end(), text, text + std::strlen(text) + 1);
+    return offset;
+}
+
+uint32_t scene_builder::add_object(const scene_object_desc& desc)
+{
+    uint32_t index = get_object_count();
+    if (desc.parent != SCENE_NO_PARENT && desc.parent >= index)
+    {
+        log_warn("scene object %u: parent %u is not an earlier object, stored as a root", index, desc.parent);
+    }
+
+    m_positions.insert(m_positions.end(), desc.position, desc.position + 3);
+    m_rotations.insert(m_rotations.end(), desc.rotation, desc.rotation + 4);
+    m_scales.insert(m_scales.end(), desc.scale, desc.scale + 3);
+    m_bounds.insert(m_bounds.end(), desc.bounds, desc.bounds + 4);
+    m_parents.push_back(desc.parent < index ? desc.parent : SCENE_NO_PARENT);
+    m_first_vertices.push_back(desc.first_vertex);
+    m_vertex_counts.push_back(desc.vertex_count);
+    m_names.push_back(add_string(desc.name));
+    return index;
+}
+
+uint32_t scene_builder::add_light(const scene_light_desc& desc)
+{
+    uint32_t index = get_light_count();
+    m_light_positions.insert(m_light_positions.end(), desc.position, desc.position + 3);
+    m_light_positions.push_back(desc.radius);
+    m_light_colors.insert(m_light_colors.end(), desc.color, desc.color + 3);
+    m_light_colors.push_back(desc.intensity);
+    return index;
+}
+
+uint32_t scene_builder::add_sub_scene(const char* name, const float bounds[4], const scene_builder& sub_scene)
+{
+    if (!sub_scene.m_sub_scenes.empty())
+    {
+        log_warn("sub-scene %s has its own sub-scenes, they are not stored", name ? name : "");
+    }
+
+    m_sub_scenes.push_back({});
+    scene_builder::sub_scene& entry = m_sub_scenes.back();
+    entry.name = add_string(name);
+    std::memcpy(entry.bounds, bounds, sizeof(entry.bounds));
+    entry.blob = sub_scene.build_blob({});
+    return static_cast<uint32_t>(m_sub_scenes.size() - 1);
+}
+
+std::vector<char> scene_builder::build_blob(const std::vector<scene_chunk>& chunks) const
+{
+    scene header{};
+    header.magic = SCENE_MAGIC;
+    header.version = SCENE_VERSION;
+    header.object_count = get_object_count();
+    header.light_count = get_light_count();
+    header.chunk_count = static_cast<uint32_t>(chunks.size());
+    header.string_bytes = static_cast<uint32_t>(m_strings.size());
+
+    // Columns are laid out in header order, each on a column boundary
+    uint64_t end = sizeof(scene);
+    auto place = [&end](uint64_t bytes)
+    {
+        uint64_t offset = align_up(end, SCENE_COLUMN_ALIGNMENT);
+        end = offset + bytes;
+        return offset;
+    };
+    header.positions.offset = place(m_positions.size() * sizeof(float));
+    header.rotations.offset = place(m_rotations.size() * sizeof(float));
+    header.scales.offset = place(m_scales.size() * sizeof(float));
+    header.bounds.offset = place(m_bounds.size() * sizeof(float));
+    header.parents.offset = place(m_parents.size() * sizeof(uint32_t));
+    header.first_vertices.offset = place(m_first_vertices.size() * sizeof(uint32_t));
+    header.vertex_counts.offset = place(m_vertex_counts.size() * sizeof(uint32_t));
+    header.names.offset = place(m_names.size() * sizeof(uint32_t));
+    header.light_positions.offset = place(m_light_positions.size() * sizeof(float));
+    header.light_colors.offset = place(m_light_colors.size() * sizeof(float));
+    header.chunks.offset = place(chunks.size() * sizeof(scene_chunk));
+    header.strings.offset = place(m_strings.size());
+    header.size = align_up(end, SCENE_COLUMN_ALIGNMENT);
+
+    std::vector<char> blob(header.size, 0);
+    auto copy = [&blob](uint64_t offset, const void* data, size_t bytes)
+    {
+        if (bytes != 0)
+        {
+            std::memcpy(blob.data() + offset, data, bytes);
+        }
+    };
+    copy(0, &header, sizeof(header));
+    copy(header.positions.offset, m_positions.data(), m_positions.size() * sizeof(float));
+    copy(header.rotations.offset, m_rotations.data(), m_rotations.size() * sizeof(float));
+    copy(header.scales.offset, m_scales.data(), m_scales.size() * sizeof(float));
+    copy(header.bounds.offset, m_bounds.data(), m_bounds.size() * sizeof(float));
+    copy(header.parents.offset, m_parents.data(), m_parents.size() * sizeof(uint32_t));
+    copy(header.first_vertices.offset, m_first_vertices.data(), m_first_vertices.size() * sizeof(uint32_t));
+    copy(header.vertex_counts.offset, m_vertex_counts.data(), m_vertex_counts.size() * sizeof(uint32_t));
+    copy(header.names.offset, m_names.data(), m_names.size() * sizeof(uint32_t));
+    copy(header.light_positions.offset, m_light_positions.data(), m_light_positions.size() * sizeof(float));
+    copy(header.light_colors.offset, m_light_colors.data(), m_light_colors.size() * sizeof(float));
+    copy(header.chunks.offset, chunks.data(), chunks.size() * sizeof(scene_chunk));
+    copy(header.strings.offset, m_strings.data(), m_strings.size());
+    return blob;
+}
+
+std::vector<char> scene_builder::build() const
+{
+    std::vector<scene_chunk> chunks(m_sub_scenes.size());
+    for (size_t i = 0; i < m_sub_scenes.size(); i++)
+    {
+        chunks[i].size = m_sub_scenes[i].blob.size();
+        chunks[i].name = m_sub_scenes[i].name;
+        std::memcpy(chunks[i].bounds, m_sub_scenes[i].bounds, sizeof(chunks[i].bounds));
+    }
+
+    // The root blob size does not depend on the chunk offsets, so they are patched in afterwards
+    std::vector<char> blob = build_blob(chunks);
+    const scene* header = reinterpret_cast<const scene*>(blob.data());
+    scene_chunk* table = reinterpret_cast<scene_chunk*>(blob.data() + header->chunks.offset);
+    uint64_t offset = align_up(blob.size(), SCENE_BLOB_ALIGNMENT);
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        table[i].offset = offset;
+        offset = align_up(offset + table[i].size, SCENE_BLOB_ALIGNMENT);
+    }
+    return blob;
+}
+
+bool scene_builder::write(const std::string& path) const
+{
+    std::vector<char> root = build();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        log_error("Failed to open %s for writing", path.c_str());
+        return false;
+    }
+
+    file.write(root.data(), static_cast<std::streamsize>(root.size()));
+    const std::vector<char> padding(SCENE_BLOB_ALIGNMENT, 0);
+    uint64_t written = root.size();
+    for (const sub_scene& sub : m_sub_scenes)
+    {
+        uint64_t offset = align_up(written, SCENE_BLOB_ALIGNMENT);
+        file.write(padding.data(), static_cast<std::streamsize>(offset - written));
+        file.write(sub.blob.data(), static_cast<std::streamsize>(sub.blob.size()));
+        written = offset + sub.blob.size();
+    }
+
+    if (!file)
+    {
+        log_error("Failed to write %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace juce
@@ -1,2 +1,164 @@
 #pragma once
 #include "typedef.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace juce
+{
+
+// 파일 앞 4바이트 "JSCN" (little-endian)
+static const uint32_t SCENE_MAGIC = 0x4E43534A;
+// 레이아웃이 바뀌면 올림, 다른 버전은 읽지 않음 (다시 export)
+static const uint32_t SCENE_VERSION = 1;
+// parents column의 루트 표시
+static const uint32_t SCENE_NO_PARENT = 0xFFFFFFFFu;
+// column 시작 정렬 (SIMD 로드)
+static const uint64_t SCENE_COLUMN_ALIGNMENT = 16;
+// sub-scene blob 시작 정렬 (MapViewOfFile offset 단위), blob마다 따로 mapping / 해제
+static const uint64_t SCENE_BLOB_ALIGNMENT = 64 * 1024;
+
+static_assert(sizeof(void*) == 8, "scene_ref keeps pointers in 64-bit offset slots");
+
+/**
+ * scene column 참조
+ * - 파일: blob 시작 기준 byte offset
+ * - scene_fixup 이후: 같은 자리의 포인터 (메모리에서 그대로 배열로 사용)
+ */
+template <typename T>
+struct scene_ref
+{
+    union
+    {
+        uint64_t offset;
+        T* pointer;
+    };
+
+    T& operator[](size_t index) const { return pointer[index]; }
+    T* get() const { return pointer; }
+};
+
+// root scene의 sub-scene 목록 항목
+struct scene_chunk
+{
+    uint64_t offset;  // 파일 안 blob 위치 (SCENE_BLOB_ALIGNMENT 정렬)
+    uint64_t size;    // blob 크기
+    float bounds[4];  // world sphere (center, radius), 스트리밍 거리 판단용
+    uint32_t name;    // strings 안 offset
+    uint32_t padding;
+};
+
+/**
+ * scene (SoA)
+ * - 메모리 레이아웃 = 파일 레이아웃: 이 header 뒤에 column 배열들, 포인터 대신 scene_ref offset
+ * - 로드 = mapping + scene_fixup (column 수만큼의 검사 + offset -> 포인터), 오브젝트 수와 무관하게 파싱 없음
+ * - 오브젝트 i = 모든 object column의 i번째 원소, 라이트 i = 모든 light column의 i번째 원소
+ * - sub-scene blob도 같은 구조 (chunk_count = 0)
+ */
+struct scene
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;          // blob 크기 (header 포함)
+    uint32_t object_count;
+    uint32_t light_count;
+    uint32_t chunk_count;
+    uint32_t string_bytes;
+
+    // objects
+    scene_ref<float[3]> positions;
+    scene_ref<float[4]> rotations;     // quaternion (x, y, z, w)
+    scene_ref<float[3]> scales;
+    scene_ref<float[4]> bounds;        // world sphere (center, radius)
+    scene_ref<uint32_t> parents;       // SCENE_NO_PARENT 또는 자기보다 앞 index
+    scene_ref<uint32_t> first_vertices;
+    scene_ref<uint32_t> vertex_counts;
+    scene_ref<uint32_t> names;         // strings 안 offset
+
+    // point lights
+    scene_ref<float[4]> light_positions; // xyz + radius
+    scene_ref<float[4]> light_colors;    // rgb + intensity
+
+    scene_ref<scene_chunk> chunks;
+    scene_ref<char> strings;             // '\0'로 끝나는 문자열들
+};
+
+static_assert(sizeof(scene) == 128, "scene header layout is part of the file format");
+
+// blob을 제자리에서 쓸 수 있게 만듦: 검증 후 offset -> 포인터, 실패 시 false (blob은 건드리지 않음)
+// - header 페이지만 씀 (copy-on-write mapping이면 그 페이지만 복사됨), 같은 blob에 두 번 호출하지 않음
+bool scene_fixup(void* blob, size_t size);
+
+// strings 안 offset -> 문자열 (fixup 이후)
+const char* get_scene_string(const scene& s, uint32_t offset);
+
+struct scene_object_desc
+{
+    const char* name = "";
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float rotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    float scale[3] = {1.0f, 1.0f, 1.0f};
+    float bounds[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    uint32_t first_vertex = 0;
+    uint32_t vertex_count = 0;
+    uint32_t parent = SCENE_NO_PARENT;
+};
+
+struct scene_light_desc
+{
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float radius = 1.0f;
+    float color[3] = {1.0f, 1.0f, 1.0f};
+    float intensity = 1.0f;
+};
+
+/**
+ * scene 파일 작성 (export / 도구용)
+ * - 관리: column별 std::vector, 문자열 테이블, sub-scene builder 복사본
+ * - 파일 = root blob | sub-scene blob들 (각각 SCENE_BLOB_ALIGNMENT 정렬)
+ */
+class scene_builder
+{
+public:
+    // 추가된 index 반환, parent는 이미 추가된 오브젝트여야 함 (아니면 루트로)
+    uint32_t add_object(const scene_object_desc& desc);
+    uint32_t add_light(const scene_light_desc& desc);
+    // sub-scene의 sub-scene은 저장하지 않음 (한 단계만)
+    uint32_t add_sub_scene(const char* name, const float bounds[4], const scene_builder& sub_scene);
+
+    // root blob 하나 (sub-scene 목록의 offset은 write 기준), 메모리에서 바로 fixup해 쓸 수도 있음
+    std::vector<char> build() const;
+    bool write(const std::string& path) const;
+
+    // Getters
+    uint32_t get_object_count() const { return static_cast<uint32_t>(m_positions.size() / 3); }
+    uint32_t get_light_count() const { return static_cast<uint32_t>(m_light_positions.size() / 4); }
+
+private:
+    uint32_t add_string(const char* text);
+    std::vector<char> build_blob(const std::vector<scene_chunk>& chunks) const;
+
+    std::vector<float> m_positions;
+    std::vector<float> m_rotations;
+    std::vector<float> m_scales;
+    std::vector<float> m_bounds;
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_first_vertices;
+    std::vector<uint32_t> m_vertex_counts;
+    std::vector<uint32_t> m_names;
+    std::vector<float> m_light_positions;
+    std::vector<float> m_light_colors;
+    std::vector<char> m_strings;
+
+    struct sub_scene
+    {
+        uint32_t name;
+        float bounds[4];
+        std::vector<char> blob;
+    };
+    std::vector<sub_scene> m_sub_scenes;
+};
+
+} // namespace juce
@@ -0,0 +1,392 @@
+// scene_file은 "scene 파일을 파싱 없이 메모리에 올리고 sub-scene을 필요한 만큼만 두는 것"을 책임
+#include "scene_file.h"
+#include "logger.h"
+#include "profiler.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include "win32_config.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace juce
+{
+
+// Smallest page size we map with; the prefetch touches one byte per page
+static const uint64_t PREFETCH_STRIDE = 4096;
+
+scene_file::scene_file()
+#ifdef _WIN32
+    : m_file(nullptr), m_mapping(nullptr),
+#else
+    : m_file(-1),
+#endif
+      m_file_size(0), m_root_size(0), m_root_data(nullptr), m_root(nullptr), m_stop(false)
+{
+}
+
+scene_file::~scene_file()
+{
+    close();
+}
+
+bool scene_file::open(const std::string& path)
+{
+    close();
+    m_path = path;
+
+    try
+    {
+        scene header{};
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("failed to open file!");
+        m_file = file;
+
+        LARGE_INTEGER file_size{};
+        if (!GetFileSizeEx(file, &file_size))
+            throw std::runtime_error("failed to query file size!");
+        m_file_size = static_cast<uint64_t>(file_size.QuadPart);
+
+        DWORD read = 0;
+        if (!ReadFile(file, &header, sizeof(header), &read, nullptr) || read != sizeof(header))
+            throw std::runtime_error("file is smaller than a scene header!");
+
+        // Copy-on-write: the fixup dirties only the pages it writes, the rest stay backed by the file
+        m_mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (!m_mapping)
+            throw std::runtime_error("failed to create file mapping!");
+#else
+        m_file = ::open(path.c_str(), O_RDONLY);
+        if (m_file < 0)
+            throw std::runtime_error("failed to open file!");
+
+        struct stat file_stat{};
+        if (fstat(m_file, &file_stat) != 0)
+            throw std::runtime_error("failed to query file size!");
+        m_file_size = static_cast<uint64_t>(file_stat.st_size);
+
+        if (pread(m_file, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)))
+            throw std::runtime_error("file is smaller than a scene header!");
+#endif
+
+        if (header.magic != SCENE_MAGIC)
+            throw std::runtime_error("not a scene file!");
+        if (header.version != SCENE_VERSION)
+            throw std::runtime_error("unsupported scene version!");
+        if (header.size < sizeof(scene) || header.size > m_file_size)
+            throw std::runtime_error("truncated scene file!");
+
+        // Only the root blob is mapped; sub-scenes get their own views on demand
+        m_root_size = header.size;
+        m_root_data = map_range(0, m_root_size);
+        if (!m_root_data)
+            throw std::runtime_error("failed to map root scene!");
+        if (!scene_fixup(m_root_data, m_root_size))
+            throw std::runtime_error("corrupt root scene!");
+
+        scene* root = reinterpret_cast<scene*>(m_root_data);
+        for (uint32_t i = 0; i < root->chunk_count; i++)
+        {
+            const scene_chunk& chunk = root->chunks[i];
+            if (chunk.offset % SCENE_BLOB_ALIGNMENT != 0 || chunk.offset < m_root_size || chunk.size < sizeof(scene) ||
+                chunk.offset > m_file_size || chunk.size > m_file_size - chunk.offset)
+                throw std::runtime_error("sub-scene outside the file!");
+        }
+        m_root = root;
+    }
+    catch (const std::exception& e)
+    {
+        log_error("Failed to open scene %s: %s", path.c_str(), e.what());
+        close();
+        return false;
+    }
+
+    m_sub_scenes.resize(m_root->chunk_count);
+    if (!m_sub_scenes.empty())
+    {
+        m_stop = false;
+        m_worker = std::thread(&scene_file::worker_loop, this);
+    }
+
+    log_info("scene %s opened (%u objects, %u lights, %u sub-scenes)", path.c_str(), m_root->object_count, m_root->light_count, m_root->chunk_count);
+    return true;
+}
+
+void scene_file::close()
+{
+    if (m_worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_worker.join();
+    }
+    m_jobs.clear();
+
+    // Sub-scene views first: their sizes live in the root chunk table
+    for (const load_result& result : m_results)
+    {
+        if (result.data)
+        {
+            unmap_range(result.data, m_root->chunks[result.index].size);
+        }
+    }
+    m_results.clear();
+    for (uint32_t i = 0; i < m_sub_scenes.size(); i++)
+    {
+        if (m_sub_scenes[i].data)
+        {
+            unmap_range(m_sub_scenes[i].data, m_root->chunks[i].size);
+        }
+    }
+    m_sub_scenes.clear();
+
+    if (m_root_data)
+    {
+        unmap_range(m_root_data, m_root_size);
+        m_root_data = nullptr;
+    }
+    m_root = nullptr;
+    m_root_size = 0;
+    m_file_size = 0;
+
+#ifdef _WIN32
+    if (m_mapping)
+    {
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+        m_mapping = nullptr;
+    }
+    if (m_file)
+    {
+        CloseHandle(static_cast<HANDLE>(m_file));
+        m_file = nullptr;
+    }
+#else
+    if (m_file >= 0)
+    {
+        ::close(m_file);
+        m_file = -1;
+    }
+#endif
+}
+
+void scene_file::update()
+{
+    std::deque<load_result> results;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        results.swap(m_results);
+    }
+
+    for (const load_result& result : results)
+    {
+        sub_scene_slot& slot = m_sub_scenes[result.index];
+        slot.in_flight = false;
+        if (slot.state == sub_scene_state::pending)
+        {
+            slot.data = result.data;
+            slot.state = result.data ? sub_scene_state::resident : sub_scene_state::failed;
+        }
+        else if (result.data)
+        {
+            // Unloaded while in flight, or already loaded synchronously
+            unmap_range(result.data, m_root->chunks[result.index].size);
+        }
+    }
+}
+
+void scene_file::stream(const float position[3], float load_distance, float unload_distance)
+{
+    for (uint32_t i = 0; i < m_sub_scenes.size(); i++)
+    {
+        const float* bounds = m_root->chunks[i].bounds;
+        float dx = bounds[0] - position[0];
+        float dy = bounds[1] - position[1];
+        float dz = bounds[2] - position[2];
+        float distance = std::sqrt(dx * dx + dy * dy + dz * dz) - bounds[3];
+
+        if (distance <= load_distance)
+        {
+            request_sub_scene(i);
+        }
+        else if (distance > unload_distance)
+        {
+            unload_sub_scene(i);
+        }
+    }
+}
+
+const scene* scene_file::load_sub_scene(uint32_t index)
+{
+    if (index >= m_sub_scenes.size())
+        return nullptr;
+
+    sub_scene_slot& slot = m_sub_scenes[index];
+    if (slot.state != sub_scene_state::resident)
+    {
+        // An in-flight result is dropped by update() since the slot is no longer pending
+        slot.data = map_sub_scene(index, false);
+        slot.state = slot.data ? sub_scene_state::resident : sub_scene_state::failed;
+    }
+    return get_sub_scene(index);
+}
+
+void scene_file::request_sub_scene(uint32_t index)
+{
+    if (index >= m_sub_scenes.size())
+        return;
+
+    sub_scene_slot& slot = m_sub_scenes[index];
+    if (slot.state == sub_scene_state::resident || slot.state == sub_scene_state::pending)
+        return;
+
+    slot.state = sub_scene_state::pending;
+    if (slot.in_flight)
+        return; // The earlier request's result is still coming
+
+    slot.in_flight = true;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(index);
+    }
+    m_cv.notify_one();
+}
+
+void scene_file::unload_sub_scene(uint32_t index)
+{
+    if (index >= m_sub_scenes.size())
+        return;
+
+    sub_scene_slot& slot = m_sub_scenes[index];
+    if (slot.state == sub_scene_state::resident)
+    {
+        unmap_range(slot.data, m_root->chunks[index].size);
+        slot.data = nullptr;
+    }
+    else if (slot.state == sub_scene_state::pending)
+    {
+        // Drop the job if the worker has not picked it up yet
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_jobs.begin(); it != m_jobs.end(); ++it)
+        {
+            if (*it == index)
+            {
+                m_jobs.erase(it);
+                slot.in_flight = false;
+                break;
+            }
+        }
+    }
+    slot.state = sub_scene_state::unloaded;
+}
+
+const char* scene_file::get_sub_scene_name(uint32_t index) const
+{
+    if (index >= m_sub_scenes.size())
+        return "";
+    return get_scene_string(*m_root, m_root->chunks[index].name);
+}
+
+const scene* scene_file::get_sub_scene(uint32_t index) const
+{
+    if (index >= m_sub_scenes.size() || m_sub_scenes[index].state != sub_scene_state::resident)
+        return nullptr;
+    return reinterpret_cast<const scene*>(m_sub_scenes[index].data);
+}
+
+bool scene_file::is_sub_scene_pending(uint32_t index) const
+{
+    return index < m_sub_scenes.size() && m_sub_scenes[index].state == sub_scene_state::pending;
+}
+
+char* scene_file::map_sub_scene(uint32_t index, bool prefetch) const
+{
+    JUCE_PROFILE_SCOPE("scene_file::map_sub_scene");
+
+    const scene_chunk& chunk = m_root->chunks[index];
+    char* data = map_range(chunk.offset, chunk.size);
+    if (!data)
+    {
+        log_warn("Failed to map sub-scene %u of %s", index, m_path.c_str());
+        return nullptr;
+    }
+
+    if (prefetch)
+    {
+#ifndef _WIN32
+        madvise(data, chunk.size, MADV_WILLNEED);
+#endif
+        // Fault every page in here so the main thread never waits on the disk for this blob
+        volatile char sink = 0;
+        for (uint64_t offset = 0; offset < chunk.size; offset += PREFETCH_STRIDE)
+        {
+            sink = sink + data[offset];
+        }
+    }
+
+    if (!scene_fixup(data, chunk.size))
+    {
+        log_warn("Sub-scene %u of %s is corrupt", index, m_path.c_str());
+        unmap_range(data, chunk.size);
+        return nullptr;
+    }
+    return data;
+}
+
+char* scene_file::map_range(uint64_t offset, uint64_t size) const
+{
+#ifdef _WIN32
+    void* data = MapViewOfFile(static_cast<HANDLE>(m_mapping), FILE_MAP_COPY, static_cast<DWORD>(offset >> 32),
+                               static_cast<DWORD>(offset & 0xFFFFFFFFu), static_cast<SIZE_T>(size));
+    return static_cast<char*>(data);
+#else
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_file, static_cast<off_t>(offset));
+    return data != MAP_FAILED ? static_cast<char*>(data) : nullptr;
+#endif
+}
+
+void scene_file::unmap_range(char* data, uint64_t size) const
+{
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+void scene_file::worker_loop()
+{
+    JUCE_PROFILE_THREAD("scene streamer");
+
+    for (;;)
+    {
+        uint32_t index;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]()
+                      { return m_stop || !m_jobs.empty(); });
+            if (m_stop)
+                return;
+            index = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        char* data = map_sub_scene(index, true);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results.push_back({index, data});
+    }
+}
+
+} // namespace juce
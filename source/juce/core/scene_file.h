@@ -0,0 +1,108 @@
+#pragma once
+#include "scene.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace juce
+{
+
+/**
+ * scene 파일 로더
+ * - 관리: 파일 / mapping 핸들, root blob view, sub-scene blob view들, 스트리밍 워커 스레드
+ * - open = header 읽기 + root blob copy-on-write mapping + scene_fixup, 오브젝트 데이터는 처음 접근할 때 페이지 단위로 읽힘
+ * - sub-scene은 blob마다 따로 mapping: 워커가 mapping + 페이지 미리 읽기 + fixup, update()에서 상주로 전환
+ * - 반환된 scene 포인터는 해당 sub-scene을 unload하거나 close하기 전까지 유효
+ */
+class scene_file
+{
+public:
+    scene_file();
+    ~scene_file();
+
+    scene_file(const scene_file&) = delete;
+    scene_file& operator=(const scene_file&) = delete;
+
+    bool open(const std::string& path);
+    // 워커 정지 후 모든 view 해제
+    void close();
+
+    // 메인 스레드: 끝난 비동기 로드 반영
+    void update();
+
+    // position에서 sub-scene bounds 표면까지 거리 <= load_distance면 요청, > unload_distance면 해제
+    // (unload_distance > load_distance로 경계에서 반복 로드 방지)
+    void stream(const float position[3], float load_distance, float unload_distance);
+
+    // 이미 상주면 그대로, 아니면 이 스레드에서 바로 로드 (실패 시 nullptr)
+    const scene* load_sub_scene(uint32_t index);
+    // 워커로 로드 요청 (상주 / 요청 중이면 무시)
+    void request_sub_scene(uint32_t index);
+    void unload_sub_scene(uint32_t index);
+
+    // Getters
+    bool is_open() const { return m_root != nullptr; }
+    const scene* get_root() const { return m_root; }
+    uint32_t get_sub_scene_count() const { return static_cast<uint32_t>(m_sub_scenes.size()); }
+    const char* get_sub_scene_name(uint32_t index) const;
+    // 상주 중인 sub-scene, 아니면 nullptr
+    const scene* get_sub_scene(uint32_t index) const;
+    bool is_sub_scene_pending(uint32_t index) const;
+
+private:
+    enum class sub_scene_state : uint8_t
+    {
+        unloaded,
+        pending,  // 워커 요청 중 (결과가 오면 상주)
+        resident,
+        failed,   // 다시 요청하면 재시도
+    };
+
+    struct sub_scene_slot
+    {
+        sub_scene_state state = sub_scene_state::unloaded;
+        bool in_flight = false; // 워커 결과가 아직 안 옴 (state가 바뀌었으면 결과는 버림)
+        char* data = nullptr;
+    };
+
+    struct load_result
+    {
+        uint32_t index;
+        char* data; // nullptr = 실패
+    };
+
+    // 어느 스레드에서나 호출 (open 중에는 파일 / mapping과 root가 바뀌지 않음)
+    char* map_sub_scene(uint32_t index, bool prefetch) const;
+    char* map_range(uint64_t offset, uint64_t size) const;
+    void unmap_range(char* data, uint64_t size) const;
+    void worker_loop();
+
+#ifdef _WIN32
+    void* m_file;    // HANDLE
+    void* m_mapping; // HANDLE
+#else
+    int m_file;
+#endif
+    std::string m_path;
+    uint64_t m_file_size;
+    uint64_t m_root_size; // mapping 크기 (header의 size)
+    char* m_root_data;
+    scene* m_root;        // fixup이 끝난 뒤에만 설정
+
+    // 메인 스레드 전용
+    std::vector<sub_scene_slot> m_sub_scenes;
+
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop;
+    std::deque<uint32_t> m_jobs;
+    std::deque<load_result> m_results;
+};
+
+} // namespace juce
@@ -0,0 +1,111 @@
+// startup_trace는 "첫 프레임까지 시간이 어디에 쓰였는가"를 책임
+#include "startup_trace.h"
+#include "logger.h"
+
+#include <algorithm>
+
+namespace juce
+{
+
+startup_trace* startup_trace::get_instance()
+{
+    static startup_trace instance;
+    return &instance;
+}
+
+startup_trace::startup_trace()
+    : m_origin(std::chrono::steady_clock::now()), m_finished(false)
+{
+}
+
+void startup_trace::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_origin = std::chrono::steady_clock::now();
+    m_phases.clear();
+    m_finished = false;
+}
+
+double startup_trace::elapsed_ms() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return elapsed_ms_locked();
+}
+
+double startup_trace::elapsed_ms_locked() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_origin).count();
+}
+
+uint32_t startup_trace::begin_phase(const char* name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Read under the lock so a concurrent start() cannot mix two origins in one record
+    double now = elapsed_ms_locked();
+    if (m_finished)
+        return UINT32_MAX;
+
+    std::thread::id id = std::this_thread::get_id();
+    auto it = std::find(m_threads.begin(), m_threads.end(), id);
+    uint32_t thread = static_cast<uint32_t>(it - m_threads.begin());
+    if (it == m_threads.end())
+    {
+        m_threads.push_back(id);
+    }
+
+    m_phases.push_back({name, thread, now, -1.0});
+    return static_cast<uint32_t>(m_phases.size() - 1);
+}
+
+void startup_trace::end_phase(uint32_t index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    double now = elapsed_ms_locked();
+    if (m_finished || index >= m_phases.size())
+        return;
+    m_phases[index].end_ms = now;
+}
+
+void startup_trace::mark_first_frame()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    double now = elapsed_ms_locked();
+    if (m_finished)
+        return;
+    m_finished = true;
+    report(now);
+}
+
+bool startup_trace::is_finished() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_finished;
+}
+
+void startup_trace::report(double first_frame_ms) const
+{
+    log_info("Startup: %.1f ms to first frame (%zu phases on %zu threads)", first_frame_ms, m_phases.size(), m_threads.size());
+
+    // Phases are appended as they begin, so this is already start order
+    for (const phase& p : m_phases)
+    {
+        if (p.end_ms < 0.0)
+        {
+            log_info("  [%8.1f -      ...] %8s  t%u %s", p.begin_ms, "running", p.thread, p.name);
+            continue;
+        }
+        log_info("  [%8.1f - %8.1f] %6.1f ms  t%u %s", p.begin_ms, p.end_ms, p.end_ms - p.begin_ms, p.thread, p.name);
+    }
+}
+
+startup_phase::startup_phase(const char* name)
+    : m_index(startup_trace::get_instance()->begin_phase(name))
+{
+}
+
+startup_phase::~startup_phase()
+{
+    startup_trace::get_instance()->end_phase(m_index);
+}
+
+} // namespace juce
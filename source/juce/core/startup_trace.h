@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+
+namespace juce
+{
+
+/**
+ * startup trace
+ * - 관리: 시작 단계별 구간 (이름, 스레드, 시작 / 끝), 첫 프레임까지의 시간
+ * - 단계는 여러 스레드에서 겹쳐 실행될 수 있음, 보고서는 시작 순서대로
+ * - 첫 프레임 이후에는 기록하지 않음 (런타임 비용 없음)
+ */
+class startup_trace
+{
+public:
+    static startup_trace* get_instance();
+
+    // 기준 시각 재설정 (가능한 한 일찍: application 생성자 첫 줄)
+    void start();
+
+    // 단계 기록, name은 문자열 리터럴 (복사하지 않음)
+    uint32_t begin_phase(const char* name);
+    void end_phase(uint32_t index);
+
+    // 첫 프레임 present 직후 호출: 보고서 출력 후 기록 종료
+    void mark_first_frame();
+    bool is_finished() const;
+
+    // 기준 시각부터 지금까지 (ms), start()와 동시에 불려도 안전 (m_mutex)
+    double elapsed_ms() const;
+
+private:
+    startup_trace();
+
+    struct phase
+    {
+        const char* name;
+        uint32_t thread;
+        double begin_ms;
+        double end_ms; // 아직 진행 중이면 음수
+    };
+
+    void report(double first_frame_ms) const;
+    // m_mutex를 잡은 상태에서만 호출
+    double elapsed_ms_locked() const;
+
+    std::chrono::steady_clock::time_point m_origin; // start()가 바꿈, m_mutex로 보호
+    mutable std::mutex m_mutex;
+    std::vector<phase> m_phases;
+    std::vector<std::thread::id> m_threads; // index = 보고서의 스레드 번호
+    bool m_finished;
+};
+
+// 범위 동안의 시작 단계 (예: startup_phase phase("vk_context::create_instance");)
+class startup_phase
+{
+public:
+    explicit startup_phase(const char* name);
+    ~startup_phase();
+
+    startup_phase(const startup_phase&) = delete;
+    startup_phase& operator=(const startup_phase&) = delete;
+
+private:
+    uint32_t m_index;
+};
+
+} // namespace juce
@@ -0,0 +1,91 @@
+// clustered forward lighting 공용 정의 (cluster_bin.comp, 셰이딩 셰이더에서 include)
+// - 레이아웃은 clustered_lighting.h의 set 레이아웃과 같아야 함
+// - view space: 오른손 좌표계, 카메라는 -Z를 바라봄, 광원 위치는 CPU에서 view space로 변환되어 올라옴
+// - cluster: 화면을 grid.x * grid.y 타일로, 깊이를 grid.z 구간으로 (지수 분할) 나눈 froxel
+
+#ifndef CLUSTERED_LIGHTING_GLSL
+#define CLUSTERED_LIGHTING_GLSL
+
+#ifndef CLUSTER_SET
+#define CLUSTER_SET 1
+#endif
+
+// binning 셰이더만 cluster 목록을 씀
+#ifdef CLUSTER_BINNING
+#define CLUSTER_ACCESS
+#else
+#define CLUSTER_ACCESS readonly
+#endif
+
+struct point_light
+{
+    vec4 position_radius; // xyz: view space 위치, w: 영향 반경
+    vec4 color_intensity; // rgb: 색, a: 세기
+};
+
+layout(std140, set = CLUSTER_SET, binding = 0) uniform cluster_params_block
+{
+    mat4 inv_proj;
+    uvec4 grid;   // x, y, z 분할 수, w: cluster당 최대 광원 수
+    uvec4 counts; // x: 광원 수
+    vec4 screen;  // width, height, near, far
+    vec4 slicing; // z 구간 scale, bias, 타일 width, height (픽셀)
+} cluster_params;
+
+layout(std430, set = CLUSTER_SET, binding = 1) readonly buffer cluster_light_buffer
+{
+    point_light lights[];
+};
+
+layout(std430, set = CLUSTER_SET, binding = 2) CLUSTER_ACCESS buffer cluster_count_buffer
+{
+    uint cluster_light_counts[];
+};
+
+// cluster i의 목록은 [i * grid.w, i * grid.w + count)
+layout(std430, set = CLUSTER_SET, binding = 3) CLUSTER_ACCESS buffer cluster_index_buffer
+{
+    uint cluster_light_indices[];
+};
+
+// slice = log(depth / near) * slices / log(far / near)
+uint cluster_slice(float view_depth)
+{
+    float slice = log(max(view_depth, 1e-6)) * cluster_params.slicing.x + cluster_params.slicing.y;
+    return uint(clamp(slice, 0.0, float(cluster_params.grid.z - 1)));
+}
+
+uint cluster_index(vec2 frag_coord, float view_depth)
+{
+    uvec2 tile = min(uvec2(frag_coord / cluster_params.slicing.zw), cluster_params.grid.xy - 1);
+    return tile.x + cluster_params.grid.x * (tile.y + cluster_params.grid.y * cluster_slice(view_depth));
+}
+
+#ifndef CLUSTER_BINNING
+// Lambert + 반경에서 0이 되는 역제곱 감쇠, 이 fragment가 속한 cluster의 광원만 순회
+// - view_pos / normal: view space
+vec3 shade_clustered_lights(vec3 view_pos, vec3 normal, vec3 albedo, vec2 frag_coord)
+{
+    uint cluster = cluster_index(frag_coord, -view_pos.z);
+    uint count = cluster_light_counts[cluster];
+    uint base = cluster * cluster_params.grid.w;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0; i < count; i++)
+    {
+        point_light light = lights[cluster_light_indices[base + i]];
+
+        vec3 to_light = light.position_radius.xyz - view_pos;
+        float distance2 = max(dot(to_light, to_light), 1e-4);
+        float radius2 = light.position_radius.w * light.position_radius.w;
+        float window = clamp(1.0 - (distance2 * distance2) / (radius2 * radius2), 0.0, 1.0);
+        float attenuation = window * window / distance2;
+        float n_dot_l = max(dot(normal, to_light * inversesqrt(distance2)), 0.0);
+
+        result += light.color_intensity.rgb * light.color_intensity.a * attenuation * n_dot_l;
+    }
+    return result * albedo;
+}
+#endif
+
+#endif
@@ -0,0 +1,16 @@
+#version 450
+
+// 파티클: 중심에서 가장자리로 부드럽게 사라지는 원 (straight alpha, SRC_ALPHA 블렌딩)
+
+layout(location = 0) in vec4 in_color;
+layout(location = 1) in vec2 in_uv;
+
+layout(location = 0) out vec4 out_color;
+
+void main()
+{
+    float falloff = 1.0 - smoothstep(0.25, 1.0, dot(in_uv, in_uv));
+    if (falloff <= 0.0)
+        discard;
+    out_color = vec4(in_color.rgb, in_color.a * falloff);
+}
@@ -0,0 +1,35 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// 파티클 billboard: instance 하나가 그리기 목록의 파티클 하나, 정점 6개로 카메라를 향한 사각형
+// - instance 수는 PARTICLE_END가 indirect 인자에 써 둠
+
+#include "particles.glsl"
+
+layout(push_constant) uniform particle_draw_params
+{
+    mat4 view_proj;
+    vec4 camera_right; // world space, xyz만 사용
+    vec4 camera_up;
+} pc;
+
+layout(location = 0) out vec4 out_color;
+layout(location = 1) out vec2 out_uv;
+
+const vec2 CORNERS[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                               vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main()
+{
+    particle p = particles[draw_list[gl_InstanceIndex].index];
+
+    float t = clamp(p.position_age.w / p.velocity_lifetime.w, 0.0, 1.0);
+    float size = mix(uintBitsToFloat(p.appearance.z), uintBitsToFloat(p.appearance.w), t);
+    out_color = mix(unpackUnorm4x8(p.appearance.x), unpackUnorm4x8(p.appearance.y), t);
+
+    vec2 corner = CORNERS[gl_VertexIndex];
+    out_uv = corner;
+
+    vec3 world = p.position_age.xyz + (pc.camera_right.xyz * corner.x + pc.camera_up.xyz * corner.y) * size;
+    gl_Position = pc.view_proj * vec4(world, 1.0);
+}
@@ -0,0 +1,111 @@
+// GPU particle 공용 정의 (particle_*.comp, particle.vert에서 include)
+// - 레이아웃은 particle_system.h의 set 레이아웃 / particle_system.cpp의 구조체와 같아야 함
+// - alive 목록은 프레임마다 방향이 바뀜: binding 4에서 읽고 살아남은 것만 binding 5에 추가 (CPU가 set을 번갈아 바인딩)
+
+#ifndef PARTICLES_GLSL
+#define PARTICLES_GLSL
+
+// compute 셰이더만 파티클 상태를 씀
+#ifdef PARTICLE_COMPUTE
+#define PARTICLE_ACCESS
+#else
+#define PARTICLE_ACCESS readonly
+#endif
+
+// prepare / sort 셰이더의 mode
+#define PARTICLE_RESET 0          // dead 목록 = 전체, 카운터 초기화 (버퍼 생성 직후 한 번)
+#define PARTICLE_BEGIN 1          // 방출 수 = min(요청, dead 수), 방출 dispatch 인자
+#define PARTICLE_BEFORE_SIMULATE 2 // 시뮬레이션 dispatch 인자
+#define PARTICLE_END 3            // 목록 방향 전환, 정렬 / 그리기 인자
+#define SORT_PRESORT 4            // 블록 안에서 k <= SORT_BLOCK 단계 전부 (shared memory)
+#define SORT_GLOBAL 5             // (k, j) 한 단계, j >= SORT_BLOCK
+#define SORT_MERGE 6              // k 단계의 j < SORT_BLOCK 나머지 (shared memory)
+
+// 정렬 workgroup 하나가 다루는 원소 수 (invocation당 2개)
+#define SORT_BLOCK 512
+
+struct particle
+{
+    vec4 position_age;      // xyz: world 위치, w: 나이 (초)
+    vec4 velocity_lifetime; // xyz: 속도, w: 수명 (초)
+    uvec4 appearance;       // x, y: 시작 / 끝 색 (unorm4x8), z, w: 시작 / 끝 크기 (float bits)
+};
+
+struct particle_emitter
+{
+    vec4 position_radius;
+    vec4 velocity_spread;
+    vec4 lifetime_size; // 최소 / 최대 수명, 시작 / 끝 크기
+    uvec4 emission;     // x, y: 시작 / 끝 색 (unorm4x8), z: 이번 프레임 첫 방출 번호 (누적), w: 방출 수
+};
+
+// 정렬 key가 작은 것부터 그림 (key = -카메라 거리^2 -> 먼 것부터), 빈 칸은 FLT_MAX
+struct draw_entry
+{
+    float key;
+    uint index;
+};
+
+layout(std140, set = 0, binding = 0) uniform particle_params_block
+{
+    vec4 gravity_dt;  // xyz: 중력, w: 이번 프레임 시간 (초)
+    vec4 camera_drag; // xyz: 카메라 world 위치, w: 초당 속도 감쇠
+    uvec4 counts;     // x: 방출기 수, y: 요청 방출 수 합, z: 프레임 seed, w: 최대 파티클 수
+} particle_params;
+
+layout(std430, set = 0, binding = 1) readonly buffer particle_emitter_buffer
+{
+    particle_emitter emitters[];
+};
+
+layout(std430, set = 0, binding = 2) PARTICLE_ACCESS buffer particle_buffer
+{
+    particle particles[];
+};
+
+layout(std430, set = 0, binding = 3) PARTICLE_ACCESS buffer particle_dead_buffer
+{
+    uint dead_list[];
+};
+
+layout(std430, set = 0, binding = 4) PARTICLE_ACCESS buffer particle_alive_buffer
+{
+    uint alive_list[];
+};
+
+layout(std430, set = 0, binding = 5) PARTICLE_ACCESS buffer particle_next_alive_buffer
+{
+    uint next_alive_list[];
+};
+
+// dispatch / draw 인자는 그대로 indirect 명령으로 읽힘
+layout(std430, set = 0, binding = 6) PARTICLE_ACCESS buffer particle_counter_buffer
+{
+    uint alive_count;      // alive_list 길이
+    uint next_alive_count; // next_alive_list 길이
+    uint dead_count;
+    uint emit_count;       // 이번 프레임 실제 방출 수
+    uint emit_dispatch[3];
+    uint simulate_dispatch[3];
+    uint sort_dispatch[3];
+    uint sort_count;       // 정렬할 원소 수 (SORT_BLOCK 이상의 2의 거듭제곱)
+    uint draw_args[4];     // vertex count, instance count, first vertex, first instance
+} counters;
+
+layout(std430, set = 0, binding = 7) PARTICLE_ACCESS buffer particle_draw_buffer
+{
+    draw_entry draw_list[];
+};
+
+#ifdef PARTICLE_COMPUTE
+// prepare / sort 셰이더만 사용 (emit / simulate는 mode 없이 한 가지 일)
+layout(push_constant) uniform particle_dispatch_block
+{
+    uint mode;
+    uint k; // bitonic 단계 (SORT_GLOBAL, SORT_MERGE)
+    uint j; // 비교 거리 (SORT_GLOBAL)
+    uint padding;
+} dispatch_params;
+#endif
+
+#endif
@@ -1,10 +1,15 @@
 #include <juce/core/application.h>
+#include <juce/core/scene_file.h>
 
 int main(int args, char* argv[])
 {
     juce::application app(args, argv, 1024, 760);
 
-    auto code = app.exec(nullptr);
+    // game <scene file>: the scene is mapped, not parsed, so opening it is near-instant
+    juce::scene_file scene;
+    bool has_scene = args > 1 && scene.open(argv[1]);
+
+    auto code = app.exec(has_scene ? &scene : nullptr);
 
     return code;
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace juce
+{
+
+// 측정값 하나 (작을수록 좋음), baseline 키는 "<test>.<name>"
+struct perf_metric
+{
+    std::string name;
+    double value;
+    const char* unit;
+};
+
+enum class perf_status
+{
+    ok,
+    skipped, // 실행 환경이 없음 (Vulkan 장치 등), CTest에서 skip으로 표시
+    failed,  // 측정 전에 실패 (초기화 오류 등)
+};
+
+using perf_function = perf_status (*)(std::vector<perf_metric>& metrics);
+
+struct perf_test
+{
+    const char* name;
+    perf_function function;
+};
+
+std::vector<perf_test>& get_perf_tests();
+
+struct perf_registrar
+{
+    perf_registrar(const char* name, perf_function function)
+    {
+        get_perf_tests().push_back({name, function});
+    }
+};
+
+// 테스트 등록, 이름은 CMakeLists.txt의 목록과 같아야 함
+#define JUCE_PERF_TEST(name)                                                         \
+    static ::juce::perf_status perf_test_##name(std::vector<::juce::perf_metric>& metrics); \
+    static ::juce::perf_registrar perf_registrar_##name(#name, perf_test_##name);           \
+    static ::juce::perf_status perf_test_##name(std::vector<::juce::perf_metric>& metrics)
+
+// 컴파일러가 결과를 버리지 않도록
+inline const void* volatile perf_sink = nullptr;
+
+template <typename T>
+inline void perf_keep(const T& value)
+{
+    perf_sink = &value;
+}
+
+// fn을 repeat번 호출하는 구간을 samples번 재서 호출당 시간의 중앙값 (ns)
+// - 첫 구간은 캐시 / 할당 워밍업으로 버림
+template <typename F>
+double perf_measure_ns(uint32_t samples, uint32_t repeat, F&& fn)
+{
+    std::vector<double> times;
+    times.reserve(samples);
+    for (uint32_t s = 0; s <= samples; s++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < repeat; i++)
+        {
+            fn();
+        }
+        auto end = std::chrono::steady_clock::now();
+        if (s > 0)
+        {
+            times.push_back(std::chrono::duration<double, std::nano>(end - begin).count() / repeat);
+        }
+    }
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+} // namespace juce
@@ -0,0 +1,227 @@
+// perf_core는 "장치 없이 잴 수 있는 엔진 기반 코드의 속도"를 책임
+#include "perf.h"
+
+#include <juce/core/linear_arena.h>
+#include <juce/core/handle_pool.h>
+#include <juce/core/logger.h>
+#include <juce/core/profiler.h>
+#include <juce/core/scene.h>
+#include <juce/core/scene_file.h>
+
+#include <cstdio>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#define perf_dup _dup
+#define perf_dup2 _dup2
+#define perf_close _close
+#define perf_open _open
+#define PERF_NULL_DEVICE "NUL"
+#else
+#include <unistd.h>
+#define perf_dup dup
+#define perf_dup2 dup2
+#define perf_close close
+#define perf_open open
+#define PERF_NULL_DEVICE "/dev/null"
+#endif
+
+namespace juce
+{
+
+static const uint32_t SAMPLES = 15;
+
+// The logger writes straight to stdout; measuring the console would only measure the terminal
+class stdout_silencer
+{
+public:
+    stdout_silencer()
+    {
+        std::fflush(stdout);
+        m_saved = perf_dup(fileno(stdout));
+        int null_fd = perf_open(PERF_NULL_DEVICE, O_WRONLY);
+        perf_dup2(null_fd, fileno(stdout));
+        perf_close(null_fd);
+    }
+
+    ~stdout_silencer()
+    {
+        std::fflush(stdout);
+        perf_dup2(m_saved, fileno(stdout));
+        perf_close(m_saved);
+    }
+
+private:
+    int m_saved;
+};
+
+JUCE_PERF_TEST(linear_arena)
+{
+    // A frame's worth of small, mixed-size allocations followed by one reset
+    const uint32_t allocations = 4096;
+    linear_arena arena(1024 * 1024);
+    double frame_ns = perf_measure_ns(SAMPLES, 64, [&]()
+                                      {
+                                          for (uint32_t i = 0; i < allocations; i++)
+                                          {
+                                              perf_keep(arena.allocate(16 + (i & 63), 16));
+                                          }
+                                          arena.reset(); });
+    metrics.push_back({"allocate", frame_ns / allocations, "ns"});
+
+    // Growing an arena_vector without reserve exercises the overflow-free steady state
+    double vector_ns = perf_measure_ns(SAMPLES, 64, [&]()
+                                       {
+                                           arena_vector<uint32_t> values{arena_allocator<uint32_t>(arena)};
+                                           for (uint32_t i = 0; i < allocations; i++)
+                                           {
+                                               values.push_back(i);
+                                           }
+                                           perf_keep(values.back());
+                                           arena.reset(); });
+    metrics.push_back({"vector_push", vector_ns / allocations, "ns"});
+    return perf_status::ok;
+}
+
+JUCE_PERF_TEST(handle_pool)
+{
+    struct payload
+    {
+        uint64_t a;
+        uint64_t b;
+    };
+
+    const uint32_t count = 16384;
+    std::vector<handle<payload>> handles(count);
+    handle_pool<payload> pool;
+
+    double insert_ns = perf_measure_ns(SAMPLES, 8, [&]()
+                                       {
+                                           for (uint32_t i = 0; i < count; i++)
+                                           {
+                                               handles[i] = pool.insert({i, i});
+                                           }
+                                           for (uint32_t i = 0; i < count; i++)
+                                           {
+                                               pool.remove(handles[i]);
+                                           } });
+    metrics.push_back({"insert_remove", insert_ns / count, "ns"});
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        handles[i] = pool.insert({i, i});
+    }
+    uint64_t sum = 0;
+    double get_ns = perf_measure_ns(SAMPLES, 32, [&]()
+                                    {
+                                        // Strided so lookups are not just a linear walk of the dense array
+                                        for (uint32_t i = 0; i < count; i++)
+                                        {
+                                            sum += pool.get(handles[(i * 7919) % count])->a;
+                                        } });
+    perf_keep(sum);
+    metrics.push_back({"get", get_ns / count, "ns"});
+    return perf_status::ok;
+}
+
+JUCE_PERF_TEST(logger)
+{
+    const uint32_t messages = 2048;
+    double message_ns;
+    {
+        stdout_silencer silence;
+        message_ns = perf_measure_ns(SAMPLES, 4, [&]()
+                                     {
+                                         for (uint32_t i = 0; i < messages; i++)
+                                         {
+                                             log_info("frame %u: %s took %.3f ms", i, "backend::draw_frame", 0.25 * i);
+                                         } });
+    }
+    metrics.push_back({"message", message_ns / messages, "ns"});
+    return perf_status::ok;
+}
+
+JUCE_PERF_TEST(profiler)
+{
+#if JUCE_ENABLE_PROFILER
+    // Outside a capture a scope must stay at the cost of one atomic load
+    const uint32_t scopes = 65536;
+    uint64_t counter = 0;
+    double scope_ns = perf_measure_ns(SAMPLES, 16, [&]()
+                                      {
+                                          for (uint32_t i = 0; i < scopes; i++)
+                                          {
+                                              JUCE_PROFILE_SCOPE("perf::idle_scope");
+                                              counter++;
+                                          } });
+    perf_keep(counter);
+    metrics.push_back({"idle_scope", scope_ns / scopes, "ns"});
+    return perf_status::ok;
+#else
+    return perf_status::skipped;
+#endif
+}
+
+JUCE_PERF_TEST(scene)
+{
+    // Open cost must not grow with the object count: no per-object parsing, only the fixup
+    const uint32_t objects = 100000;
+    const uint32_t sub_scenes = 4;
+    const char* path = "perf_scene.bin";
+
+    scene_builder builder;
+    for (uint32_t i = 0; i < objects; i++)
+    {
+        scene_object_desc desc;
+        desc.position[0] = static_cast<float>(i);
+        desc.bounds[3] = 1.0f;
+        desc.vertex_count = 36;
+        desc.parent = i > 0 ? i - 1 : SCENE_NO_PARENT;
+        builder.add_object(desc);
+    }
+    for (uint32_t i = 0; i < sub_scenes; i++)
+    {
+        scene_builder sub;
+        for (uint32_t j = 0; j < objects / sub_scenes; j++)
+        {
+            scene_object_desc desc;
+            desc.first_vertex = j;
+            sub.add_object(desc);
+        }
+        const float bounds[4] = {1000.0f * i, 0.0f, 0.0f, 100.0f};
+        builder.add_sub_scene("block", bounds, sub);
+    }
+    if (!builder.write(path))
+        return perf_status::failed;
+
+    scene_file file;
+    bool valid = false;
+    double open_ns;
+    {
+        stdout_silencer silence;
+        open_ns = perf_measure_ns(SAMPLES, 8, [&]()
+                                  {
+                                      valid = file.open(path);
+                                      file.close(); });
+    }
+    metrics.push_back({"open", open_ns, "ns"});
+
+    valid = valid && file.open(path) && file.get_root()->object_count == objects &&
+            file.get_root()->positions[objects - 1][0] == static_cast<float>(objects - 1) &&
+            file.get_sub_scene_count() == sub_scenes;
+    double sub_scene_ns = perf_measure_ns(SAMPLES, 4, [&]()
+                                          {
+                                              for (uint32_t i = 0; i < sub_scenes; i++)
+                                              {
+                                                  const scene* sub = file.load_sub_scene(i);
+                                                  valid = valid && sub && sub->first_vertices[objects / sub_scenes - 1] == objects / sub_scenes - 1;
+                                                  file.unload_sub_scene(i);
+                                              } });
+    metrics.push_back({"sub_scene_load", sub_scene_ns / sub_scenes, "ns"});
+    file.close();
+    std::remove(path);
+
+    return valid ? perf_status::ok : perf_status::failed;
+}
+
+} // namespace juce
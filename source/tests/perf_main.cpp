@@ -0,0 +1,229 @@
+// perf_main은 "측정값을 저장된 baseline과 비교해 회귀를 실패로 만드는 것"을 책임
+#include "perf.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace juce
+{
+
+// CTest treats this exit code as "skipped" (SKIP_RETURN_CODE)
+static const int EXIT_SKIPPED = 77;
+
+std::vector<perf_test>& get_perf_tests()
+{
+    static std::vector<perf_test> tests;
+    return tests;
+}
+
+struct baseline
+{
+    double value = 0.0;
+    double tolerance = -1.0; // < 0: command line / default tolerance
+};
+
+// "<test>.<metric> <value> [tolerance]" per line, '#' starts a comment
+static std::map<std::string, baseline> read_baselines(const std::string& path)
+{
+    std::map<std::string, baseline> baselines;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.resize(comment);
+
+        std::istringstream stream(line);
+        std::string key;
+        baseline entry;
+        if (!(stream >> key >> entry.value))
+            continue;
+        if (!(stream >> entry.tolerance))
+            entry.tolerance = -1.0;
+        baselines[key] = entry;
+    }
+    return baselines;
+}
+
+// Only this test's keys are replaced; comments and other entries are kept in place
+static bool write_baselines(const std::string& path, const std::string& test, const std::vector<perf_metric>& metrics)
+{
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream stream(line);
+            std::string key;
+            stream >> key;
+            if (key.compare(0, test.size() + 1, test + ".") == 0)
+                continue;
+            lines.push_back(line);
+        }
+    }
+
+    std::map<std::string, baseline> previous = read_baselines(path);
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+        return false;
+    for (const std::string& line : lines)
+    {
+        file << line << '\n';
+    }
+    for (const perf_metric& metric : metrics)
+    {
+        file << test << '.' << metric.name << ' ' << metric.value;
+        // A hand-tuned per-metric tolerance survives re-recording
+        auto it = previous.find(test + "." + metric.name);
+        if (it != previous.end() && it->second.tolerance >= 0.0)
+        {
+            file << ' ' << it->second.tolerance;
+        }
+        file << '\n';
+    }
+    return file.good();
+}
+
+static void print_usage()
+{
+    std::printf("usage: juce-perf --test <name> [--baselines <file>] [--tolerance <ratio>] [--update-baselines]\n"
+                "       juce-perf --list\n");
+}
+
+static int run(int argc, char* argv[])
+{
+    std::string test_name;
+    std::string baseline_path;
+    double tolerance = 0.25;
+    bool update = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--list") == 0)
+        {
+            for (const perf_test& test : get_perf_tests())
+            {
+                std::printf("%s\n", test.name);
+            }
+            return 0;
+        }
+        else if (std::strcmp(argv[i], "--test") == 0 && i + 1 < argc)
+            test_name = argv[++i];
+        else if (std::strcmp(argv[i], "--baselines") == 0 && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+            tolerance = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--update-baselines") == 0)
+            update = true;
+        else
+        {
+            print_usage();
+            return 2;
+        }
+    }
+
+    // JUCE_PERF_TOLERANCE overrides the configured tolerance, e.g. on a noisy CI machine
+    if (const char* env = std::getenv("JUCE_PERF_TOLERANCE"))
+    {
+        tolerance = std::atof(env);
+    }
+
+    const perf_test* test = nullptr;
+    for (const perf_test& candidate : get_perf_tests())
+    {
+        if (test_name == candidate.name)
+            test = &candidate;
+    }
+    if (!test)
+    {
+        std::printf("unknown test '%s'\n", test_name.c_str());
+        print_usage();
+        return 2;
+    }
+
+    std::vector<perf_metric> metrics;
+    perf_status status = test->function(metrics);
+    if (status == perf_status::skipped)
+    {
+        std::printf("%s: skipped\n", test->name);
+        return EXIT_SKIPPED;
+    }
+    if (status == perf_status::failed)
+    {
+        std::printf("%s: failed before measuring\n", test->name);
+        return 1;
+    }
+
+    if (update)
+    {
+        if (baseline_path.empty() || !write_baselines(baseline_path, test->name, metrics))
+        {
+            std::printf("failed to write baselines to '%s'\n", baseline_path.c_str());
+            return 1;
+        }
+        for (const perf_metric& metric : metrics)
+        {
+            std::printf("%s.%s = %.4g %s (recorded)\n", test->name, metric.name.c_str(), metric.value, metric.unit);
+        }
+        return 0;
+    }
+
+    std::map<std::string, baseline> baselines;
+    if (!baseline_path.empty())
+    {
+        baselines = read_baselines(baseline_path);
+    }
+
+    // Lower is better: a metric fails once it is slower than baseline * (1 + tolerance)
+    bool regressed = false;
+    uint32_t missing = 0;
+    for (const perf_metric& metric : metrics)
+    {
+        std::string key = std::string(test->name) + "." + metric.name;
+        auto it = baselines.find(key);
+        if (it == baselines.end())
+        {
+            std::printf("%-40s %12.4g %-6s (no baseline)\n", key.c_str(), metric.value, metric.unit);
+            missing++;
+            continue;
+        }
+
+        double allowed = it->second.tolerance >= 0.0 ? it->second.tolerance : tolerance;
+        double ratio = it->second.value > 0.0 ? metric.value / it->second.value : 1.0;
+        const char* verdict = "ok";
+        if (ratio > 1.0 + allowed)
+        {
+            verdict = "REGRESSION";
+            regressed = true;
+        }
+        else if (ratio < 1.0 - allowed)
+        {
+            verdict = "faster, consider --update-baselines";
+        }
+        std::printf("%-40s %12.4g %-6s baseline %.4g (%+.1f%%, tolerance %.0f%%) %s\n",
+                    key.c_str(), metric.value, metric.unit, it->second.value, (ratio - 1.0) * 100.0, allowed * 100.0, verdict);
+    }
+    if (regressed)
+        return 1;
+
+    // Unchecked metrics must not look like a pass
+    if (missing != 0)
+    {
+        std::printf("%s: skipped, %u metric(s) without a baseline (record with --update-baselines)\n", test->name, missing);
+        return EXIT_SKIPPED;
+    }
+    return 0;
+}
+
+} // namespace juce
+
+int main(int argc, char* argv[])
+{
+    return juce::run(argc, argv);
+}
@@ -0,0 +1,248 @@
+// perf_vulkan은 "context / swapchain / 프레임 루프가 얼마나 빨리 도는가"를 책임
+// - 숨겨진 창 + 소프트웨어 ICD (lavapipe 등)로 GPU 없이 실행, 장치가 없으면 skip
+#include <juce/core/win32_config.h>
+#include <juce/core/logger.h>
+
+#include "perf.h"
+
+#include <juce/context/vulkan/vk_context.h>
+#include <juce/context/vulkan/swapchain.h>
+#include <juce/context/vulkan/backend.h>
+
+#include <chrono>
+#include <memory>
+
+namespace juce
+{
+
+static const uint32_t WINDOW_WIDTH = 640;
+static const uint32_t WINDOW_HEIGHT = 480;
+static const uint32_t CREATE_SAMPLES = 5;
+static const uint32_t WARMUP_FRAMES = 30;
+static const uint32_t MEASURED_FRAMES = 300;
+static const uint32_t RESIZE_SAMPLES = 20;
+
+static double now_ms()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double median(std::vector<double> values)
+{
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+static double percentile(std::vector<double> values, double p)
+{
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// Never shown: swapchain images are still acquired and presented, just not composited to a screen
+class hidden_window
+{
+public:
+    hidden_window()
+        : m_hinstance(GetModuleHandle(nullptr)), m_hwnd(nullptr)
+    {
+        WNDCLASSEX wc{};
+        wc.cbSize = sizeof(WNDCLASSEX);
+        wc.lpfnWndProc = DefWindowProc;
+        wc.hInstance = m_hinstance;
+        wc.lpszClassName = TEXT("juce-perf");
+        RegisterClassEx(&wc);
+
+        RECT rect = {0, 0, static_cast<LONG>(WINDOW_WIDTH), static_cast<LONG>(WINDOW_HEIGHT)};
+        AdjustWindowRect(&rect, WS_OVERLAPPEDWINDOW, FALSE);
+        m_hwnd = CreateWindowEx(0, TEXT("juce-perf"), TEXT("juce-perf"), WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT,
+                                rect.right - rect.left, rect.bottom - rect.top, nullptr, nullptr, m_hinstance, nullptr);
+    }
+
+    ~hidden_window()
+    {
+        if (m_hwnd)
+        {
+            DestroyWindow(m_hwnd);
+        }
+    }
+
+    void resize(uint32_t width, uint32_t height)
+    {
+        RECT rect = {0, 0, static_cast<LONG>(width), static_cast<LONG>(height)};
+        AdjustWindowRect(&rect, WS_OVERLAPPEDWINDOW, FALSE);
+        SetWindowPos(m_hwnd, nullptr, 0, 0, rect.right - rect.left, rect.bottom - rect.top, SWP_NOMOVE | SWP_NOZORDER | SWP_NOACTIVATE);
+        pump();
+    }
+
+    void pump()
+    {
+        MSG msg;
+        while (PeekMessage(&msg, m_hwnd, 0, 0, PM_REMOVE))
+        {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+    }
+
+    HWND get_hwnd() const { return m_hwnd; }
+    HINSTANCE get_hinstance() const { return m_hinstance; }
+
+private:
+    HINSTANCE m_hinstance;
+    HWND m_hwnd;
+};
+
+// context + swapchain + backend, torn down in reverse order
+struct renderer
+{
+    vk_context context;
+    swapchain chain;
+    std::unique_ptr<backend> frame_backend;
+
+    ~renderer()
+    {
+        frame_backend.reset();
+        chain.cleanup();
+        context.cleanup();
+    }
+};
+
+// skipped when no Vulkan device is reachable, failed when one is but the backend does not come up
+static perf_status create_renderer(hidden_window& window, renderer& r)
+{
+    if (!window.get_hwnd() || !r.context.initialize(window.get_hwnd(), window.get_hinstance()))
+        return perf_status::skipped;
+    if (!r.chain.initialize(&r.context, WINDOW_WIDTH, WINDOW_HEIGHT))
+        return perf_status::failed;
+
+    r.frame_backend = std::make_unique<backend>(&r.context, &r.chain);
+    // No vblank blocking, so frame times measure the CPU + ICD rather than the display
+    r.frame_backend->set_frame_profile(frame_profile::max_throughput);
+    if (!r.frame_backend->initialize())
+        return perf_status::failed;
+    return perf_status::ok;
+}
+
+JUCE_PERF_TEST(context_create)
+{
+    hidden_window window;
+    std::vector<double> context_times;
+    std::vector<double> swapchain_times;
+    for (uint32_t i = 0; i < CREATE_SAMPLES; i++)
+    {
+        vk_context context;
+        double begin = now_ms();
+        if (!context.initialize(window.get_hwnd(), window.get_hinstance()))
+            return i == 0 ? perf_status::skipped : perf_status::failed;
+        double context_end = now_ms();
+
+        swapchain chain;
+        bool ok = chain.initialize(&context, WINDOW_WIDTH, WINDOW_HEIGHT);
+        double swapchain_end = now_ms();
+        chain.cleanup();
+        context.cleanup();
+        if (!ok)
+            return perf_status::failed;
+
+        context_times.push_back(context_end - begin);
+        swapchain_times.push_back(swapchain_end - context_end);
+    }
+
+    metrics.push_back({"context", median(context_times), "ms"});
+    metrics.push_back({"swapchain", median(swapchain_times), "ms"});
+    return perf_status::ok;
+}
+
+JUCE_PERF_TEST(frame_submit)
+{
+    hidden_window window;
+    renderer r;
+    perf_status status = create_renderer(window, r);
+    if (status != perf_status::ok)
+        return status;
+
+    try
+    {
+        for (uint32_t i = 0; i < WARMUP_FRAMES; i++)
+        {
+            window.pump();
+            r.frame_backend->draw_frame();
+        }
+
+        std::vector<double> frame_times;
+        frame_times.reserve(MEASURED_FRAMES);
+        double begin = now_ms();
+        for (uint32_t i = 0; i < MEASURED_FRAMES; i++)
+        {
+            double frame_begin = now_ms();
+            window.pump();
+            r.frame_backend->draw_frame();
+            frame_times.push_back(now_ms() - frame_begin);
+        }
+        double total = now_ms() - begin;
+
+        metrics.push_back({"frame", total / MEASURED_FRAMES, "ms"});
+        metrics.push_back({"frame_p95", percentile(frame_times, 0.95), "ms"});
+    }
+    catch (const std::exception& e)
+    {
+        log_error("frame_submit: %s", e.what());
+        return perf_status::failed;
+    }
+    return perf_status::ok;
+}
+
+JUCE_PERF_TEST(swapchain_resize)
+{
+    hidden_window window;
+    renderer r;
+    perf_status status = create_renderer(window, r);
+    if (status != perf_status::ok)
+        return status;
+
+    try
+    {
+        for (uint32_t i = 0; i < WARMUP_FRAMES; i++)
+        {
+            window.pump();
+            r.frame_backend->draw_frame();
+        }
+
+        // The frame that sees the resize recreates the swapchain, its views / depth / MSAA targets and framebuffers;
+        // the next one is the first frame on the new images
+        std::vector<double> resize_times;
+        for (uint32_t i = 0; i < RESIZE_SAMPLES; i++)
+        {
+            uint32_t width = (i & 1) ? WINDOW_WIDTH : WINDOW_WIDTH + 160;
+            uint32_t height = (i & 1) ? WINDOW_HEIGHT : WINDOW_HEIGHT + 120;
+            VkExtent2D before = r.chain.get_extent();
+            window.resize(width, height);
+
+            double begin = now_ms();
+            r.frame_backend->on_window_resized(width, height);
+            r.frame_backend->draw_frame();
+            r.frame_backend->draw_frame();
+            double elapsed = now_ms() - begin;
+
+            // Otherwise this would time an early-returning frame on the old images
+            VkExtent2D after = r.chain.get_extent();
+            if (after.width == before.width && after.height == before.height)
+            {
+                log_error("swapchain_resize: extent stayed %ux%u after resizing to %ux%u", after.width, after.height, width, height);
+                return perf_status::failed;
+            }
+            resize_times.push_back(elapsed);
+        }
+        metrics.push_back({"resize", median(resize_times), "ms"});
+    }
+    catch (const std::exception& e)
+    {
+        log_error("swapchain_resize: %s", e.what());
+        return perf_status::failed;
+    }
+    return perf_status::ok;
+}
+
+} // namespace juce